@@ -0,0 +1,502 @@
+/*
+ * Benchmark binary built from the game sources:
+ *   g++ -std=c++20 -O2 benchmark.cpp -o ludo_bench -lpthread
+ * Micro benchmarks time moveToken, eliminateOpponent, the home path
+ * functions and snapshot save and restore on synthetic positions taken
+ * from seeded games, and displayBoard on a recorded game. Macro benchmarks
+ * time whole games on the packed engine (standard, 2-player and 6-player
+ * rules), in lockstep lanes, on a GameContext, with the threaded
+ * playerRoutine design and on the tournament pool. The workload is seeded (42 unless
+ * --seed is given), so runs are comparable. Each benchmark is repeated and
+ * the median kept. Results can be saved as a baseline and later runs
+ * compared against it; a benchmark slower than the baseline by more than
+ * the threshold is reported as a regression and the exit status is 1.
+ */
+
+#define LUDO_BENCHMARK // final.cpp leaves out its main()
+#include "final.cpp"
+
+#define BENCH_POSITIONS 256          // Synthetic positions per micro benchmark batch
+#define BENCH_MIN_BATCH_NS 20000000LL // Each micro benchmark repetition runs at least this long
+#define BENCH_REPETITIONS 5          // Repetitions per benchmark; the median is reported
+#define BENCH_FRAMES 2000            // Boards drawn per displayBoard repetition
+#define BENCH_DEFAULT_SEED 42
+#define BENCH_DEFAULT_THRESHOLD 10.0 // Percent slower than the baseline that counts as a regression
+#define MAX_BENCH_RESULTS 32
+#define MAX_BENCH_NAME 48
+
+// Positions and buffers shared by the benchmarks
+typedef struct {
+    uint64_t seed;
+    GameContext *positions;                        // Synthetic positions, never modified
+    GameContext *homePositions;                    // Positions where the mover has a token in its home path
+    GameContext *work;                             // Copies the benchmarks modify
+    int homeTokens[BENCH_POSITIONS];               // Home path token of each home position
+    BoardPosition targets[BENCH_POSITIONS];        // Opponent cell to eliminate in each position
+    GameSnapshot snapshots[BENCH_POSITIONS];       // Snapshot of each position
+    PlayerInfo (*frames)[MAX_PLAYERS];             // Players of a recorded game after each turn
+    int nullFd;                                    // Frames are written to /dev/null
+} BenchFixture;
+
+typedef struct {
+    const char *name;
+    const char *unit;                         // What one operation is
+    double (*run)(BenchFixture *fixture);     // Returns nanoseconds per operation
+} Benchmark;
+
+typedef struct {
+    char name[MAX_BENCH_NAME];
+    double nsPerOp;
+} BenchResult;
+
+typedef struct {
+    BenchResult results[MAX_BENCH_RESULTS];
+    int count;
+    uint64_t seed;
+} BenchReport;
+
+// Keeps the results of pure functions alive
+volatile long benchSink = 0;
+
+// Function to check whether the player to move has a token in its home path
+bool moverHasHomeToken(const PackedGameState *state) {
+    for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
+        int progress = state->tokens[state->currentTurn * TOKENS_PER_PLAYER + j];
+        if (progressInHomePath(progress) && progress != PROGRESS_FINISHED) return true;
+    }
+    return false;
+}
+
+// Function to fill positions from seeded packed games, taking every fifth turn
+// that passes the filter (NULL = every position)
+void collectPositions(GameContext *positions, uint64_t seed, bool (*accept)(const PackedGameState *)) {
+    DiceRng rng;
+    PackedGameState state;
+    OccupancyIndex occupancy;
+    int collected = 0;
+
+    for (uint64_t g = 0; collected < BENCH_POSITIONS; g++) {
+        diceRngSeed(&rng, seed + g);
+        packedResetState(&state);
+        occupancyClear(&occupancy);
+        for (long turn = 1; collected < BENCH_POSITIONS && !packedGameOver(&state); turn++) {
+            packedPlayTurn(&state, &occupancy, &rng);
+            if (turn % 5 != 0 || packedGameOver(&state) || (accept && !accept(&state))) continue;
+
+            GameContext *game = &positions[collected++];
+            unpackGameState(&state, game);
+            diceRngSeed(&game->rng, seed + collected);
+        }
+    }
+}
+
+// Function to pick the opponent token a mover would capture in each position:
+// the first opponent on the track, or the mover's own cell if there is none
+void collectTargets(BenchFixture *fixture) {
+    for (int i = 0; i < BENCH_POSITIONS; i++) {
+        GameContext *game = &fixture->positions[i];
+        int mover = game->gameStatus.currentTurn - 1;
+        BoardPosition target = { game->playersList[mover].tokens[0].posX, game->playersList[mover].tokens[0].posY };
+
+        bool found = false;
+        for (int p = 0; p < MAX_PLAYERS && !found; p++) {
+            if (p == mover) continue;
+            for (int j = 0; j < TOKENS_PER_PLAYER && !found; j++) {
+                if (isOnPath(&game->playersList[p], j) && !isInHomePath(&game->playersList[p], j)) {
+                    target.x = game->playersList[p].tokens[j].posX;
+                    target.y = game->playersList[p].tokens[j].posY;
+                    found = true;
+                }
+            }
+        }
+        fixture->targets[i] = target;
+    }
+}
+
+// Function to record the players after every turn of a seeded game
+void collectFrames(BenchFixture *fixture) {
+    GameContext *game = (GameContext *)calloc(1, sizeof(GameContext));
+    diceRngSeed(&game->rng, fixture->seed);
+    resetGame(game);
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        if (game->activePlayerCount <= 1) resetGame(game);
+        playHeadlessTurn(game);
+        memcpy(fixture->frames[f], game->playersList, sizeof(game->playersList));
+    }
+    free(game);
+}
+
+// Function to time an operation on fresh copies of a set of positions.
+// Copying the positions is not timed; returns nanoseconds per operation.
+double timePositionBatches(BenchFixture *fixture, GameContext *positions,
+                           void (*operation)(BenchFixture *fixture, GameContext *game, int index)) {
+    long long totalNs = 0;
+    long operations = 0;
+    while (totalNs < BENCH_MIN_BATCH_NS) {
+        memcpy(fixture->work, positions, BENCH_POSITIONS * sizeof(GameContext));
+        long long startNs = monotonicNanos();
+        for (int i = 0; i < BENCH_POSITIONS; i++) {
+            operation(fixture, &fixture->work[i], i);
+        }
+        totalNs += monotonicNanos() - startNs;
+        operations += BENCH_POSITIONS;
+    }
+    return (double)totalNs / operations;
+}
+
+void moveTokenOperation(BenchFixture * /* fixture */, GameContext *game, int index) {
+    moveToken(game, &game->playersList[game->gameStatus.currentTurn - 1], 1 + index % 5);
+}
+
+void eliminateOperation(BenchFixture *fixture, GameContext *game, int index) {
+    PlayerInfo *player = &game->playersList[game->gameStatus.currentTurn - 1];
+    benchSink = benchSink + eliminateOpponent(game, player, fixture->targets[index].x, fixture->targets[index].y);
+}
+
+void advanceHomeOperation(BenchFixture *fixture, GameContext *game, int index) {
+    PlayerInfo *player = &game->playersList[game->gameStatus.currentTurn - 1];
+    benchSink = benchSink + canAdvanceInHomePath(game, player, fixture->homeTokens[index], 1 + index % 5);
+}
+
+void homeQueryOperation(BenchFixture * /* fixture */, GameContext *game, int /* index */) {
+    PlayerInfo *player = &game->playersList[game->gameStatus.currentTurn - 1];
+    for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
+        benchSink = benchSink + isInHomePath(player, j) + canEnterHomePath(player, j);
+    }
+}
+
+void snapshotSaveOperation(BenchFixture * /* fixture */, GameContext *game, int index) {
+    GameSnapshot snapshot;
+    saveGameSnapshot(game, &snapshot);
+    benchSink = benchSink + snapshot.state.tokens[index % TOTAL_TOKENS];
+}
+
+void snapshotRestoreOperation(BenchFixture *fixture, GameContext *game, int index) {
+    benchSink = benchSink + restoreGameSnapshot(game, &fixture->snapshots[(index + 1) % BENCH_POSITIONS]);
+}
+
+double benchMoveToken(BenchFixture *fixture) {
+    return timePositionBatches(fixture, fixture->positions, moveTokenOperation);
+}
+
+double benchEliminateOpponent(BenchFixture *fixture) {
+    return timePositionBatches(fixture, fixture->positions, eliminateOperation);
+}
+
+double benchAdvanceInHomePath(BenchFixture *fixture) {
+    return timePositionBatches(fixture, fixture->homePositions, advanceHomeOperation);
+}
+
+double benchHomePathQueries(BenchFixture *fixture) {
+    return timePositionBatches(fixture, fixture->positions, homeQueryOperation);
+}
+
+double benchSnapshotSave(BenchFixture *fixture) {
+    return timePositionBatches(fixture, fixture->positions, snapshotSaveOperation);
+}
+
+double benchSnapshotRestore(BenchFixture *fixture) {
+    return timePositionBatches(fixture, fixture->positions, snapshotRestoreOperation);
+}
+
+// Function to time displayBoard over the recorded game, board built from the tokens included
+double timeDisplayBoard(BenchFixture *fixture, bool diffEnabled) {
+    GameContext *game = (GameContext *)calloc(1, sizeof(GameContext));
+    rendererInit(&terminalRenderer, fixture->nullFd, 0, diffEnabled);
+    terminalRenderer.isTerminal = true; // Draw as if /dev/null were a terminal
+
+    long long startNs = monotonicNanos();
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        memcpy(game->playersList, fixture->frames[f], sizeof(game->playersList));
+        displayBoard(game);
+    }
+    long long elapsedNs = monotonicNanos() - startNs;
+
+    terminalRenderer.hasFrame = false;
+    free(game);
+    return (double)elapsedNs / BENCH_FRAMES;
+}
+
+double benchDisplayBoardFull(BenchFixture *fixture) {
+    return timeDisplayBoard(fixture, false);
+}
+
+double benchDisplayBoardDiff(BenchFixture *fixture) {
+    return timeDisplayBoard(fixture, true);
+}
+
+// Function to time whole games of a rules variant on the packed engine
+template <typename Rules>
+double timePackedGames(BenchFixture *fixture) {
+    const int gameCount = 2000;
+    PackedState<Rules> state;
+    DiceRng rng;
+
+    long long startNs = monotonicNanos();
+    for (int g = 0; g < gameCount; g++) {
+        diceRngSeed(&rng, fixture->seed + g);
+        benchSink = benchSink + playPackedGame(&state, &rng);
+    }
+    return (double)(monotonicNanos() - startNs) / gameCount;
+}
+
+double benchPackedGame(BenchFixture *fixture) {
+    return timePackedGames<StandardRules>(fixture);
+}
+
+double benchTwoPlayerGame(BenchFixture *fixture) {
+    return timePackedGames<TwoPlayerRules>(fixture);
+}
+
+double benchSixPlayerGame(BenchFixture *fixture) {
+    return timePackedGames<SixPlayerRules>(fixture);
+}
+
+// The same games as packedGame, played in lockstep lanes
+double benchLaneGame(BenchFixture *fixture) {
+    const int gameCount = 2000;
+    long long startNs = monotonicNanos();
+    benchSink = benchSink + lanePlayGames(0, gameCount, fixture->seed, NULL, NULL);
+    return (double)(monotonicNanos() - startNs) / gameCount;
+}
+
+double benchContextGame(BenchFixture *fixture) {
+    const int gameCount = 500;
+    GameContext *game = (GameContext *)calloc(1, sizeof(GameContext));
+
+    long long startNs = monotonicNanos();
+    for (int g = 0; g < gameCount; g++) {
+        diceRngSeed(&game->rng, fixture->seed + g);
+        benchSink = benchSink + playHeadlessGame(game);
+    }
+    long long elapsedNs = monotonicNanos() - startNs;
+
+    free(game);
+    return (double)elapsedNs / gameCount;
+}
+
+// Whole games played by four player threads passing the turn baton. The turn
+// limit is the length of the same seeded game on the packed engine, so the
+// threads stop exactly when the game ends; the final states are compared.
+double benchThreadedGame(BenchFixture *fixture) {
+    const int gameCount = 20;
+    GameContext *game = (GameContext *)calloc(1, sizeof(GameContext));
+    initializeTurnSync(game);
+    long long elapsedNs = 0;
+    int mismatches = 0;
+
+    for (int g = 0; g < gameCount; g++) {
+        PackedGameState expected, actual;
+        DiceRng rng;
+        diceRngSeed(&rng, fixture->seed + g);
+        long turns = playPackedGame(&expected, &rng);
+
+        diceRngSeed(&game->rng, fixture->seed + g);
+        resetGame(game);
+        game->gameStatus.turnLimit = turns;
+        game->gameStatus.turnDelayMicros = 0;
+
+        long long startNs = monotonicNanos();
+        pthread_t playerThreads[MAX_PLAYERS];
+        PlayerThreadArgs threadArgs[MAX_PLAYERS];
+        for (int i = 0; i < MAX_PLAYERS; i++) {
+            threadArgs[i].game = game;
+            threadArgs[i].player = &game->playersList[i];
+            pthread_create(&playerThreads[i], NULL, playerRoutine, &threadArgs[i]);
+        }
+        for (int i = 0; i < MAX_PLAYERS; i++) {
+            pthread_join(playerThreads[i], NULL);
+        }
+        elapsedNs += monotonicNanos() - startNs;
+
+        packGameState(game, &actual);
+        actual.currentTurn = expected.currentTurn;
+        if (!packedStateEquals(&expected, &actual)) mismatches++;
+    }
+
+    if (mismatches > 0) printf("warning: %d threaded games differ from the packed engine\n", mismatches);
+    destroyTurnSync(game);
+    free(game);
+    return (double)elapsedNs / gameCount;
+}
+
+double benchTournament(BenchFixture *fixture) {
+    const int gameCount = 4096;
+    long long startNs = monotonicNanos();
+    GameResult *results = runTournament(gameCount, (int)sysconf(_SC_NPROCESSORS_ONLN), fixture->seed);
+    long long elapsedNs = monotonicNanos() - startNs;
+    benchSink = benchSink + results[0].turns;
+    free(results);
+    return (double)elapsedNs / gameCount;
+}
+
+static const Benchmark benchmarks[] = {
+    { "moveToken",            "call",  benchMoveToken },
+    { "eliminateOpponent",    "call",  benchEliminateOpponent },
+    { "canAdvanceInHomePath", "call",  benchAdvanceInHomePath },
+    { "homePathQueries",      "4 tokens", benchHomePathQueries },
+    { "snapshotSave",         "call",  benchSnapshotSave },
+    { "snapshotRestore",      "call",  benchSnapshotRestore },
+    { "displayBoardFull",     "frame", benchDisplayBoardFull },
+    { "displayBoardDiff",     "frame", benchDisplayBoardDiff },
+    { "packedGame",           "game",  benchPackedGame },
+    { "twoPlayerGame",        "game",  benchTwoPlayerGame },
+    { "sixPlayerGame",        "game",  benchSixPlayerGame },
+    { "laneGame",             "game",  benchLaneGame },
+    { "contextGame",          "game",  benchContextGame },
+    { "threadedGame",         "game",  benchThreadedGame },
+    { "tournamentGame",       "game",  benchTournament },
+};
+static const int benchmarkCount = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+static int compareDoubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Function to load a baseline file; returns false if it cannot be read
+bool loadBaseline(const char *path, BenchReport *baseline) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+
+    baseline->count = 0;
+    baseline->seed = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), file) && baseline->count < MAX_BENCH_RESULTS) {
+        unsigned long long seed;
+        if (sscanf(line, "# seed %llu", &seed) == 1) {
+            baseline->seed = seed;
+            continue;
+        }
+        if (line[0] == '#') continue;
+
+        BenchResult *result = &baseline->results[baseline->count];
+        if (sscanf(line, "%47s %lf", result->name, &result->nsPerOp) == 2) baseline->count++;
+    }
+    fclose(file);
+    return true;
+}
+
+// Function to write the results as a baseline file; returns false if it cannot be written
+bool saveBaseline(const char *path, const BenchReport *report) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+    fprintf(file, "# Ludo benchmark baseline: benchmark name and nanoseconds per operation\n");
+    fprintf(file, "# seed %llu\n", (unsigned long long)report->seed);
+    for (int i = 0; i < report->count; i++) {
+        fprintf(file, "%s %.1f\n", report->results[i].name, report->results[i].nsPerOp);
+    }
+    fclose(file);
+    return true;
+}
+
+// Function to find a benchmark in a baseline, or NULL
+const BenchResult *findBaseline(const BenchReport *baseline, const char *name) {
+    for (int i = 0; i < baseline->count; i++) {
+        if (strcmp(baseline->results[i].name, name) == 0) return &baseline->results[i];
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    const char *seedOption = optionValue(argc, argv, "--seed");
+    const char *thresholdOption = optionValue(argc, argv, "--threshold");
+    const char *baselinePath = optionValue(argc, argv, "--baseline");
+    const char *savePath = optionValue(argc, argv, "--save-baseline");
+    double threshold = thresholdOption ? atof(thresholdOption) : BENCH_DEFAULT_THRESHOLD;
+
+    BenchReport report;
+    report.count = 0;
+    report.seed = seedOption ? strtoull(seedOption, NULL, 10) : BENCH_DEFAULT_SEED;
+
+    BenchReport baseline;
+    baseline.count = 0;
+    if (baselinePath && !loadBaseline(baselinePath, &baseline)) return 2;
+    if (baselinePath && baseline.seed != report.seed) {
+        printf("warning: baseline was recorded with seed %llu, this run uses seed %llu\n",
+               (unsigned long long)baseline.seed, (unsigned long long)report.seed);
+    }
+
+    initializeBoardPath();
+    headlessMode = true;
+
+    BenchFixture fixture;
+    fixture.seed = report.seed;
+    fixture.positions = (GameContext *)calloc(BENCH_POSITIONS, sizeof(GameContext));
+    fixture.homePositions = (GameContext *)calloc(BENCH_POSITIONS, sizeof(GameContext));
+    fixture.work = (GameContext *)calloc(BENCH_POSITIONS, sizeof(GameContext));
+    fixture.frames = (PlayerInfo (*)[MAX_PLAYERS])malloc(BENCH_FRAMES * sizeof(*fixture.frames));
+    fixture.nullFd = open("/dev/null", O_WRONLY);
+    if (fixture.nullFd < 0) {
+        perror("open /dev/null");
+        return 2;
+    }
+
+    collectPositions(fixture.positions, report.seed, NULL);
+    collectPositions(fixture.homePositions, report.seed, moverHasHomeToken);
+    for (int i = 0; i < BENCH_POSITIONS; i++) {
+        PlayerInfo *player = &fixture.homePositions[i].playersList[fixture.homePositions[i].gameStatus.currentTurn - 1];
+        fixture.homeTokens[i] = 0;
+        for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
+            if (isInHomePath(player, j) && !player->tokens[j].hasReachedHome) fixture.homeTokens[i] = j;
+        }
+    }
+    collectTargets(&fixture);
+    for (int i = 0; i < BENCH_POSITIONS; i++) saveGameSnapshot(&fixture.positions[i], &fixture.snapshots[i]);
+    collectFrames(&fixture);
+
+    printf("=== BENCHMARKS (seed %llu, median of %d) ===\n", (unsigned long long)report.seed, BENCH_REPETITIONS);
+    printf("%-22s %14s %14s %-9s", "benchmark", "ns/op", "ops/sec", "op");
+    if (baselinePath) printf(" %14s %9s", "baseline ns", "change");
+    printf("\n");
+
+    int regressions = 0;
+    for (int b = 0; b < benchmarkCount; b++) {
+        double samples[BENCH_REPETITIONS];
+        for (int r = 0; r < BENCH_REPETITIONS; r++) {
+            samples[r] = benchmarks[b].run(&fixture);
+        }
+        qsort(samples, BENCH_REPETITIONS, sizeof(double), compareDoubles);
+        double nsPerOp = samples[BENCH_REPETITIONS / 2];
+
+        BenchResult *result = &report.results[report.count++];
+        snprintf(result->name, sizeof(result->name), "%s", benchmarks[b].name);
+        result->nsPerOp = nsPerOp;
+
+        printf("%-22s %14.1f %14.0f %-9s", benchmarks[b].name, nsPerOp,
+               nsPerOp > 0 ? 1e9 / nsPerOp : 0.0, benchmarks[b].unit);
+        const BenchResult *previous = baselinePath ? findBaseline(&baseline, benchmarks[b].name) : NULL;
+        if (previous && previous->nsPerOp > 0) {
+            double change = (nsPerOp / previous->nsPerOp - 1.0) * 100.0;
+            printf(" %14.1f %+8.1f%%", previous->nsPerOp, change);
+            if (change > threshold) {
+                printf("  REGRESSION");
+                regressions++;
+            }
+        } else if (baselinePath) {
+            printf(" %14s %9s", "-", "new");
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+
+    if (baselinePath) {
+        printf("%d regression(s) beyond %.1f%% against %s\n", regressions, threshold, baselinePath);
+    }
+    if (savePath && saveBaseline(savePath, &report)) {
+        printf("Baseline written to %s\n", savePath);
+    }
+
+    close(fixture.nullFd);
+    free(fixture.frames);
+    free(fixture.work);
+    free(fixture.homePositions);
+    free(fixture.positions);
+    return regressions > 0 ? 1 : 0;
+}
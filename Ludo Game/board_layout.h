@@ -0,0 +1,104 @@
+#ifndef BOARD_LAYOUT_H
+#define BOARD_LAYOUT_H
+
+/*
+ * Fixed geometry of the 15x15 Ludo board, shared by the threaded game and
+ * the packed simulation engine.
+ */
+
+#define BOARD_DIMENSION 15
+#define MAX_PLAYERS 4
+#define TOKENS_PER_PLAYER 4
+#define HOME_PATH_LENGTH 5
+#define TRACK_LENGTH 52
+
+typedef struct {
+    int x, y; // Coordinates on the board
+} BoardPosition;
+
+// Sequential path around the board
+constexpr BoardPosition trackLayout[TRACK_LENGTH] = {
+    {0, 6}, {0, 7}, {0, 8}, {1, 8}, {2, 8}, {3, 8}, {4, 8}, {5, 8},
+    {6, 9}, {6, 10}, {6, 11}, {6, 12}, {6, 13}, {6, 14}, {7, 14},
+    {8, 14}, {8, 13}, {8, 12}, {8, 11}, {8, 10}, {8, 9}, {9, 8},
+    {10, 8}, {11, 8}, {12, 8}, {13, 8}, {14, 8}, {14, 7}, {14, 6},
+    {13, 6}, {12, 6}, {11, 6}, {10, 6}, {9, 6}, {8, 5}, {8, 4},
+    {8, 3}, {8, 2}, {8, 1}, {8, 0}, {7, 0}, {6, 0}, {6, 1},
+    {6, 2}, {6, 3}, {6, 4}, {6, 5}, {5, 6}, {4, 6}, {3, 6},
+    {2, 6}, {1, 6}
+};
+
+// Home paths for each player, walked from entry to finish
+constexpr BoardPosition homePathLayout[MAX_PLAYERS][HOME_PATH_LENGTH] = {
+    { {7, 1}, {7, 2}, {7, 3}, {7, 4}, {7, 5} },      // Blue
+    { {13, 7}, {12, 7}, {11, 7}, {10, 7}, {9, 7} },  // Red
+    { {1, 7}, {2, 7}, {3, 7}, {4, 7}, {5, 7} },      // Green
+    { {7, 13}, {7, 12}, {7, 11}, {7, 10}, {7, 9} }   // Yellow
+};
+
+// Starting positions for each player
+constexpr int initialPositions[MAX_PLAYERS][2] = {
+    {13, 6}, // Blue
+    {6, 1},  // Red
+    {1, 8},  // Green
+    {8, 13}  // Yellow
+};
+
+// Top-left cell of each player's 2x2 block of yard spots
+constexpr BoardPosition yardCorners[MAX_PLAYERS] = {
+    {11, 2},  // Blue
+    {2, 2},   // Red
+    {2, 11},  // Green
+    {11, 11}  // Yellow
+};
+
+// Safe track cells, marked 'S'; tokens on them cannot be captured
+#define SAFE_SPOT_COUNT 8
+constexpr BoardPosition safeSpots[SAFE_SPOT_COUNT] = {
+    {2, 6}, {1, 8}, {6, 12}, {8, 13},
+    {6, 1}, {8, 2}, {13, 6}, {12, 8}
+};
+
+// Board symbol of each player's tokens
+constexpr char playerSymbols[MAX_PLAYERS] = { '@', '#', '$', '%' };
+
+// Cells of the empty board: home zones, centre, paths and safe spots
+typedef struct {
+    char cells[BOARD_DIMENSION][BOARD_DIMENSION];
+} BoardTemplate;
+
+constexpr BoardTemplate buildBoardTemplate() {
+    BoardTemplate board = {};
+    for (int i = 0; i < BOARD_DIMENSION; i++) {
+        for (int j = 0; j < BOARD_DIMENSION; j++) board.cells[i][j] = ' ';
+    }
+
+    // Home zones
+    for (int i = 0; i < 6; i++) {
+        for (int j = 0; j < 6; j++) {
+            board.cells[i][j] = 'R';         // Red home zone
+            board.cells[i][j + 9] = 'G';     // Green home zone
+            board.cells[i + 9][j + 9] = 'Y'; // Yellow home zone
+            board.cells[i + 9][j] = 'B';     // Blue home zone
+        }
+    }
+
+    // Central area
+    for (int i = 6; i <= 8; i++) {
+        for (int j = 6; j <= 8; j++) board.cells[i][j] = '*';
+    }
+
+    // Horizontal and vertical paths
+    for (int j = 1; j < 14; j++) board.cells[7][j] = '-';
+    for (int i = 1; i < 6; i++) board.cells[i][7] = '|';
+    for (int i = 9; i < 14; i++) board.cells[i][7] = '|';
+
+    // Safe spaces
+    for (int i = 0; i < SAFE_SPOT_COUNT; i++) board.cells[safeSpots[i].x][safeSpots[i].y] = 'S';
+    return board;
+}
+
+// Built once at compile time; frames overlay the tokens on a copy
+constexpr BoardTemplate boardTemplate = buildBoardTemplate();
+
+#endif
@@ -0,0 +1,240 @@
+#ifndef BOARD_RENDERER_H
+#define BOARD_RENDERER_H
+
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include "board_layout.h"
+
+/*
+ * Buffered terminal renderer for the board.
+ * A frame is built in one buffer and written with a single write(). The
+ * first frame draws the whole board at the top of the screen and keeps
+ * the lines below it as a scrolling log area. Later frames only re-draw
+ * the cells that differ from what is already on screen. Frames that
+ * arrive faster than the frame-rate cap are skipped; the next frame
+ * brings the screen up to date.
+ */
+
+#define FRAME_BUFFER_SIZE 16384
+#define BOARD_SCREEN_LINES 33 // Lines used by a full frame
+#define FRAME_SEPARATOR "--------------------------------------------------------------\n"
+
+typedef struct {
+    int fd;                                            // Where frames are written
+    bool isTerminal;                                   // Cursor positioning is only used on a terminal
+    bool diffEnabled;                                  // Re-draw changed cells only (otherwise full frames)
+    bool hasFrame;                                     // Whether lastBoard is what the screen shows
+    char lastBoard[BOARD_DIMENSION][BOARD_DIMENSION];  // Cells currently on screen
+    long long minFrameIntervalNs;                      // Frame-rate cap (0 = no cap)
+    long long lastFrameNs;                             // Time the last frame was written
+    char buffer[FRAME_BUFFER_SIZE];                    // Frame being built
+    int length;                                        // Bytes used in buffer
+    long framesRendered;                               // Frames written
+    long framesSkipped;                                // Frames dropped by the frame-rate cap
+    long cellsDrawn;                                   // Cells emitted across all frames
+    long bytesWritten;                                 // Bytes written across all frames
+    long writeCalls;                                   // write() system calls across all frames
+} BoardRenderer;
+
+// Function to read the monotonic clock for frame pacing
+static long long rendererClockNs() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+// Function to set up a renderer; maxFramesPerSecond <= 0 renders every frame
+void rendererInit(BoardRenderer *renderer, int fd, int maxFramesPerSecond, bool diffEnabled) {
+    memset(renderer, 0, sizeof(*renderer));
+    renderer->fd = fd;
+    renderer->isTerminal = isatty(fd);
+    renderer->diffEnabled = diffEnabled;
+    renderer->minFrameIntervalNs = maxFramesPerSecond > 0 ? 1000000000LL / maxFramesPerSecond : 0;
+}
+
+static inline void appendBytes(BoardRenderer *renderer, const char *text, int length) {
+    memcpy(renderer->buffer + renderer->length, text, length);
+    renderer->length += length;
+}
+
+static inline void appendText(BoardRenderer *renderer, const char *text) {
+    appendBytes(renderer, text, (int)strlen(text));
+}
+
+static inline void appendNumber(BoardRenderer *renderer, int value) {
+    char digits[12];
+    int count = 0;
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (count > 0) renderer->buffer[renderer->length++] = digits[--count];
+}
+
+// Function to move the cursor to a 1-based screen line and column
+static inline void appendCursorMove(BoardRenderer *renderer, int line, int column) {
+    appendText(renderer, "\033[");
+    appendNumber(renderer, line);
+    renderer->buffer[renderer->length++] = ';';
+    appendNumber(renderer, column);
+    renderer->buffer[renderer->length++] = 'H';
+}
+
+// Function to get the colour escape used for a board symbol, or NULL
+static const char *cellColor(char cell) {
+    switch (cell) {
+        case 'R': return "\033[1;31m"; // Red
+        case 'G': return "\033[1;32m"; // Green
+        case 'Y': return "\033[1;33m"; // Yellow
+        case 'B': return "\033[1;34m"; // Blue
+        case 'S': return "\033[1;37m"; // Safe
+        case '*': return "\033[1;35m"; // Center
+        case '-':
+        case '|': return "\033[1;36m"; // Paths
+        default: return NULL;          // Empty
+    }
+}
+
+// Function to append one board cell in the original " c | " layout
+static void appendCell(BoardRenderer *renderer, char cell) {
+    const char *color = cellColor(cell);
+    if (color) appendText(renderer, color);
+    renderer->buffer[renderer->length++] = ' ';
+    renderer->buffer[renderer->length++] = cell;
+    renderer->buffer[renderer->length++] = ' ';
+    if (color) appendText(renderer, "\033[0m");
+    appendText(renderer, "| ");
+}
+
+// Function to get the number of lines of the terminal
+static int terminalLines(int fd) {
+    struct winsize size;
+    if (ioctl(fd, TIOCGWINSZ, &size) == 0 && size.ws_row > BOARD_SCREEN_LINES + 1) return size.ws_row;
+    return BOARD_SCREEN_LINES + 20;
+}
+
+// Function to build a frame with the whole board
+static void buildFullFrame(BoardRenderer *renderer, char board[BOARD_DIMENSION][BOARD_DIMENSION]) {
+    if (renderer->isTerminal) appendText(renderer, "\033[r\033[H\033[2J");
+
+    appendText(renderer, "\n=== LUDO GAME BOARD ===\n");
+    appendText(renderer, FRAME_SEPARATOR);
+    for (int i = 0; i < BOARD_DIMENSION; i++) {
+        appendText(renderer, " | ");
+        for (int j = 0; j < BOARD_DIMENSION; j++) {
+            appendCell(renderer, board[i][j]);
+        }
+        appendText(renderer, "\n" FRAME_SEPARATOR);
+    }
+    renderer->cellsDrawn += BOARD_DIMENSION * BOARD_DIMENSION;
+
+    // Keep the board in place and let log lines scroll underneath it
+    if (renderer->isTerminal) {
+        appendText(renderer, "\033[");
+        appendNumber(renderer, BOARD_SCREEN_LINES + 2);
+        renderer->buffer[renderer->length++] = ';';
+        appendNumber(renderer, terminalLines(renderer->fd));
+        appendText(renderer, "r");
+        appendCursorMove(renderer, BOARD_SCREEN_LINES + 2, 1);
+    }
+}
+
+// Function to build a frame with only the cells that changed since the last frame
+static void buildDiffFrame(BoardRenderer *renderer, char board[BOARD_DIMENSION][BOARD_DIMENSION]) {
+    int start = renderer->length;
+    appendText(renderer, "\0337"); // Save the log cursor
+
+    bool changed = false;
+    for (int i = 0; i < BOARD_DIMENSION; i++) {
+        for (int j = 0; j < BOARD_DIMENSION; j++) {
+            char cell = board[i][j];
+            if (cell == renderer->lastBoard[i][j]) continue;
+
+            const char *color = cellColor(cell);
+            appendCursorMove(renderer, 4 + 2 * i, 5 + 5 * j);
+            if (color) appendText(renderer, color);
+            renderer->buffer[renderer->length++] = cell;
+            if (color) appendText(renderer, "\033[0m");
+            renderer->cellsDrawn++;
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        appendText(renderer, "\0338"); // Back to the log cursor
+    } else {
+        renderer->length = start;
+    }
+}
+
+// Function to write the buffered frame
+static void flushFrame(BoardRenderer *renderer) {
+    // Anything printed through stdio must reach the screen before the frame
+    fflush(stdout);
+
+    int offset = 0;
+    while (offset < renderer->length) {
+        ssize_t written = write(renderer->fd, renderer->buffer + offset, renderer->length - offset);
+        renderer->writeCalls++;
+        if (written <= 0) break;
+        offset += (int)written;
+    }
+    renderer->bytesWritten += offset;
+    renderer->length = 0;
+}
+
+// Function to check whether a frame drawn now gets past the frame-rate cap,
+// so callers can skip building it; a frame that does not is counted as skipped
+bool rendererFrameDue(BoardRenderer *renderer, bool force) {
+    if (force || !renderer->hasFrame || rendererClockNs() - renderer->lastFrameNs >= renderer->minFrameIntervalNs) {
+        return true;
+    }
+    renderer->framesSkipped++;
+    return false;
+}
+
+// Function to draw the board; returns false if the frame was skipped by the frame-rate cap.
+// force draws regardless of the cap, e.g. for the final position.
+bool renderFrame(BoardRenderer *renderer, char board[BOARD_DIMENSION][BOARD_DIMENSION], bool force) {
+    if (!rendererFrameDue(renderer, force)) return false;
+    long long now = rendererClockNs();
+
+    if (renderer->hasFrame && renderer->diffEnabled && renderer->isTerminal) {
+        buildDiffFrame(renderer, board);
+    } else {
+        buildFullFrame(renderer, board);
+    }
+    if (renderer->length > 0) flushFrame(renderer);
+
+    memcpy(renderer->lastBoard, board, sizeof(renderer->lastBoard));
+    renderer->hasFrame = true;
+    renderer->lastFrameNs = now;
+    renderer->framesRendered++;
+    return true;
+}
+
+// Function to hand the whole screen back to normal scrolling
+void rendererShutdown(BoardRenderer *renderer) {
+    if (renderer->hasFrame && renderer->isTerminal) {
+        fflush(stdout);
+        const char *reset = "\033[r";
+        if (write(renderer->fd, reset, strlen(reset)) > 0) renderer->writeCalls++;
+    }
+    renderer->hasFrame = false;
+}
+
+// Function to print bytes and system calls per frame
+void rendererPrintStats(const BoardRenderer *renderer) {
+    long frames = renderer->framesRendered > 0 ? renderer->framesRendered : 1;
+    printf("Frames rendered: %ld, skipped by frame cap: %ld\n",
+           renderer->framesRendered, renderer->framesSkipped);
+    printf("Per frame: %.1f bytes, %.2f write calls, %.1f cells\n",
+           (double)renderer->bytesWritten / frames, (double)renderer->writeCalls / frames,
+           (double)renderer->cellsDrawn / frames);
+}
+
+#endif
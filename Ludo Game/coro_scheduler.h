@@ -0,0 +1,121 @@
+#ifndef CORO_SCHEDULER_H
+#define CORO_SCHEDULER_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <atomic>
+
+/*
+ * Coroutine scheduler (C++20; built when the compiler supports coroutines).
+ * A CoroTask is a coroutine that starts suspended and stays suspended at
+ * its end until its owner destroys it. A CoroWorker runs the coroutines
+ * handed to it, one at a time, from a FIFO run queue on the calling
+ * thread. Coroutines wait on a CoroSignal, which holds at most one waiter,
+ * and are put back on the run queue by coroNotify.
+ *
+ * Coroutines that share state are kept on one worker, so they never run at
+ * the same time and need no locks. Run one worker per core for parallelism.
+ */
+
+#if defined(__cpp_impl_coroutine) && __cplusplus >= 202002L
+#define CORO_SCHEDULER_AVAILABLE 1
+#include <coroutine>
+
+// Coroutine frames allocated so far, across all threads
+static std::atomic<long> coroFrameCount(0);
+static std::atomic<long> coroFrameBytes(0);
+
+struct CoroTask {
+    struct promise_type {
+        CoroTask get_return_object() {
+            return CoroTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { abort(); }
+
+        // Frames are counted so the memory per game can be reported
+        static void *operator new(size_t size) {
+            coroFrameCount.fetch_add(1, std::memory_order_relaxed);
+            coroFrameBytes.fetch_add((long)size, std::memory_order_relaxed);
+            return malloc(size);
+        }
+        static void operator delete(void *frame) {
+            free(frame);
+        }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+typedef struct {
+    std::coroutine_handle<> *queue; // Ring buffer of coroutines ready to run
+    int capacity;                   // Size of the ring buffer (a power of two)
+    int head;                       // Index of the next coroutine to run
+    int count;                      // Coroutines waiting to run
+    long resumes;                   // Coroutines resumed
+} CoroWorker;
+
+// A point one coroutine waits at until another notifies it
+typedef struct {
+    std::coroutine_handle<> waiter; // Suspended coroutine, or null
+} CoroSignal;
+
+// Function to set up a worker whose run queue holds at least capacity coroutines
+void coroWorkerInit(CoroWorker *worker, int capacity) {
+    int size = 16;
+    while (size < capacity) size *= 2;
+    worker->queue = (std::coroutine_handle<> *)calloc(size, sizeof(std::coroutine_handle<>));
+    worker->capacity = size;
+    worker->head = 0;
+    worker->count = 0;
+    worker->resumes = 0;
+}
+
+void coroWorkerDestroy(CoroWorker *worker) {
+    free(worker->queue);
+    worker->queue = NULL;
+}
+
+// Function to queue a suspended coroutine to run on the worker
+inline void coroSchedule(CoroWorker *worker, std::coroutine_handle<> handle) {
+    if (worker->count == worker->capacity) abort(); // Sized by the caller; overflow is a bug
+    worker->queue[(worker->head + worker->count) & (worker->capacity - 1)] = handle;
+    worker->count++;
+}
+
+// Function to resume the next ready coroutine; returns false when none is ready
+inline bool coroRunOne(CoroWorker *worker) {
+    if (worker->count == 0) return false;
+    std::coroutine_handle<> handle = worker->queue[worker->head];
+    worker->head = (worker->head + 1) & (worker->capacity - 1);
+    worker->count--;
+    worker->resumes++;
+    handle.resume();
+    return true;
+}
+
+// Function to wake the coroutine waiting on a signal, if there is one
+inline void coroNotify(CoroWorker *worker, CoroSignal *signal) {
+    if (!signal->waiter) return;
+    coroSchedule(worker, signal->waiter);
+    signal->waiter = nullptr;
+}
+
+// Awaitable that parks the coroutine on a signal: co_await coroWait(signal)
+struct CoroWait {
+    CoroSignal *signal;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) noexcept { signal->waiter = handle; }
+    void await_resume() const noexcept {}
+};
+
+inline CoroWait coroWait(CoroSignal *signal) {
+    return CoroWait{signal};
+}
+
+#endif
+
+#endif
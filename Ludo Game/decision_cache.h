@@ -0,0 +1,292 @@
+#ifndef DECISION_CACHE_H
+#define DECISION_CACHE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include "packed_state.h"
+#include "expecti_search.h" // For zobristKeys
+
+/*
+ * Shared move-decision cache.
+ * AI seats in different games keep meeting the same decisions, above all
+ * the opening releases and home path races. The cache remembers the move a
+ * strategy chose for a position and roll, so the next seat to meet it plays
+ * the move without searching. It sits in front of any MoveChooser: a seat's
+ * chooser is swapped for decisionCacheChooseMove, which asks the cache and
+ * only falls back to the seat's own chooser on a miss.
+ *
+ * A player's four tokens are interchangeable, so the key is canonical: each
+ * player's tokens are hashed as a sorted multiset of progress values, and
+ * an entry stores the progress the chosen token moved from rather than its
+ * index. The chooser does not see the roll, but the roll decides the legal
+ * moves, so every legal move's from and to progress is mixed in as well,
+ * in any order. Keys are 64-bit hashes; a collision plays the other
+ * decision's move if it is legal. A hit also skips the strategy's own dice
+ * draws, so games played with the cache do not replay the games without it.
+ *
+ * Memory is fixed when the cache is created. Entries live in sets of
+ * DECISION_CACHE_WAYS, and a full set evicts with the CLOCK policy: a hit
+ * sets an entry's reference bit, and the set's hand clears reference bits
+ * until it reaches an entry without one, which is replaced. Sets are spread
+ * over DECISION_CACHE_SHARDS shards with one mutex each, so threads only
+ * wait for each other when they hit the same shard; those waits are counted.
+ */
+
+#define DECISION_CACHE_SHARDS 64 // Power of two
+#define DECISION_CACHE_WAYS 8    // Entries per set
+
+typedef struct {
+    uint64_t key;       // Decision key (0 = empty)
+    float score;        // Strategy's score of the chosen move (0 if it gives none)
+    uint8_t from;       // Progress the chosen token moved from
+    uint8_t referenced; // CLOCK reference bit
+    uint8_t reserved[2];
+} DecisionEntry;
+
+typedef struct alignas(64) {
+    pthread_mutex_t lock;    // Guards the shard's sets and counters
+    DecisionEntry *entries;  // DECISION_CACHE_WAYS entries per set
+    uint8_t *hands;          // CLOCK hand of each set
+    uint64_t setMask;        // Sets per shard - 1
+    long lookups;            // Lookups in this shard
+    long hits;               // Lookups that found the decision
+    long inserts;            // Decisions stored
+    long evictions;          // Entries replaced by the CLOCK hand
+    long locks;              // Lock acquisitions
+    long contended;          // Acquisitions that had to wait
+    double servedScore;      // Sum of the scores of hits
+} DecisionShard;
+
+typedef struct {
+    DecisionShard shards[DECISION_CACHE_SHARDS];
+    size_t sizeBytes;        // Entries of every shard
+} DecisionCache;
+
+// Scores the last move a chooser picked (NULL for choosers that do not score)
+typedef float (*DecisionScore)(const void *seatData);
+
+// Seat data of decisionCacheChooseMove: the seat's own strategy and the shared cache
+typedef struct {
+    DecisionCache *cache;
+    MoveChooser choose;  // Strategy asked on a miss
+    void *seatData;      // Its seat data
+    DecisionScore score; // Its score of the move it chose
+} DecisionCacheSeat;
+
+// Cache counters summed over the shards
+typedef struct {
+    long lookups, hits, inserts, evictions, locks, contended, entries;
+    double servedScore;
+} DecisionCacheStats;
+
+// Function to create a cache of about sizeMB megabytes (rounded down to a power of two sets)
+DecisionCache *decisionCacheCreate(int sizeMB) {
+    size_t budget = (size_t)(sizeMB > 0 ? sizeMB : 1) << 20;
+    size_t setBytes = DECISION_CACHE_WAYS * sizeof(DecisionEntry);
+    uint64_t sets = 1;
+    while (sets * 2 * setBytes * DECISION_CACHE_SHARDS <= budget) sets *= 2;
+
+    DecisionCache *cache = new DecisionCache();
+    cache->sizeBytes = sets * DECISION_CACHE_SHARDS * DECISION_CACHE_WAYS * sizeof(DecisionEntry);
+    for (int s = 0; s < DECISION_CACHE_SHARDS; s++) {
+        DecisionShard *shard = &cache->shards[s];
+        memset((void *)shard, 0, sizeof(*shard));
+        pthread_mutex_init(&shard->lock, NULL);
+        shard->entries = (DecisionEntry *)calloc(sets * DECISION_CACHE_WAYS, sizeof(DecisionEntry));
+        shard->hands = (uint8_t *)calloc(sets, 1);
+        shard->setMask = sets - 1;
+    }
+    return cache;
+}
+
+void decisionCacheDestroy(DecisionCache *cache) {
+    if (!cache) return;
+    for (int s = 0; s < DECISION_CACHE_SHARDS; s++) {
+        pthread_mutex_destroy(&cache->shards[s].lock);
+        free(cache->shards[s].entries);
+        free(cache->shards[s].hands);
+    }
+    delete cache;
+}
+
+// Function to hash a position with each player's tokens as a sorted multiset,
+// so positions that only swap a player's tokens hash the same
+inline uint64_t decisionPositionHash(const PackedGameState *state) {
+    uint64_t hash = zobristKeys.turn[state->currentTurn];
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        uint8_t sorted[TOKENS_PER_PLAYER];
+        for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
+            uint8_t progress = state->tokens[p * TOKENS_PER_PLAYER + j];
+            int i = j;
+            while (i > 0 && sorted[i - 1] > progress) {
+                sorted[i] = sorted[i - 1];
+                i--;
+            }
+            sorted[i] = progress;
+        }
+        for (int i = 0; i < TOKENS_PER_PLAYER; i++) hash ^= zobristKeys.token[p * TOKENS_PER_PLAYER + i][sorted[i]];
+        hash ^= zobristKeys.sixes[p][packedSixCount(state, p)] ^ zobristKeys.rank[p][packedRank(state, p)];
+    }
+    return hash;
+}
+
+// Function to key a decision: the position and the legal moves the roll gives.
+// Moves are added up so their order (which follows token indexes) does not matter.
+inline uint64_t decisionKey(const PackedGameState *state, const PackedMove *moves, int count) {
+    uint64_t movesHash = 0;
+    for (int i = 0; i < count; i++) {
+        uint64_t move = ((uint64_t)moves[i].from << 8 | moves[i].to) + 1;
+        move *= 0xBF58476D1CE4E5B9ULL;
+        movesHash += move ^ (move >> 31);
+    }
+    uint64_t key = decisionPositionHash(state) ^ (movesHash * 0x94D049BB133111EBULL);
+    return key ? key : 1; // 0 marks an empty entry
+}
+
+// Shards are picked by the top bits of the key, sets by the low bits
+static inline DecisionShard *decisionShard(DecisionCache *cache, uint64_t key) {
+    return &cache->shards[key >> 58 & (DECISION_CACHE_SHARDS - 1)];
+}
+
+// Function to lock a shard, counting the times another thread held it
+static inline void decisionShardLock(DecisionShard *shard) {
+    if (pthread_mutex_trylock(&shard->lock) != 0) {
+        pthread_mutex_lock(&shard->lock);
+        shard->contended++;
+    }
+    shard->locks++;
+}
+
+// Function to look up a decision; returns false if it is not cached
+bool decisionCacheLookup(DecisionCache *cache, uint64_t key, int *from, float *score) {
+    DecisionShard *shard = decisionShard(cache, key);
+    decisionShardLock(shard);
+    DecisionEntry *set = &shard->entries[(key & shard->setMask) * DECISION_CACHE_WAYS];
+    bool found = false;
+    shard->lookups++;
+    for (int way = 0; way < DECISION_CACHE_WAYS; way++) {
+        if (set[way].key == key) {
+            set[way].referenced = 1;
+            *from = set[way].from;
+            *score = set[way].score;
+            shard->hits++;
+            shard->servedScore += set[way].score;
+            found = true;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&shard->lock);
+    return found;
+}
+
+// Function to store a decision, replacing an entry of a full set by CLOCK
+void decisionCacheStore(DecisionCache *cache, uint64_t key, int from, float score) {
+    DecisionShard *shard = decisionShard(cache, key);
+    decisionShardLock(shard);
+    uint64_t setIndex = key & shard->setMask;
+    DecisionEntry *set = &shard->entries[setIndex * DECISION_CACHE_WAYS];
+
+    // Another thread may have stored the same decision meanwhile; otherwise take a free way
+    int way = -1;
+    for (int w = 0; w < DECISION_CACHE_WAYS && way < 0; w++) {
+        if (set[w].key == key) way = w;
+    }
+    for (int w = 0; w < DECISION_CACHE_WAYS && way < 0; w++) {
+        if (set[w].key == 0) way = w;
+    }
+    if (way < 0) {
+        int hand = shard->hands[setIndex];
+        while (set[hand].referenced) {
+            set[hand].referenced = 0;
+            hand = (hand + 1) % DECISION_CACHE_WAYS;
+        }
+        way = hand;
+        shard->hands[setIndex] = (uint8_t)((hand + 1) % DECISION_CACHE_WAYS);
+        shard->evictions++;
+    }
+    if (set[way].key != key) shard->inserts++;
+
+    set[way].key = key;
+    set[way].score = score;
+    set[way].from = (uint8_t)from;
+    set[way].referenced = 0;
+    pthread_mutex_unlock(&shard->lock);
+}
+
+// MoveChooser that plays the cached decision, or asks the seat's strategy and caches its choice
+int decisionCacheChooseMove(void *seatData, const PackedGameState *state, const OccupancyIndex *occupancy,
+                            const PackedMove *moves, int count, DiceRng *rng) {
+    DecisionCacheSeat *seat = (DecisionCacheSeat *)seatData;
+    if (count <= 1) return seat->choose(seat->seatData, state, occupancy, moves, count, rng);
+
+    uint64_t key = decisionKey(state, moves, count);
+    int from;
+    float score;
+    if (decisionCacheLookup(seat->cache, key, &from, &score)) {
+        // Any token moving from the cached progress makes the same move
+        for (int i = 0; i < count; i++) {
+            if (moves[i].from == from) return i;
+        }
+    }
+
+    int choice = seat->choose(seat->seatData, state, occupancy, moves, count, rng);
+    if (choice >= 0) {
+        decisionCacheStore(seat->cache, key, moves[choice].from, seat->score ? seat->score(seat->seatData) : 0.0f);
+    }
+    return choice;
+}
+
+// Function to put the cache in front of every seat that has a strategy.
+// cacheSeats holds the wrapped strategies and must outlive the seats.
+void decisionCacheWrapSeats(DecisionCache *cache, SeatTable *seats, DecisionCacheSeat cacheSeats[MAX_PLAYERS],
+                            DecisionScore (*scoreFor)(MoveChooser choose)) {
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        if (!seats->choose[p] || seats->choose[p] == decisionCacheChooseMove) continue;
+        cacheSeats[p].cache = cache;
+        cacheSeats[p].choose = seats->choose[p];
+        cacheSeats[p].seatData = seats->seatData[p];
+        cacheSeats[p].score = scoreFor ? scoreFor(seats->choose[p]) : NULL;
+        seats->choose[p] = decisionCacheChooseMove;
+        seats->seatData[p] = &cacheSeats[p];
+    }
+}
+
+// Function to add up the counters of every shard
+void decisionCacheGetStats(DecisionCache *cache, DecisionCacheStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    for (int s = 0; s < DECISION_CACHE_SHARDS; s++) {
+        DecisionShard *shard = &cache->shards[s];
+        pthread_mutex_lock(&shard->lock);
+        stats->lookups += shard->lookups;
+        stats->hits += shard->hits;
+        stats->inserts += shard->inserts;
+        stats->evictions += shard->evictions;
+        stats->locks += shard->locks;
+        stats->contended += shard->contended;
+        stats->servedScore += shard->servedScore;
+        for (uint64_t e = 0; e < (shard->setMask + 1) * DECISION_CACHE_WAYS; e++) {
+            if (shard->entries[e].key != 0) stats->entries++;
+        }
+        pthread_mutex_unlock(&shard->lock);
+    }
+}
+
+// Function to print hit rate, evictions and lock contention
+void decisionCachePrintStats(DecisionCache *cache) {
+    DecisionCacheStats stats;
+    decisionCacheGetStats(cache, &stats);
+    long capacity = (long)(cache->sizeBytes / sizeof(DecisionEntry));
+    printf("Decision cache: %.1f MB, %ld of %ld entries used, %d shards\n", cache->sizeBytes / 1048576.0,
+           stats.entries, capacity, DECISION_CACHE_SHARDS);
+    printf("Lookups: %ld, %.1f%% hits (average score %.3f), %ld inserts, %ld evictions\n", stats.lookups,
+           stats.lookups > 0 ? 100.0 * stats.hits / stats.lookups : 0.0,
+           stats.hits > 0 ? stats.servedScore / stats.hits : 0.0, stats.inserts, stats.evictions);
+    printf("Lock contention: %ld waits, %.3f%% of lock acquisitions\n", stats.contended,
+           stats.locks > 0 ? 100.0 * stats.contended / stats.locks : 0.0);
+}
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef DICE_RNG_H
+#define DICE_RNG_H
+
+#include <stdint.h>
+
+/*
+ * Per-game random number generator (xoshiro256**).
+ * Every game owns one, seeded explicitly, so games are reproducible and
+ * parallel simulations never share RNG state or take a lock. Dice values
+ * are drawn without modulo bias, 16 at a time from a single 64-bit output.
+ */
+
+#define DICE_BATCH_SIZE 16
+
+typedef struct {
+    uint64_t state[4];                   // xoshiro256** state
+    uint8_t rollBuffer[DICE_BATCH_SIZE]; // Pre-drawn dice values
+    int rollsLeft;                       // Unused values left in rollBuffer
+} DiceRng;
+
+static inline uint64_t rotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// Function to advance a splitmix64 sequence, used to expand seeds
+static inline uint64_t splitMix64(uint64_t *seed) {
+    uint64_t z = (*seed += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Function to seed the generator; equal seeds give equal games
+void diceRngSeed(DiceRng *rng, uint64_t seed) {
+    for (int i = 0; i < 4; i++) {
+        rng->state[i] = splitMix64(&seed);
+    }
+    rng->rollsLeft = 0;
+}
+
+// Function to draw the next 64 random bits
+static inline uint64_t diceRngNext(DiceRng *rng) {
+    uint64_t *s = rng->state;
+    uint64_t result = rotateLeft(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotateLeft(s[3], 45);
+    return result;
+}
+
+// Function to draw a value in [0, bound) without modulo bias (Lemire's method)
+static inline uint32_t diceRngBelow(DiceRng *rng, uint32_t bound) {
+    uint64_t product = (uint64_t)(uint32_t)(diceRngNext(rng) >> 32) * bound;
+    uint32_t low = (uint32_t)product;
+    if (low < bound) {
+        uint32_t threshold = -bound % bound;
+        while (low < threshold) {
+            product = (uint64_t)(uint32_t)(diceRngNext(rng) >> 32) * bound;
+            low = (uint32_t)product;
+        }
+    }
+    return (uint32_t)(product >> 32);
+}
+
+// Function to fill a buffer with dice values 1..6. Each 64-bit output is split
+// into 16 base-6 digits by repeated multiplication, and rejected when the
+// leftover falls in the biased range, so every value is exactly uniform.
+void diceRngFillRolls(DiceRng *rng, uint8_t *rolls, int count) {
+    const uint64_t batchRange = 2821109907456ULL; // 6^16
+    const uint64_t threshold = (0 - batchRange) % batchRange;
+
+    while (count > 0) {
+        int batch = count < DICE_BATCH_SIZE ? count : DICE_BATCH_SIZE;
+        uint8_t digits[DICE_BATCH_SIZE];
+        uint64_t leftover;
+
+        do {
+            leftover = diceRngNext(rng);
+            for (int i = 0; i < DICE_BATCH_SIZE; i++) {
+                unsigned __int128 product = (unsigned __int128)leftover * 6;
+                digits[i] = (uint8_t)(product >> 64) + 1;
+                leftover = (uint64_t)product;
+            }
+        } while (leftover < threshold);
+
+        for (int i = 0; i < batch; i++) rolls[i] = digits[i];
+        rolls += batch;
+        count -= batch;
+    }
+}
+
+// Function to roll one die, refilling the buffered batch when it runs out
+static inline int diceRngRoll(DiceRng *rng) {
+    if (rng->rollsLeft == 0) {
+        diceRngFillRolls(rng, rng->rollBuffer, DICE_BATCH_SIZE);
+        rng->rollsLeft = DICE_BATCH_SIZE;
+    }
+    return rng->rollBuffer[DICE_BATCH_SIZE - rng->rollsLeft--];
+}
+
+#endif
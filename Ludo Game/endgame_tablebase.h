@@ -0,0 +1,541 @@
+#ifndef ENDGAME_TABLEBASE_H
+#define ENDGAME_TABLEBASE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <atomic>
+#include "packed_state.h"
+#include "thread_pool.h"
+
+/*
+ * Endgame tablebase for the 2-player rules.
+ * An endgame class (a, b) is every position where Blue has a tokens left
+ * to finish and Green b, the rest of their tokens finished. For every
+ * position and player to move the table holds the chance that the mover
+ * wins when both sides play the best move for each roll. The value of a
+ * roll is the best move's value, so a probe per roll is a few lookups.
+ *
+ * Values are found by retrograde analysis. Classes are solved smallest
+ * first, so a move that finishes a token looks up a class that is already
+ * exact. Inside a class, captures and passes lead back into the class, so
+ * it is solved by repeated sweeps (Gauss-Seidel) until no value moves by
+ * more than TABLEBASE_TOLERANCE. Each sweep is split across the pool.
+ *
+ * Positions are indexed without gaps: the unfinished tokens of a side are a
+ * sorted multiset of progress values, ranked with the combinatorial number
+ * system, so a probe is a sort of at most three tokens and a multiply-add.
+ * Sweeps run from the highest index down, which visits the positions a move
+ * leads to before the position itself; only captures and tokens that go
+ * round the track again are left for the next sweep.
+ *
+ * File layout (little-endian), memory-mapped by the engine:
+ *   TablebaseHeader, TablebaseClassInfo[classCount], uint16_t values
+ * A stored value v means a win chance of v / 65535.
+ */
+
+#define TABLEBASE_MAGIC "LUDOTB01"
+#define TABLEBASE_VERSION 2 // 2: home entered only from the last track cell
+#define TABLEBASE_MAX_SIDE 3  // Most unfinished tokens a side may have
+#define TABLEBASE_MAX_TOTAL 4 // Most unfinished tokens on the board
+#define TABLEBASE_TOLERANCE 1e-6f
+#define TABLEBASE_MAX_SWEEPS 1000
+#define TABLEBASE_CHUNK 16384 // Positions per pool task in a sweep (even: both players to move)
+
+typedef TwoPlayerRules EndgameRules;
+typedef PackedState<TwoPlayerRules> EndgameState;
+typedef Occupancy<TwoPlayerRules> EndgameOccupancy;
+
+// Progress values an unfinished token can have (yard, track and home path before the finish)
+#define TABLEBASE_PROGRESS_VALUES EndgameRules::progressFinished
+
+typedef struct {
+    char magic[8];       // TABLEBASE_MAGIC
+    uint32_t version;    // TABLEBASE_VERSION
+    uint32_t classCount; // Entries after the header
+} TablebaseHeader;
+
+typedef struct {
+    uint8_t blueTokens;    // Unfinished Blue tokens (a)
+    uint8_t greenTokens;   // Unfinished Green tokens (b)
+    uint16_t reserved;
+    uint32_t sweeps;       // Sweeps the class needed to converge
+    uint64_t offset;       // Byte offset of the class's values in the file
+    uint64_t positions;    // Values in the class (both players to move)
+} TablebaseClassInfo;
+
+typedef struct {
+    int fd;                                                      // Open table file
+    const uint8_t *data;                                         // Mapped file
+    size_t size;                                                 // Size of the mapping
+    const uint16_t *values[TABLEBASE_MAX_SIDE + 1][TABLEBASE_MAX_SIDE + 1]; // Values of each class (NULL = absent)
+} Tablebase;
+
+// Binomial coefficients for ranking multisets
+typedef struct {
+    uint32_t value[TABLEBASE_PROGRESS_VALUES + TABLEBASE_MAX_SIDE][TABLEBASE_MAX_SIDE + 1];
+} TablebaseBinomials;
+
+constexpr TablebaseBinomials buildTablebaseBinomials() {
+    TablebaseBinomials table = {};
+    for (int n = 0; n < TABLEBASE_PROGRESS_VALUES + TABLEBASE_MAX_SIDE; n++) {
+        table.value[n][0] = 1;
+        for (int k = 1; k <= TABLEBASE_MAX_SIDE; k++) {
+            table.value[n][k] = n == 0 ? 0 : table.value[n - 1][k - 1] + table.value[n - 1][k];
+        }
+    }
+    return table;
+}
+
+constexpr TablebaseBinomials tablebaseBinomials = buildTablebaseBinomials();
+
+// Function to get how many multisets of k unfinished tokens there are
+constexpr uint32_t tablebaseSideCount(int k) {
+    return tablebaseBinomials.value[TABLEBASE_PROGRESS_VALUES + k - 1][k];
+}
+
+// Function to get how many positions a class has, both players to move
+constexpr uint64_t tablebaseClassPositions(int a, int b) {
+    return 2ULL * tablebaseSideCount(a) * tablebaseSideCount(b);
+}
+
+inline bool tablebaseHasClass(int a, int b) {
+    return a >= 1 && b >= 1 && a <= TABLEBASE_MAX_SIDE && b <= TABLEBASE_MAX_SIDE && a + b <= TABLEBASE_MAX_TOTAL;
+}
+
+// Function to rank a sorted multiset of k progress values
+inline uint32_t tablebaseSideRank(const uint8_t *sorted, int k) {
+    uint32_t rank = 0;
+    for (int i = 0; i < k; i++) rank += tablebaseBinomials.value[sorted[i] + i][i + 1];
+    return rank;
+}
+
+// The player to move is the lowest digit of the index, Blue's rank the next
+// and Green's the highest. A move usually raises the mover's rank, so the
+// positions a move leads to mostly have higher indexes.
+static inline uint64_t tablebaseIndex(int a, int b, const uint8_t *blue, const uint8_t *green, int turn) {
+    return ((uint64_t)tablebaseSideRank(green, b) * tablebaseSideCount(a) + tablebaseSideRank(blue, a)) * 2 + turn;
+}
+
+// Function to collect a player's unfinished tokens in ascending order; returns how many
+static inline int tablebaseSortedSide(const EndgameState *state, int player, uint8_t sorted[TOKENS_PER_PLAYER]) {
+    int count = 0;
+    for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
+        uint8_t progress = state->tokens[player * TOKENS_PER_PLAYER + j];
+        if (progress == EndgameRules::progressFinished) continue;
+        int i = count++;
+        while (i > 0 && sorted[i - 1] > progress) {
+            sorted[i] = sorted[i - 1];
+            i--;
+        }
+        sorted[i] = progress;
+    }
+    return count;
+}
+
+// Function to find a state's class and index; returns false if no class holds it
+inline bool tablebaseLocate(const EndgameState *state, int *a, int *b, uint64_t *index) {
+    uint8_t blue[TOKENS_PER_PLAYER], green[TOKENS_PER_PLAYER];
+    *a = tablebaseSortedSide(state, 0, blue);
+    *b = tablebaseSortedSide(state, 1, green);
+    if (!tablebaseHasClass(*a, *b)) return false;
+    *index = tablebaseIndex(*a, *b, blue, green, state->currentTurn);
+    return true;
+}
+
+// Function to look up the chance that the player to move wins; returns false outside the table
+inline bool tablebaseProbe(const Tablebase *table, const EndgameState *state, float *winChance) {
+    int a, b;
+    uint64_t index;
+    if (!tablebaseLocate(state, &a, &b, &index) || !table->values[a][b]) return false;
+    *winChance = table->values[a][b][index] / 65535.0f;
+    return true;
+}
+
+// Function to play a move on a copy of the position and pass the turn
+static inline void tablebaseAfterMove(const EndgameState *state, const EndgameOccupancy *occupancy,
+                                      const PackedMove *move, EndgameState *after) {
+    EndgameOccupancy scratch = *occupancy;
+    *after = *state;
+    applyMove(after, &scratch, move);
+    after->currentTurn = (uint8_t)((state->currentTurn + 1) % EndgameRules::players);
+}
+
+// Function to check whether the player who just moved has finished every token
+static inline bool tablebaseMoverWon(const EndgameState *after, int mover) {
+    for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
+        if (after->tokens[mover * TOKENS_PER_PLAYER + j] != EndgameRules::progressFinished) return false;
+    }
+    return true;
+}
+
+// Function to pick the move with the best win chance for the mover. Returns
+// the move index, or -1 when the position is not in the table.
+int tablebaseChooseMove(const Tablebase *table, const EndgameState *state, const EndgameOccupancy *occupancy,
+                        const PackedMove *moves, int count, float *winChance) {
+    int best = -1;
+    float bestChance = -1.0f;
+    for (int i = 0; i < count; i++) {
+        EndgameState after;
+        tablebaseAfterMove(state, occupancy, &moves[i], &after);
+
+        float chance = 1.0f;
+        if (!tablebaseMoverWon(&after, state->currentTurn)) {
+            float opponentChance;
+            if (!tablebaseProbe(table, &after, &opponentChance)) return -1;
+            chance = 1.0f - opponentChance;
+        }
+        if (chance > bestChance) {
+            bestChance = chance;
+            best = i;
+        }
+    }
+    if (winChance) *winChance = bestChance;
+    return best;
+}
+
+static bool tablebaseHeaderValid(const TablebaseHeader *header) {
+    return memcmp(header->magic, TABLEBASE_MAGIC, sizeof(header->magic)) == 0 && header->version == TABLEBASE_VERSION;
+}
+
+// Function to memory-map a table file; returns NULL on error
+Tablebase *tablebaseOpen(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return NULL;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(TablebaseHeader)) {
+        fprintf(stderr, "%s: not an endgame tablebase\n", path);
+        close(fd);
+        return NULL;
+    }
+    void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        perror("mmap");
+        close(fd);
+        return NULL;
+    }
+
+    Tablebase *table = (Tablebase *)calloc(1, sizeof(Tablebase));
+    table->fd = fd;
+    table->data = (const uint8_t *)data;
+    table->size = info.st_size;
+
+    const TablebaseHeader *header = (const TablebaseHeader *)data;
+    bool valid = tablebaseHeaderValid(header) &&
+                 sizeof(TablebaseHeader) + header->classCount * sizeof(TablebaseClassInfo) <= table->size;
+    const TablebaseClassInfo *classes = (const TablebaseClassInfo *)(table->data + sizeof(TablebaseHeader));
+    for (uint32_t c = 0; valid && c < header->classCount; c++) {
+        int a = classes[c].blueTokens, b = classes[c].greenTokens;
+        valid = tablebaseHasClass(a, b) && classes[c].positions == tablebaseClassPositions(a, b) &&
+                classes[c].offset + classes[c].positions * sizeof(uint16_t) <= table->size;
+        if (valid) table->values[a][b] = (const uint16_t *)(table->data + classes[c].offset);
+    }
+    if (!valid) {
+        fprintf(stderr, "%s: not an endgame tablebase of version %d\n", path, TABLEBASE_VERSION);
+        munmap(data, info.st_size);
+        close(fd);
+        free(table);
+        return NULL;
+    }
+    // Probes jump around the file
+    madvise(data, info.st_size, MADV_RANDOM);
+    return table;
+}
+
+void tablebaseClose(Tablebase *table) {
+    if (!table) return;
+    munmap((void *)table->data, table->size);
+    close(table->fd);
+    free(table);
+}
+
+// Generation
+
+typedef struct {
+    std::atomic<float> *values[TABLEBASE_MAX_SIDE + 1][TABLEBASE_MAX_SIDE + 1]; // Solved and in-progress classes
+    uint8_t *sides[TABLEBASE_MAX_SIDE + 1];  // Sorted multiset of each rank, k bytes per entry
+    int blueTokens, greenTokens;             // Class being solved
+} TablebaseBuilder;
+
+typedef struct {
+    TablebaseBuilder *builder;
+    uint64_t first, last; // Positions of this slice of the sweep
+    float maxChange;      // Largest change made to a value in the slice
+} TablebaseSweepTask;
+
+// Function to list every sorted multiset of k progress values in rank order
+static uint8_t *tablebaseBuildSides(int k) {
+    uint8_t *sides = (uint8_t *)malloc((size_t)tablebaseSideCount(k) * (k > 0 ? k : 1));
+    uint8_t values[TABLEBASE_MAX_SIDE] = {0};
+    for (;;) {
+        memcpy(&sides[(size_t)tablebaseSideRank(values, k) * k], values, k);
+        int i = 0;
+        while (i < k) {
+            // Advance like an odometer, keeping values[i] <= values[i + 1]
+            int limit = i + 1 < k ? values[i + 1] : TABLEBASE_PROGRESS_VALUES - 1;
+            if (values[i] < limit) {
+                values[i]++;
+                for (int j = 0; j < i; j++) values[j] = 0;
+                break;
+            }
+            i++;
+        }
+        if (i == k) break;
+    }
+    return sides;
+}
+
+// Function to build the position with a given index in the class being solved
+static void tablebaseDecode(const TablebaseBuilder *builder, uint64_t index, EndgameState *state) {
+    int a = builder->blueTokens, b = builder->greenTokens;
+    uint64_t ranks = index / 2;
+    uint64_t blueRank = ranks % tablebaseSideCount(a);
+    uint64_t greenRank = ranks / tablebaseSideCount(a);
+
+    packedResetState(state);
+    memset(state->tokens, EndgameRules::progressFinished, sizeof(state->tokens));
+    memcpy(&state->tokens[0], &builder->sides[a][blueRank * a], a);
+    memcpy(&state->tokens[TOKENS_PER_PLAYER], &builder->sides[b][greenRank * b], b);
+    state->currentTurn = (uint8_t)(index % 2);
+}
+
+// Function to find where a move leads in the class being solved without
+// playing it. A decoded position keeps each side's tokens sorted at the front
+// of its slots, so the mover's token slides to its new progress
+// (or leaves the side when it finishes) and a captured token goes back to the
+// front of its side. Returns false when the move finishes the mover's last token.
+static inline bool tablebaseSuccessor(const EndgameState *state, const EndgameOccupancy *occupancy,
+                                      const int counts[2], const PackedMove *move, int *a, int *b,
+                                      uint64_t *index) {
+    uint8_t sides[2][TOKENS_PER_PLAYER];
+    int sizes[2] = { counts[0], counts[1] };
+    memcpy(sides[0], &state->tokens[0], TOKENS_PER_PLAYER);
+    memcpy(sides[1], &state->tokens[TOKENS_PER_PLAYER], TOKENS_PER_PLAYER);
+    int mover = state->currentTurn;
+
+    uint8_t *side = sides[mover];
+    int j = move->token;
+    if (move->to == EndgameRules::progressFinished) {
+        if (--sizes[mover] == 0) return false;
+        memmove(&side[j], &side[j + 1], sizes[mover] - j);
+    } else {
+        // Tokens that go round the track again wrap to a lower progress
+        for (; j + 1 < sizes[mover] && side[j + 1] < move->to; j++) side[j] = side[j + 1];
+        for (; j > 0 && side[j - 1] > move->to; j--) side[j] = side[j - 1];
+        side[j] = move->to;
+    }
+
+    if (move->flags & MOVE_CAPTURE) {
+        int victim = occupancyCaptureVictim(occupancy, mover, ruleRoutes<EndgameRules>.trackIndex[mover][move->to]);
+        uint8_t *opponent = sides[victim / TOKENS_PER_PLAYER];
+        for (int v = victim % TOKENS_PER_PLAYER; v > 0; v--) opponent[v] = opponent[v - 1];
+        opponent[0] = PROGRESS_YARD;
+    }
+
+    *a = sizes[0];
+    *b = sizes[1];
+    *index = tablebaseIndex(*a, *b, sides[0], sides[1], 1 - mover);
+    return true;
+}
+
+// Function to add up the best move's value over the rolls that move something,
+// from the current values of the positions they lead to. Rolls without a move
+// pass the same position to the opponent; they are counted in passes.
+static float tablebaseEvaluate(const TablebaseBuilder *builder, const EndgameState *state,
+                               const EndgameOccupancy *occupancy, int *passes) {
+    const int counts[2] = { builder->blueTokens, builder->greenTokens };
+    float total = 0.0f;
+    *passes = 0;
+
+    for (int roll = 1; roll <= 6; roll++) {
+        PackedMove moves[TOKENS_PER_PLAYER];
+        int count = generateMoves(state, occupancy, roll, moves);
+        if (count == 0) (*passes)++;
+
+        float best = 0.0f;
+        for (int i = 0; i < count; i++) {
+            int a, b;
+            uint64_t index;
+            float chance = 1.0f;
+            if (tablebaseSuccessor(state, occupancy, counts, &moves[i], &a, &b, &index)) {
+                chance = 1.0f - builder->values[a][b][index].load(std::memory_order_relaxed);
+            }
+            if (chance > best) best = chance;
+        }
+        total += best;
+    }
+    return total;
+}
+
+// Pool task: one sweep over a slice of the class, highest index first. The two
+// players to move of a position are solved together, so passes back and forth
+// (common while tokens wait in the yard) are exact within the sweep:
+//   v0 = m0 + c0 (1 - v1),  v1 = m1 + c1 (1 - v0)
+// where m is the moving rolls' share and c the chance of passing.
+static void tablebaseSweepSlice(void *arg, int workerID) {
+    (void)workerID;
+    TablebaseSweepTask *task = (TablebaseSweepTask *)arg;
+    TablebaseBuilder *builder = task->builder;
+    std::atomic<float> *values = builder->values[builder->blueTokens][builder->greenTokens];
+    float maxChange = 0.0f;
+
+    for (uint64_t index = task->last; index > task->first; index -= 2) {
+        EndgameState state;
+        EndgameOccupancy occupancy;
+        tablebaseDecode(builder, index - 2, &state);
+        occupancyBuild(&occupancy, &state);
+
+        float moving[2], pass[2];
+        for (int turn = 0; turn < 2; turn++) {
+            int passes;
+            state.currentTurn = (uint8_t)turn;
+            moving[turn] = tablebaseEvaluate(builder, &state, &occupancy, &passes) / 6.0f;
+            pass[turn] = passes / 6.0f;
+        }
+        // Every unfinished token moves on some roll, so c0 c1 <= 25/36
+        float blue = (moving[0] + pass[0] * (1.0f - moving[1] - pass[1])) / (1.0f - pass[0] * pass[1]);
+        float green = moving[1] + pass[1] * (1.0f - blue);
+
+        float solved[2] = { blue, green };
+        for (int turn = 0; turn < 2; turn++) {
+            float change = solved[turn] - values[index - 2 + turn].load(std::memory_order_relaxed);
+            if (change < 0) change = -change;
+            if (change > maxChange) maxChange = change;
+            values[index - 2 + turn].store(solved[turn], std::memory_order_relaxed);
+        }
+    }
+    task->maxChange = maxChange;
+}
+
+// Function to solve one class once every smaller class is solved; returns the sweeps taken
+static int tablebaseSolveClass(TablebaseBuilder *builder, WorkStealingPool *pool, int a, int b) {
+    uint64_t positions = tablebaseClassPositions(a, b);
+    std::atomic<float> *values = new std::atomic<float>[positions];
+    for (uint64_t i = 0; i < positions; i++) values[i].store(0.5f, std::memory_order_relaxed);
+    builder->values[a][b] = values;
+    builder->blueTokens = a;
+    builder->greenTokens = b;
+
+    uint64_t taskCount = (positions + TABLEBASE_CHUNK - 1) / TABLEBASE_CHUNK;
+    TablebaseSweepTask *tasks = (TablebaseSweepTask *)calloc(taskCount, sizeof(TablebaseSweepTask));
+    for (uint64_t t = 0; t < taskCount; t++) {
+        tasks[t].builder = builder;
+        tasks[t].first = t * TABLEBASE_CHUNK;
+        tasks[t].last = tasks[t].first + TABLEBASE_CHUNK < positions ? tasks[t].first + TABLEBASE_CHUNK : positions;
+    }
+
+    int sweeps = 0;
+    float maxChange;
+    do {
+        // Later slices hold the more advanced positions, so they are queued first
+        for (uint64_t t = taskCount; t-- > 0;) poolSubmit(pool, tablebaseSweepSlice, &tasks[t]);
+        poolRun(pool);
+        sweeps++;
+
+        maxChange = 0.0f;
+        for (uint64_t t = 0; t < taskCount; t++) {
+            if (tasks[t].maxChange > maxChange) maxChange = tasks[t].maxChange;
+        }
+    } while (maxChange > TABLEBASE_TOLERANCE && sweeps < TABLEBASE_MAX_SWEEPS);
+
+    free(tasks);
+    return sweeps;
+}
+
+// Function to solve every class and write the table; returns false on error
+bool tablebaseGenerate(const char *path, int workerCount) {
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+
+    TablebaseBuilder *builder = (TablebaseBuilder *)calloc(1, sizeof(TablebaseBuilder));
+    for (int k = 1; k <= TABLEBASE_MAX_SIDE; k++) builder->sides[k] = tablebaseBuildSides(k);
+    WorkStealingPool *pool = poolCreate(workerCount);
+
+    // Classes in order of unfinished tokens, so every class a move can leave for is solved
+    TablebaseClassInfo classes[TABLEBASE_MAX_SIDE * TABLEBASE_MAX_SIDE];
+    int classCount = 0;
+    for (int total = 2; total <= TABLEBASE_MAX_TOTAL; total++) {
+        for (int a = 1; a <= TABLEBASE_MAX_SIDE; a++) {
+            int b = total - a;
+            if (tablebaseHasClass(a, b)) {
+                memset(&classes[classCount], 0, sizeof(TablebaseClassInfo));
+                classes[classCount].blueTokens = (uint8_t)a;
+                classes[classCount].greenTokens = (uint8_t)b;
+                classes[classCount].positions = tablebaseClassPositions(a, b);
+                classCount++;
+            }
+        }
+    }
+    uint64_t offset = sizeof(TablebaseHeader) + classCount * sizeof(TablebaseClassInfo);
+    for (int c = 0; c < classCount; c++) {
+        classes[c].offset = offset;
+        offset += (classes[c].positions * sizeof(uint16_t) + 7) & ~7ULL;
+    }
+
+    TablebaseHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TABLEBASE_MAGIC, sizeof(header.magic));
+    header.version = TABLEBASE_VERSION;
+    header.classCount = classCount;
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(classes, sizeof(TablebaseClassInfo), classCount, file);
+
+    printf("=== ENDGAME TABLEBASE (2 players, %d workers) ===\n", pool->workerCount);
+    printf("%-8s %12s %8s %10s %12s\n", "class", "positions", "sweeps", "seconds", "bytes");
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int c = 0; c < classCount; c++) {
+        int a = classes[c].blueTokens, b = classes[c].greenTokens;
+        struct timespec classStart, classEnd;
+        clock_gettime(CLOCK_MONOTONIC, &classStart);
+        classes[c].sweeps = tablebaseSolveClass(builder, pool, a, b);
+        clock_gettime(CLOCK_MONOTONIC, &classEnd);
+
+        // Quantize and write the class at its offset
+        uint64_t positions = classes[c].positions;
+        uint16_t *quantized = (uint16_t *)malloc(positions * sizeof(uint16_t));
+        for (uint64_t i = 0; i < positions; i++) {
+            float value = builder->values[a][b][i].load(std::memory_order_relaxed);
+            quantized[i] = (uint16_t)(value * 65535.0f + 0.5f);
+        }
+        fseek(file, (long)classes[c].offset, SEEK_SET);
+        fwrite(quantized, sizeof(uint16_t), positions, file);
+        free(quantized);
+
+        printf("%d v %d    %12llu %8u %10.2f %12llu\n", a, b, (unsigned long long)positions, classes[c].sweeps,
+               (classEnd.tv_sec - classStart.tv_sec) + (classEnd.tv_nsec - classStart.tv_nsec) / 1e9,
+               (unsigned long long)(positions * sizeof(uint16_t)));
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    // The header again, now with the sweep counts
+    fseek(file, sizeof(header), SEEK_SET);
+    fwrite(classes, sizeof(TablebaseClassInfo), classCount, file);
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    bool written = fclose(file) == 0;
+    printf("Total: %.2f s, %ld bytes written to %s\n",
+           (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9, fileSize, path);
+
+    poolDestroy(pool);
+    for (int a = 0; a <= TABLEBASE_MAX_SIDE; a++) {
+        for (int b = 0; b <= TABLEBASE_MAX_SIDE; b++) delete[] builder->values[a][b];
+    }
+    for (int k = 1; k <= TABLEBASE_MAX_SIDE; k++) free(builder->sides[k]);
+    free(builder);
+    return written;
+}
+
+#endif
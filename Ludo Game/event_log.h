@@ -0,0 +1,442 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "packed_state.h"
+
+/*
+ * Append-only binary event log.
+ * Every turn is one 32-bit event: player, roll, token moved, from/to
+ * progress, captured token and new rank. A game is written as
+ *
+ *   GAME_START, then blocks of [KEYFRAME, up to keyframeInterval events], GAME_END
+ *
+ * Keyframes hold the full packed state, so the state at any turn is one
+ * keyframe copy plus fewer than keyframeInterval event applications, and
+ * the keyframe offset is computed, not searched. Records are read in place
+ * from a memory-mapped file. The format is little-endian.
+ */
+
+#define EVENT_LOG_MAGIC "LUDOLOG1"
+#define EVENT_LOG_VERSION 1
+#define DEFAULT_KEYFRAME_INTERVAL 64
+
+// Control records have bit 7 of their first byte set; turn events never do
+#define LOG_CONTROL 0x80
+#define LOG_GAME_START (LOG_CONTROL | 1)
+#define LOG_KEYFRAME (LOG_CONTROL | 2)
+#define LOG_GAME_END (LOG_CONTROL | 3)
+
+// Turn event layout (bit positions in the 32-bit word)
+#define EVENT_PLAYER_SHIFT 0   // 2 bits: player (0-based)
+#define EVENT_ROLL_SHIFT 2     // 3 bits: dice value 1..6
+#define EVENT_MOVED 0x20       // A token moved
+#define EVENT_CAPTURE 0x40     // An opponent's token was sent to its yard
+#define EVENT_TOKEN_SHIFT 8    // 2 bits: token moved
+#define EVENT_FROM_SHIFT 10    // 6 bits: progress before the move
+#define EVENT_TO_SHIFT 16      // 6 bits: progress after the move
+#define EVENT_VICTIM_SHIFT 22  // 4 bits: captured player * 4 + token
+#define EVENT_RANK_SHIFT 26    // 3 bits: rank reached this turn (0 = none)
+
+typedef uint32_t LogEvent;
+
+typedef struct {
+    char magic[8];             // EVENT_LOG_MAGIC
+    uint32_t version;          // EVENT_LOG_VERSION
+    uint32_t keyframeInterval; // Turn events between keyframes
+} EventLogHeader;
+
+typedef struct {
+    uint32_t tag;       // LOG_GAME_START
+    uint32_t gameIndex; // Caller's game number
+    uint64_t seed;      // Seed the game was played with
+} LogGameStart;
+
+typedef struct {
+    uint32_t tag;          // LOG_KEYFRAME | game tag << 8
+    uint32_t turn;         // Turns played before this keyframe
+    PackedGameState state; // State after those turns
+} LogKeyframe;
+
+typedef struct {
+    uint32_t tag;   // LOG_GAME_END
+    uint32_t turns; // Turns played in the game
+} LogGameEnd;
+
+static_assert(sizeof(LogKeyframe) == 32, "Keyframes are 32 bytes");
+static_assert(sizeof(LogGameStart) % sizeof(LogEvent) == 0 && sizeof(LogGameEnd) % sizeof(LogEvent) == 0,
+              "Records stay aligned to events");
+
+typedef struct {
+    FILE *file;                // Log file, opened for appending
+    uint32_t keyframeInterval; // Turn events between keyframes
+    PackedGameState state;     // State of the game being written
+    uint32_t turn;             // Turns written for the game being written
+    uint32_t keyframeTag;      // Keyframe tag of the game being written
+    long eventsWritten;        // Turn events written
+    long bytesWritten;         // Bytes appended
+} EventLogWriter;
+
+// Location of one game in a mapped log
+typedef struct {
+    size_t offset;      // Offset of the game's first keyframe
+    uint32_t turns;     // Turns played
+    uint32_t gameIndex; // Game number from the game start record
+    uint64_t seed;      // Seed from the game start record
+} LogGameEntry;
+
+typedef struct {
+    int fd;                    // Open log file
+    const uint8_t *data;       // Mapped file
+    size_t size;               // Size of the mapping
+    uint32_t keyframeInterval; // Turn events between keyframes
+    LogGameEntry *games;       // Games found by eventLogIndexGames
+    long gameCount;            // Entries in games
+} EventLogReader;
+
+// Totals gathered by scanning a log
+typedef struct {
+    long games;                  // Complete games
+    long turns;                  // Turn events
+    long rollCounts[7];          // Turns per dice value
+    long releases;               // Tokens released from the yard
+    long captures[MAX_PLAYERS];  // Tokens captured by each player
+    long finishes;               // Tokens that reached the end of the home path
+    long winsBySeat[MAX_PLAYERS];// First places per player
+    long longestGame;            // Most turns in a game
+} LogAnalytics;
+
+inline int eventPlayer(LogEvent event) { return (event >> EVENT_PLAYER_SHIFT) & 3; }
+inline int eventRoll(LogEvent event) { return (event >> EVENT_ROLL_SHIFT) & 7; }
+inline int eventToken(LogEvent event) { return (event >> EVENT_TOKEN_SHIFT) & 3; }
+inline int eventFrom(LogEvent event) { return (event >> EVENT_FROM_SHIFT) & 63; }
+inline int eventTo(LogEvent event) { return (event >> EVENT_TO_SHIFT) & 63; }
+inline int eventVictim(LogEvent event) { return (event >> EVENT_VICTIM_SHIFT) & 15; }
+inline int eventRank(LogEvent event) { return (event >> EVENT_RANK_SHIFT) & 7; }
+
+inline uint32_t recordTag(const uint8_t *record) {
+    uint32_t tag;
+    memcpy(&tag, record, sizeof(tag));
+    return tag;
+}
+
+inline int recordKind(const uint8_t *record) {
+    return record[0];
+}
+
+inline bool isControlRecord(const uint8_t *record) {
+    return (record[0] & LOG_CONTROL) != 0;
+}
+
+// Function to apply a logged turn to a state; follows packedPlayTurn exactly
+void eventLogApply(PackedGameState *state, LogEvent event) {
+    int player = eventPlayer(event);
+
+    if (event & EVENT_MOVED) {
+        state->tokens[player * TOKENS_PER_PLAYER + eventToken(event)] = (uint8_t)eventTo(event);
+    }
+    if (event & EVENT_CAPTURE) {
+        state->tokens[eventVictim(event)] = PROGRESS_YARD;
+        if (state->killCounts[player] < 255) state->killCounts[player]++;
+    }
+
+    if (eventRoll(event) != 6) {
+        packedSetSixCount(state, player, 0);
+    } else if (!(event & EVENT_MOVED)) {
+        int sixes = packedSixCount(state, player) + 1;
+        packedSetSixCount(state, player, sixes >= 3 ? 0 : sixes);
+    }
+
+    if (eventRank(event) != 0) packedSetRank(state, player, eventRank(event));
+    state->currentTurn = (uint8_t)((player + 1) % MAX_PLAYERS);
+}
+
+// Function to describe a turn as the difference between two states
+LogEvent eventLogEncode(const PackedGameState *before, const PackedGameState *after, int roll) {
+    int player = before->currentTurn;
+    LogEvent event = ((LogEvent)player << EVENT_PLAYER_SHIFT) | ((LogEvent)roll << EVENT_ROLL_SHIFT);
+
+    for (int i = 0; i < TOTAL_TOKENS; i++) {
+        if (before->tokens[i] == after->tokens[i]) continue;
+
+        if (i / TOKENS_PER_PLAYER == player) {
+            event |= EVENT_MOVED | ((LogEvent)(i % TOKENS_PER_PLAYER) << EVENT_TOKEN_SHIFT) |
+                     ((LogEvent)before->tokens[i] << EVENT_FROM_SHIFT) |
+                     ((LogEvent)after->tokens[i] << EVENT_TO_SHIFT);
+        } else {
+            event |= EVENT_CAPTURE | ((LogEvent)i << EVENT_VICTIM_SHIFT);
+        }
+    }
+
+    if (packedRank(before, player) == 0 && packedRank(after, player) != 0) {
+        event |= (LogEvent)packedRank(after, player) << EVENT_RANK_SHIFT;
+    }
+    return event;
+}
+
+static void writeRecord(EventLogWriter *writer, const void *record, size_t size) {
+    fwrite(record, size, 1, writer->file);
+    writer->bytesWritten += size;
+}
+
+// Function to open a log for appending, writing the header if the file is new
+EventLogWriter *eventLogCreate(const char *path, int keyframeInterval) {
+    FILE *file = fopen(path, "a+b");
+    if (!file) {
+        perror(path);
+        return NULL;
+    }
+
+    EventLogHeader header;
+    fseek(file, 0, SEEK_END);
+    if (ftell(file) == 0) {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, EVENT_LOG_MAGIC, sizeof(header.magic));
+        header.version = EVENT_LOG_VERSION;
+        header.keyframeInterval = keyframeInterval > 0 ? keyframeInterval : DEFAULT_KEYFRAME_INTERVAL;
+        fwrite(&header, sizeof(header), 1, file);
+    } else {
+        // Appending to an existing log keeps its keyframe interval
+        rewind(file);
+        if (fread(&header, sizeof(header), 1, file) != 1 ||
+            memcmp(header.magic, EVENT_LOG_MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != EVENT_LOG_VERSION) {
+            fprintf(stderr, "%s: not an event log\n", path);
+            fclose(file);
+            return NULL;
+        }
+        fseek(file, 0, SEEK_END);
+    }
+
+    EventLogWriter *writer = (EventLogWriter *)calloc(1, sizeof(EventLogWriter));
+    writer->file = file;
+    writer->keyframeInterval = header.keyframeInterval;
+    setvbuf(file, NULL, _IOFBF, 1 << 16);
+    return writer;
+}
+
+// Function to start logging a new game from the initial position
+void eventLogBeginGame(EventLogWriter *writer, uint32_t gameIndex, uint64_t seed) {
+    // Keyframes carry 24 bits of the game's file offset, so the indexer can
+    // tell a game's own next block from a keyframe of the game after it
+    uint32_t gameTag = (uint32_t)(ftell(writer->file) / sizeof(LogEvent)) & 0xFFFFFF;
+    writer->keyframeTag = LOG_KEYFRAME | (gameTag << 8);
+
+    LogGameStart start = { LOG_GAME_START, gameIndex, seed };
+    writeRecord(writer, &start, sizeof(start));
+    packedResetState(&writer->state);
+    writer->turn = 0;
+}
+
+// Function to log a turn given the roll and the state after it
+void eventLogRecordTurn(EventLogWriter *writer, int roll, const PackedGameState *after) {
+    if (writer->turn % writer->keyframeInterval == 0) {
+        LogKeyframe keyframe = { writer->keyframeTag, writer->turn, writer->state };
+        writeRecord(writer, &keyframe, sizeof(keyframe));
+    }
+
+    LogEvent event = eventLogEncode(&writer->state, after, roll);
+    writeRecord(writer, &event, sizeof(event));
+
+    // Keyframes come from the logged events, so replay always agrees with them
+    eventLogApply(&writer->state, event);
+    writer->turn++;
+    writer->eventsWritten++;
+}
+
+// Function to close the current game
+void eventLogEndGame(EventLogWriter *writer) {
+    LogGameEnd end = { LOG_GAME_END, writer->turn };
+    writeRecord(writer, &end, sizeof(end));
+}
+
+void eventLogClose(EventLogWriter *writer) {
+    if (!writer) return;
+    fclose(writer->file);
+    free(writer);
+}
+
+// Function to memory-map a log for reading; returns NULL on error
+EventLogReader *eventLogOpen(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return NULL;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(EventLogHeader)) {
+        fprintf(stderr, "%s: not an event log\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        perror("mmap");
+        close(fd);
+        return NULL;
+    }
+
+    const EventLogHeader *header = (const EventLogHeader *)data;
+    if (memcmp(header->magic, EVENT_LOG_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != EVENT_LOG_VERSION || header->keyframeInterval == 0) {
+        fprintf(stderr, "%s: not an event log\n", path);
+        munmap(data, info.st_size);
+        close(fd);
+        return NULL;
+    }
+
+    EventLogReader *reader = (EventLogReader *)calloc(1, sizeof(EventLogReader));
+    reader->fd = fd;
+    reader->data = (const uint8_t *)data;
+    reader->size = info.st_size;
+    reader->keyframeInterval = header->keyframeInterval;
+    return reader;
+}
+
+void eventLogCloseReader(EventLogReader *reader) {
+    if (!reader) return;
+    munmap((void *)reader->data, reader->size);
+    close(reader->fd);
+    free(reader->games);
+    free(reader);
+}
+
+// Function to find every complete game. Full blocks are skipped by their
+// fixed size, so only the last block of each game is walked event by event.
+long eventLogIndexGames(EventLogReader *reader) {
+    size_t blockSize = sizeof(LogKeyframe) + reader->keyframeInterval * sizeof(LogEvent);
+    size_t offset = sizeof(EventLogHeader);
+    long capacity = 1024;
+    reader->games = (LogGameEntry *)realloc(reader->games, capacity * sizeof(LogGameEntry));
+    reader->gameCount = 0;
+
+    while (offset + sizeof(LogGameStart) <= reader->size &&
+           recordTag(reader->data + offset) == LOG_GAME_START) {
+        LogGameStart start;
+        memcpy(&start, reader->data + offset, sizeof(start));
+        offset += sizeof(start);
+        size_t firstKeyframe = offset;
+
+        // Hop over full blocks: a full block is followed by another keyframe of the same game
+        bool hasKeyframe = offset + sizeof(LogKeyframe) <= reader->size &&
+                           recordKind(reader->data + offset) == LOG_KEYFRAME;
+        if (hasKeyframe) {
+            uint32_t keyframeTag = recordTag(reader->data + offset);
+            while (offset + blockSize + sizeof(LogKeyframe) <= reader->size &&
+                   recordTag(reader->data + offset + blockSize) == keyframeTag) {
+                offset += blockSize;
+            }
+            offset += sizeof(LogKeyframe);
+        }
+        // Walk the last block up to the game end record
+        while (offset + sizeof(LogEvent) <= reader->size && !isControlRecord(reader->data + offset)) {
+            offset += sizeof(LogEvent);
+        }
+        if (offset + sizeof(LogGameEnd) > reader->size || recordTag(reader->data + offset) != LOG_GAME_END) {
+            break; // Truncated final game
+        }
+
+        LogGameEnd end;
+        memcpy(&end, reader->data + offset, sizeof(end));
+        offset += sizeof(end);
+
+        if (reader->gameCount == capacity) {
+            capacity *= 2;
+            reader->games = (LogGameEntry *)realloc(reader->games, capacity * sizeof(LogGameEntry));
+        }
+        LogGameEntry *entry = &reader->games[reader->gameCount++];
+        entry->offset = firstKeyframe;
+        entry->turns = end.turns;
+        entry->gameIndex = start.gameIndex;
+        entry->seed = start.seed;
+    }
+    return reader->gameCount;
+}
+
+// Function to rebuild the state of an indexed game after the given number of turns
+bool eventLogSeek(const EventLogReader *reader, long game, uint32_t turn, PackedGameState *state) {
+    if (game < 0 || game >= reader->gameCount) return false;
+    const LogGameEntry *entry = &reader->games[game];
+    if (turn > entry->turns) return false;
+
+    if (entry->turns == 0) {
+        packedResetState(state);
+        return true;
+    }
+
+    // The last turn of a game ending on a block boundary belongs to the previous block
+    uint32_t block = turn / reader->keyframeInterval;
+    if (turn == entry->turns && turn % reader->keyframeInterval == 0) block--;
+
+    const uint8_t *record = reader->data + entry->offset +
+                            block * (sizeof(LogKeyframe) + reader->keyframeInterval * sizeof(LogEvent));
+    LogKeyframe keyframe;
+    memcpy(&keyframe, record, sizeof(keyframe));
+    *state = keyframe.state;
+
+    const uint8_t *events = record + sizeof(LogKeyframe);
+    for (uint32_t t = keyframe.turn; t < turn; t++) {
+        LogEvent event;
+        memcpy(&event, events + (t - keyframe.turn) * sizeof(LogEvent), sizeof(event));
+        eventLogApply(state, event);
+    }
+    return true;
+}
+
+// Function to gather totals over every game in the log in one sequential pass
+void eventLogScan(const EventLogReader *reader, LogAnalytics *analytics) {
+    memset(analytics, 0, sizeof(*analytics));
+    madvise((void *)reader->data, reader->size, MADV_SEQUENTIAL);
+
+    size_t offset = sizeof(EventLogHeader);
+    while (offset + sizeof(LogEvent) <= reader->size) {
+        const uint8_t *record = reader->data + offset;
+
+        if (!isControlRecord(record)) {
+            LogEvent event;
+            memcpy(&event, record, sizeof(event));
+            analytics->turns++;
+            analytics->rollCounts[eventRoll(event)]++;
+            if (event & EVENT_MOVED) {
+                if (eventFrom(event) == PROGRESS_YARD) analytics->releases++;
+                if (eventTo(event) == PROGRESS_FINISHED) analytics->finishes++;
+            }
+            if (event & EVENT_CAPTURE) analytics->captures[eventPlayer(event)]++;
+            if (eventRank(event) == 1) analytics->winsBySeat[eventPlayer(event)]++;
+            offset += sizeof(LogEvent);
+            continue;
+        }
+
+        switch (recordKind(record)) {
+            case LOG_GAME_START:
+                offset += sizeof(LogGameStart);
+                break;
+            case LOG_KEYFRAME:
+                offset += sizeof(LogKeyframe);
+                break;
+            case LOG_GAME_END: {
+                LogGameEnd end;
+                if (offset + sizeof(end) > reader->size) return;
+                memcpy(&end, record, sizeof(end));
+                analytics->games++;
+                if (end.turns > analytics->longestGame) analytics->longestGame = end.turns;
+                offset += sizeof(LogGameEnd);
+                break;
+            }
+            default:
+                return; // Damaged log
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,468 @@
+#ifndef EXPECTI_SEARCH_H
+#define EXPECTI_SEARCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <atomic>
+#include "packed_state.h"
+
+/*
+ * Expectiminimax search for token selection.
+ * A turn is a chance node (the six dice values) followed by the mover's
+ * decision. The searching player maximizes and every opponent minimizes its
+ * score (paranoid search). Chance nodes are pruned with Star1 bounds,
+ * tightened by Star2 probes that search only the first move of each roll.
+ * The search deepens one turn at a time until the depth limit or the time
+ * budget, and caches chance node values in a transposition table that any
+ * number of searcher threads share without locks.
+ */
+
+#define SEARCH_LOWER -1.0f // Worst possible score
+#define SEARCH_UPPER 1.0f  // Best possible score
+#define SEARCH_MAX_DEPTH 32
+#define MAX_ROUTE_SCORE (TOKENS_PER_PLAYER * PROGRESS_FINISHED)
+
+// Transposition table bounds
+#define BOUND_EXACT 0
+#define BOUND_LOWER 1 // Value is at least the stored value
+#define BOUND_UPPER 2 // Value is at most the stored value
+
+/*
+ * Zobrist keys, generated at compile time. A position hashes to the XOR of
+ * one key per token progress plus keys for the turn, six counters and ranks.
+ * Searched values are from the searching player's point of view, so the
+ * transposition table key also XORs in a key for that player.
+ */
+typedef struct {
+    uint64_t token[TOTAL_TOKENS][PROGRESS_COUNT];
+    uint64_t turn[MAX_PLAYERS];
+    uint64_t sixes[MAX_PLAYERS][4];
+    uint64_t rank[MAX_PLAYERS][16];
+    uint64_t root[MAX_PLAYERS];
+} ZobristKeys;
+
+constexpr uint64_t zobristMix(uint64_t *seed) {
+    uint64_t z = (*seed += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys buildZobristKeys() {
+    ZobristKeys keys = {};
+    uint64_t seed = 0x5EED1D0ULL;
+    for (int t = 0; t < TOTAL_TOKENS; t++) {
+        for (int progress = 0; progress < PROGRESS_COUNT; progress++) keys.token[t][progress] = zobristMix(&seed);
+    }
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        keys.turn[p] = zobristMix(&seed);
+        for (int i = 0; i < 4; i++) keys.sixes[p][i] = zobristMix(&seed);
+        for (int i = 0; i < 16; i++) keys.rank[p][i] = zobristMix(&seed);
+    }
+    for (int p = 0; p < MAX_PLAYERS; p++) keys.root[p] = zobristMix(&seed);
+    return keys;
+}
+
+constexpr ZobristKeys zobristKeys = buildZobristKeys();
+
+// Function to hash a position (kill counts are not part of the position)
+inline uint64_t zobristHash(const PackedGameState *state) {
+    uint64_t hash = zobristKeys.turn[state->currentTurn];
+    for (int t = 0; t < TOTAL_TOKENS; t++) {
+        hash ^= zobristKeys.token[t][state->tokens[t]];
+    }
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        hash ^= zobristKeys.sixes[p][packedSixCount(state, p)] ^ zobristKeys.rank[p][packedRank(state, p)];
+    }
+    return hash;
+}
+
+/*
+ * Lock-free transposition table. Every entry is two 64-bit words written
+ * independently; the first holds key ^ data, so an entry torn by a
+ * concurrent writer no longer matches its key and is ignored. Buckets have
+ * a depth-preferred slot and an always-replace slot.
+ */
+typedef struct {
+    std::atomic<uint64_t> check; // key ^ data
+    std::atomic<uint64_t> data;  // value bits | depth << 32 | bound << 40
+} TTEntry;
+
+typedef struct {
+    TTEntry *entries;   // Two slots per bucket
+    uint64_t bucketMask;
+    size_t sizeBytes;
+} TranspositionTable;
+
+// Function to create a table using about sizeMB megabytes (rounded down to a power of two)
+TranspositionTable *ttCreate(int sizeMB) {
+    size_t buckets = 1;
+    while (buckets * 2 * 2 * sizeof(TTEntry) <= (size_t)(sizeMB > 0 ? sizeMB : 1) << 20) buckets *= 2;
+
+    TranspositionTable *tt = (TranspositionTable *)calloc(1, sizeof(TranspositionTable));
+    tt->entries = (TTEntry *)calloc(buckets * 2, sizeof(TTEntry));
+    tt->bucketMask = buckets - 1;
+    tt->sizeBytes = buckets * 2 * sizeof(TTEntry);
+    return tt;
+}
+
+void ttDestroy(TranspositionTable *tt) {
+    if (!tt) return;
+    free(tt->entries);
+    free(tt);
+}
+
+inline int ttDepth(uint64_t data) { return (int)((data >> 32) & 0xFF); }
+inline int ttBound(uint64_t data) { return (int)((data >> 40) & 3); }
+
+inline float ttValue(uint64_t data) {
+    uint32_t bits = (uint32_t)data;
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Function to look up a position; returns false if it is not stored
+bool ttProbe(TranspositionTable *tt, uint64_t key, uint64_t *data) {
+    TTEntry *bucket = &tt->entries[(key & tt->bucketMask) * 2];
+    for (int slot = 0; slot < 2; slot++) {
+        uint64_t stored = bucket[slot].data.load(std::memory_order_relaxed);
+        if ((bucket[slot].check.load(std::memory_order_relaxed) ^ stored) == key) {
+            *data = stored;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Function to store a searched position
+void ttStore(TranspositionTable *tt, uint64_t key, int depth, float value, int bound) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint64_t data = bits | ((uint64_t)depth << 32) | ((uint64_t)bound << 40);
+
+    // Deeper results keep the first slot; everything else goes to the second
+    TTEntry *bucket = &tt->entries[(key & tt->bucketMask) * 2];
+    uint64_t stored = bucket[0].data.load(std::memory_order_relaxed);
+    bool sameKey = (bucket[0].check.load(std::memory_order_relaxed) ^ stored) == key;
+    TTEntry *entry = (sameKey || depth >= ttDepth(stored)) ? &bucket[0] : &bucket[1];
+
+    entry->data.store(data, std::memory_order_relaxed);
+    entry->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+// Searcher state; one per thread, all may share one table
+typedef struct {
+    TranspositionTable *tt;  // Shared transposition table
+    int maxDepth;            // Deepest iteration in turns
+    long long timeBudgetNs;  // Time per decision (0 = depth limit only)
+    int rootPlayer;          // Player the search is for
+    long long deadlineNs;    // Search stops at this time (0 = no deadline)
+    bool timeUp;             // Current iteration was cut short
+
+    long nodes;              // Chance and decision nodes visited
+    long ttProbes;           // Table lookups
+    long ttHits;             // Lookups that found the position
+    long ttCutoffs;          // Hits that ended the search of the node
+    long decisions;          // Decisions made
+    long depthSum;           // Sum of completed iteration depths
+    long long searchNs;      // Time spent deciding
+    float lastValue;         // Value of the last move chosen
+} ExpectiSearcher;
+
+// Function to read the monotonic clock for the time budget
+static long long searchClockNs() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+// Function to set up a searcher; timeBudgetMicros 0 searches every iteration to maxDepth
+void searcherInit(ExpectiSearcher *searcher, TranspositionTable *tt, int maxDepth, long timeBudgetMicros) {
+    memset(searcher, 0, sizeof(*searcher));
+    searcher->tt = tt;
+    searcher->maxDepth = maxDepth < 1 ? 1 : (maxDepth > SEARCH_MAX_DEPTH ? SEARCH_MAX_DEPTH : maxDepth);
+    searcher->timeBudgetNs = timeBudgetMicros * 1000LL;
+}
+
+// Function to add another searcher's counters to this one
+void searcherMergeStats(ExpectiSearcher *total, const ExpectiSearcher *searcher) {
+    total->nodes += searcher->nodes;
+    total->ttProbes += searcher->ttProbes;
+    total->ttHits += searcher->ttHits;
+    total->ttCutoffs += searcher->ttCutoffs;
+    total->decisions += searcher->decisions;
+    total->depthSum += searcher->depthSum;
+    total->searchNs += searcher->searchNs;
+}
+
+// Function to score a position for the searching player: finishing place
+// once ranked, otherwise route progress against the strongest opponent
+float searchEvaluate(const ExpectiSearcher *searcher, const PackedGameState *state) {
+    int rank = packedRank(state, searcher->rootPlayer);
+    if (rank != 0) return SEARCH_UPPER - (rank - 1) * 0.5f;
+    if (packedGameOver(state)) return SEARCH_LOWER;
+
+    int scores[MAX_PLAYERS] = {0};
+    for (int t = 0; t < TOTAL_TOKENS; t++) {
+        scores[t / TOKENS_PER_PLAYER] += state->tokens[t];
+    }
+    int bestOpponent = 0;
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        if (p != searcher->rootPlayer && scores[p] > bestOpponent) bestOpponent = scores[p];
+    }
+    return (float)(scores[searcher->rootPlayer] - bestOpponent) / MAX_ROUTE_SCORE * 0.5f;
+}
+
+// Function to play the rest of a turn after the roll: the move (NULL = none),
+// the six counter, ranking and passing the turn, as packedPlaySeatedTurn does
+void searchCompleteTurn(const PackedGameState *state, const OccupancyIndex *occupancy, int roll,
+                        const PackedMove *move, PackedGameState *next, OccupancyIndex *nextOccupancy) {
+    *next = *state;
+    *nextOccupancy = *occupancy;
+    packedFinishTurn(next, nextOccupancy, roll, move);
+}
+
+// Function to order moves: captures, then home entries, then the furthest advanced token
+int orderMoves(const PackedMove *moves, int count, PackedMove ordered[TOKENS_PER_PLAYER]) {
+    int keys[TOKENS_PER_PLAYER];
+    for (int i = 0; i < count; i++) {
+        int key = moves[i].to;
+        if (moves[i].flags & MOVE_HOME_ENTRY) key += 100;
+        if (moves[i].flags & MOVE_CAPTURE) key += 200;
+
+        // Insertion sort, largest key first
+        int j = i;
+        while (j > 0 && keys[j - 1] < key) {
+            keys[j] = keys[j - 1];
+            ordered[j] = ordered[j - 1];
+            j--;
+        }
+        keys[j] = key;
+        ordered[j] = moves[i];
+    }
+    return count;
+}
+
+float searchChance(ExpectiSearcher *searcher, const PackedGameState *state, const OccupancyIndex *occupancy,
+                   int depth, float alpha, float beta);
+
+// Function to search the decision after a roll. probeOnly searches just the
+// first ordered move, which bounds the node from one side (Star2 probing).
+float searchDecision(ExpectiSearcher *searcher, const PackedGameState *state, const OccupancyIndex *occupancy,
+                     int roll, int depth, float alpha, float beta, bool probeOnly) {
+    searcher->nodes++;
+    PackedMove moves[TOKENS_PER_PLAYER];
+    PackedGameState next;
+    OccupancyIndex nextOccupancy;
+    int count = generateMoves(state, occupancy, roll, moves);
+
+    // Releases, home path moves and passes are forced
+    if (roll == 6 || count == 0 || (moves[0].flags & MOVE_HOME_ADVANCE)) {
+        searchCompleteTurn(state, occupancy, roll, count > 0 ? &moves[0] : NULL, &next, &nextOccupancy);
+        return searchChance(searcher, &next, &nextOccupancy, depth - 1, alpha, beta);
+    }
+
+    PackedMove ordered[TOKENS_PER_PLAYER];
+    orderMoves(moves, count, ordered);
+    if (probeOnly) count = 1;
+
+    bool maximizing = state->currentTurn == searcher->rootPlayer;
+    float best = maximizing ? SEARCH_LOWER : SEARCH_UPPER;
+    for (int i = 0; i < count; i++) {
+        searchCompleteTurn(state, occupancy, roll, &ordered[i], &next, &nextOccupancy);
+        float value = searchChance(searcher, &next, &nextOccupancy, depth - 1, alpha, beta);
+
+        if (maximizing) {
+            if (value > best) best = value;
+            if (best > alpha) alpha = best;
+        } else {
+            if (value < best) best = value;
+            if (best < beta) beta = best;
+        }
+        if (alpha >= beta || searcher->timeUp) break;
+    }
+    return best;
+}
+
+// Function to search the position before a roll (Star1 with Star2 probes)
+float searchChance(ExpectiSearcher *searcher, const PackedGameState *state, const OccupancyIndex *occupancy,
+                   int depth, float alpha, float beta) {
+    searcher->nodes++;
+    if (depth <= 0 || packedGameOver(state) || packedRank(state, searcher->rootPlayer) != 0) {
+        return searchEvaluate(searcher, state);
+    }
+    if (searcher->deadlineNs > 0 && (searcher->nodes & 1023) == 0 && searchClockNs() >= searcher->deadlineNs) {
+        searcher->timeUp = true;
+    }
+    if (searcher->timeUp) return searchEvaluate(searcher, state);
+
+    uint64_t key = zobristHash(state) ^ zobristKeys.root[searcher->rootPlayer];
+    uint64_t stored;
+    searcher->ttProbes++;
+    if (ttProbe(searcher->tt, key, &stored)) {
+        searcher->ttHits++;
+        float value = ttValue(stored);
+        if (ttDepth(stored) >= depth &&
+            (ttBound(stored) == BOUND_EXACT ||
+             (ttBound(stored) == BOUND_LOWER && value >= beta) ||
+             (ttBound(stored) == BOUND_UPPER && value <= alpha))) {
+            searcher->ttCutoffs++;
+            return value;
+        }
+    }
+
+    const int outcomes = 6;
+    float lower[7], upper[7];
+    float lowerSum = 0, upperSum = 0;
+    bool maximizing = state->currentTurn == searcher->rootPlayer;
+
+    // Star2: the first move of a roll bounds the mover's choice from below
+    // (searching player) or above (opponent)
+    for (int roll = 1; roll <= outcomes; roll++) {
+        lower[roll] = SEARCH_LOWER;
+        upper[roll] = SEARCH_UPPER;
+    }
+    for (int roll = 1; roll <= outcomes; roll++) {
+        float probe = searchDecision(searcher, state, occupancy, roll, depth, SEARCH_LOWER, SEARCH_UPPER, true);
+        if (maximizing) {
+            lower[roll] = probe;
+        } else {
+            upper[roll] = probe;
+        }
+
+        float lowerBound = 0, upperBound = 0;
+        for (int r = 1; r <= outcomes; r++) {
+            lowerBound += lower[r];
+            upperBound += upper[r];
+        }
+        if (lowerBound / outcomes >= beta) return lowerBound / outcomes;
+        if (upperBound / outcomes <= alpha) return upperBound / outcomes;
+    }
+    for (int roll = 1; roll <= outcomes; roll++) {
+        lowerSum += lower[roll];
+        upperSum += upper[roll];
+    }
+
+    // Star1: search every roll with the window that can still change the result
+    float valueSum = 0;
+    for (int roll = 1; roll <= outcomes; roll++) {
+        lowerSum -= lower[roll];
+        upperSum -= upper[roll];
+
+        float fail = outcomes * alpha - valueSum - upperSum; // Child value at or below this fails low
+        float pass = outcomes * beta - valueSum - lowerSum;  // Child value at or above this fails high
+        float childAlpha = fail > lower[roll] ? fail : lower[roll];
+        float childBeta = pass < upper[roll] ? pass : upper[roll];
+        float value;
+        if (childAlpha >= childBeta) {
+            value = childAlpha >= upper[roll] ? upper[roll] : lower[roll];
+        } else {
+            value = searchDecision(searcher, state, occupancy, roll, depth, childAlpha, childBeta, false);
+        }
+
+        if (value <= fail) {
+            float bound = (valueSum + value + upperSum) / outcomes;
+            if (!searcher->timeUp) ttStore(searcher->tt, key, depth, bound, BOUND_UPPER);
+            return bound;
+        }
+        if (value >= pass) {
+            float bound = (valueSum + value + lowerSum) / outcomes;
+            if (!searcher->timeUp) ttStore(searcher->tt, key, depth, bound, BOUND_LOWER);
+            return bound;
+        }
+        valueSum += value;
+    }
+
+    float value = valueSum / outcomes;
+    if (!searcher->timeUp) ttStore(searcher->tt, key, depth, value, BOUND_EXACT);
+    return value;
+}
+
+// MoveChooser that deepens the search one turn at a time and plays the
+// best move of the deepest completed iteration
+int expectiChooseMove(void *seatData, const PackedGameState *state, const OccupancyIndex *occupancy,
+                      const PackedMove *moves, int count, DiceRng * /* rng */) {
+    ExpectiSearcher *searcher = (ExpectiSearcher *)seatData;
+    if (count <= 1) return count - 1;
+
+    long long startNs = searchClockNs();
+    searcher->rootPlayer = state->currentTurn;
+    searcher->deadlineNs = searcher->timeBudgetNs > 0 ? startNs + searcher->timeBudgetNs : 0;
+    searcher->timeUp = false;
+
+    // Root moves in search order, remembering their index in moves
+    int order[TOKENS_PER_PLAYER];
+    PackedMove ordered[TOKENS_PER_PLAYER];
+    orderMoves(moves, count, ordered);
+    for (int i = 0; i < count; i++) {
+        for (int m = 0; m < count; m++) {
+            if (moves[m].token == ordered[i].token) order[i] = m;
+        }
+    }
+
+    PackedGameState children[TOKENS_PER_PLAYER];
+    OccupancyIndex childOccupancy[TOKENS_PER_PLAYER];
+    for (int i = 0; i < count; i++) {
+        searchCompleteTurn(state, occupancy, 1, &moves[order[i]], &children[i], &childOccupancy[i]);
+    }
+
+    int bestMove = order[0];
+    float bestValue = 0.0f;
+    int completedDepth = 0;
+    for (int depth = 1; depth <= searcher->maxDepth; depth++) {
+        float alpha = SEARCH_LOWER;
+        int iterationBest = 0;
+        for (int i = 0; i < count; i++) {
+            float value = searchChance(searcher, &children[i], &childOccupancy[i], depth - 1, alpha, SEARCH_UPPER);
+            if (i == 0 || value > alpha) {
+                alpha = value;
+                iterationBest = i;
+            }
+            if (searcher->timeUp) break;
+        }
+        if (searcher->timeUp) break;
+
+        // Search the best move first in the next iteration
+        bestMove = order[iterationBest];
+        bestValue = alpha;
+        completedDepth = depth;
+        for (int i = iterationBest; i > 0; i--) {
+            int swapOrder = order[i]; order[i] = order[i - 1]; order[i - 1] = swapOrder;
+            PackedGameState swapChild = children[i]; children[i] = children[i - 1]; children[i - 1] = swapChild;
+            OccupancyIndex swapOccupancy = childOccupancy[i];
+            childOccupancy[i] = childOccupancy[i - 1];
+            childOccupancy[i - 1] = swapOccupancy;
+        }
+    }
+
+    searcher->lastValue = bestValue;
+    searcher->decisions++;
+    searcher->depthSum += completedDepth;
+    searcher->searchNs += searchClockNs() - startNs;
+    return bestMove;
+}
+
+// Function to get the searched value of the last move chosen
+float expectiLastScore(const void *seatData) {
+    return ((const ExpectiSearcher *)seatData)->lastValue;
+}
+
+// Function to print search speed and table use
+void searcherPrintStats(const ExpectiSearcher *searcher, const TranspositionTable *tt) {
+    double seconds = searcher->searchNs / 1e9;
+    printf("Expectiminimax: %ld decisions, average completed depth %.2f turns\n", searcher->decisions,
+           searcher->decisions > 0 ? (double)searcher->depthSum / searcher->decisions : 0.0);
+    printf("Nodes: %ld (%.0f nodes/sec), time per decision: %.2f ms\n", searcher->nodes,
+           seconds > 0 ? searcher->nodes / seconds : 0.0,
+           searcher->decisions > 0 ? searcher->searchNs / 1e6 / searcher->decisions : 0.0);
+    printf("Transposition table: %.1f MB, %ld probes, %.1f%% hits, %.1f%% cutoffs\n", tt->sizeBytes / 1048576.0,
+           searcher->ttProbes, searcher->ttProbes > 0 ? 100.0 * searcher->ttHits / searcher->ttProbes : 0.0,
+           searcher->ttProbes > 0 ? 100.0 * searcher->ttCutoffs / searcher->ttProbes : 0.0);
+}
+
+#endif
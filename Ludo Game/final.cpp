@@ -2,14 +2,40 @@
 #include <stdlib.h>
 #include <pthread.h>
 #include <unistd.h>   // For sleep
-#include <time.h>     // For random dice rolls
+#include <time.h>     // For clock_gettime and default seeds
 #include <stdbool.h>
 #include <string.h>
-
-#define BOARD_DIMENSION 15
-#define MAX_PLAYERS 4
-#define TOKENS_PER_PLAYER 4
-#define HOME_PATH_LENGTH 5
+#include <stdarg.h>   // For gameLog
+#include <sys/resource.h> // For context switch counts
+#include <fcntl.h>    // For open
+#include <signal.h>   // For stopping the server
+#include "thread_pool.h"
+#include "board_layout.h"
+#include "packed_state.h"
+#include "dice_rng.h"
+#include "board_renderer.h"
+#include "event_log.h"
+#include "game_snapshot.h"
+#include "game_stats.h"
+#include "lockstep_batch.h"
+#include "endgame_tablebase.h"
+#include "rollout_ai.h"
+#include "expecti_search.h"
+#include "decision_cache.h"
+#include "spectator_ring.h"
+#include "instrumentation.h"
+#include "game_server.h"
+#include "load_client.h"
+#include "coro_scheduler.h"
+#include "terminal_input.h"
+
+#define TURN_DELAY_US 30000
+#define TOURNAMENT_BATCH_SIZE 64
+#define MAX_FRAMES_PER_SECOND 30
+#define HUMAN_TURN_TIMEOUT_MS 15000
+#define MAX_SPECTATORS 16
+#define SPECTATOR_POLL_BATCH 64   // Deltas a spectator applies between pauses
+#define SPECTATOR_IDLE_US 100     // Sleep of a spectator that has caught up
 
 typedef struct {
     int posX, posY;        // Current position on the board
@@ -25,330 +51,405 @@ typedef struct {
     int killCount;                  // Number of opponents' tokens killed
     int sixesRolledConsecutively;   // Counter for consecutive sixes rolled
     bool isActive;                  // Status of the player in the game
-    char *color;                    // Player's color representation
+    const char *color;              // Player's color representation
+    int finishedTokens;             // Tokens that have reached the end of the home path
 } PlayerInfo;
 
 typedef struct {
     int currentTurn;           // ID of the player whose turn it is
     pthread_mutex_t mutexLock; // Mutex for synchronizing access to game state
+    pthread_cond_t turnSignal[MAX_PLAYERS]; // Turn baton: wakes only the next player
+    pthread_cond_t rankChanged; // Wakes the monitor when a player is ranked
+    long long rankChangedNs;    // Time the latest rank was handed out
+    long rankWakeups;           // Monitor wake-ups that found a new rank
+    long long rankWakeTotalNs;  // Sum of rank-to-monitor latencies
+    long long rankWakeMaxNs;    // Worst rank-to-monitor latency
+    long monitorLockTakes;      // Times the monitor acquired mutexLock
+    long turnsPlayed;          // Turns completed since the game started
+    long turnLimit;            // Stop the player threads after this many turns (0 = no limit)
+    int turnDelayMicros;       // Pause after each turn so the board can be followed
+    long long handoffStartNs;  // Time the current turn was handed over
+    long handoffCount;         // Number of measured turn handoffs
+    long long handoffTotalNs;  // Sum of handoff latencies
+    long long handoffMaxNs;    // Worst handoff latency
 } GameStatus;
 
+// State of one game; every game in the process owns its own context
 typedef struct {
-    int x, y; // Coordinates on the board
-} BoardPosition;
-
-// Global Variables
-GameStatus gameStatus;
-PlayerInfo playersList[MAX_PLAYERS];
-BoardPosition boardPath[52];
-char gameBoard[BOARD_DIMENSION][BOARD_DIMENSION];
-
-// Home paths for each player
-BoardPosition blueHomePath[HOME_PATH_LENGTH] = {
-    {7, 1}, {7, 2}, {7, 3}, {7, 4}, {7, 5}
-};
+    GameStatus gameStatus;                             // Turn and synchronization state
+    PlayerInfo playersList[MAX_PLAYERS];               // Players and their tokens
+    int playerRanks[MAX_PLAYERS];                      // Finishing rank of each player (0 = unranked)
+    int rankCounter;                                   // Next rank to hand out
+    int activePlayerCount;                             // Players that have not finished yet
+    bool gameOver;                                     // Set by the monitor when the game ends
+    DiceRng rng;                                       // Dice and token choices for this game only
+    SeatTable seats;                                   // Move choosers of AI seats (empty = random seats)
+    OccupancyIndex occupancy;                          // Tokens on each track and home path cell
+} GameContext;
+
+// Outcome of one finished game
+typedef struct {
+    int playerRanks[MAX_PLAYERS]; // Finishing rank of each player (0 = last)
+    int killCounts[MAX_PLAYERS];  // Tokens eliminated by each player
+    long turns;                   // Turns played
+} GameResult;
 
-BoardPosition redHomePath[HOME_PATH_LENGTH] = {
-    {13, 7}, {12, 7}, {11, 7}, {10, 7}, {9, 7}
-};
+// A slice of tournament games run as one pool task
+typedef struct {
+    GameResult *results; // Results for the whole tournament
+    int firstGame;       // Index of the first game in this slice
+    int gameCount;       // Games in this slice
+    uint64_t baseSeed;   // Game g is seeded with baseSeed + g
+} TournamentBatch;
 
-BoardPosition greenHomePath[HOME_PATH_LENGTH] = {
-    {1, 7}, {2, 7}, {3, 7}, {4, 7}, {5, 7}
-};
+// A slice of search match games run as one pool task
+typedef struct {
+    TournamentBatch games;        // Games to play and where their results go
+    bool searchSeats[MAX_PLAYERS]; // Seats played by the search
+    ExpectiSearcher *searchers;   // One searcher per pool worker, all on one table
+    DecisionCache *decisionCache; // Decisions shared by every worker (NULL = none)
+} SearchMatchBatch;
 
-BoardPosition yellowHomePath[HOME_PATH_LENGTH] = {
-    {7, 13}, {7, 12}, {7, 11}, {7, 10}, {7, 9}
-};
+// Games of a statistics run, claimed a batch at a time by the pool workers
+typedef struct {
+    std::atomic<long> nextGame;    // First game of the next unclaimed batch
+    long gameCount;                // Games to play
+    uint64_t baseSeed;             // Game g is seeded with baseSeed + g
+    StatsAccumulator *workerStats; // One accumulator per pool worker
+} StatsRun;
 
-// Ranking system
-int playerRanks[MAX_PLAYERS] = {0};
-int rankCounter = 1;
-int activePlayerCount = MAX_PLAYERS;
-
-// Starting positions for each player
-const int initialPositions[MAX_PLAYERS][2] = {
-    {13, 6}, // Blue
-    {6, 1},  // Red
-    {1, 8},  // Green
-    {8, 13}  // Yellow
-};
+// Data for a player thread
+typedef struct {
+    GameContext *game;
+    PlayerInfo *player;
+} PlayerThreadArgs;
 
-// Function to initialize the players
-void setupPlayers() {
-    for (int i = 0; i < MAX_PLAYERS; i++) {
-        playersList[i].playerID = i + 1;
-        playersList[i].killCount = 0;
-        playersList[i].sixesRolledConsecutively = 0;
-        playersList[i].isActive = true;
-        playersList[i].color = NULL;
+// Data for a spectator thread
+typedef struct {
+    SpectatorCursor cursor;      // Spectator's view of the game
+    int delayMicros;             // Time the spectator takes to show each batch of turns
+    std::atomic<bool> *gameOver; // Set once the last turn is published
+} SpectatorThreadArgs;
 
-        // Initialize tokens in the yard
-        for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
-            playersList[i].tokens[j].isInYard = true;
-            playersList[i].tokens[j].isInHome = false;
-            playersList[i].tokens[j].hasReachedHome = false;
-        }
-    }
+// A person playing a seat from the keyboard (seat data of humanChooseMove)
+typedef struct {
+    GameContext *game;   // Game whose lock is released while the human thinks
+    int timeoutMs;       // Time to answer before an automatic move (0 = no limit)
+    long prompts;        // Moves the human was asked for
+    long automaticMoves; // Moves played because no answer came in time
+} HumanSeat;
 
-    // Assign colors to players
-    playersList[0].color = "Blue";
-    playersList[1].color = "Red";
-    playersList[2].color = "Green";
-    playersList[3].color = "Yellow";
+// Global Variables (read-only once initialized, shared by all games)
+BoardPosition boardPath[TRACK_LENGTH];
 
-    // Place tokens on the board for each player
-    // Blue Player
-    for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
-        playersList[0].tokens[j].posX = 11 + (j / 2);
-        playersList[0].tokens[j].posY = 2 + (j % 2);
-        playersList[0].tokens[j].startX = playersList[0].tokens[j].posX;
-        playersList[0].tokens[j].startY = playersList[0].tokens[j].posY;
-        gameBoard[playersList[0].tokens[j].posX][playersList[0].tokens[j].posY] = '@';
-    }
+// Headless mode: no rendering, logging or turn delays
+bool headlessMode = false;
 
-    // Red Player
-    for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
-        playersList[1].tokens[j].posX = 2 + (j / 2);
-        playersList[1].tokens[j].posY = 2 + (j % 2);
-        playersList[1].tokens[j].startX = playersList[1].tokens[j].posX;
-        playersList[1].tokens[j].startY = playersList[1].tokens[j].posY;
-        gameBoard[playersList[1].tokens[j].posX][playersList[1].tokens[j].posY] = '#';
-    }
+// Renderer for the board on standard output
+BoardRenderer terminalRenderer;
 
-    // Green Player
-    for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
-        playersList[2].tokens[j].posX = 2 + (j / 2);
-        playersList[2].tokens[j].posY = 11 + (j % 2);
-        playersList[2].tokens[j].startX = playersList[2].tokens[j].posX;
-        playersList[2].tokens[j].startY = playersList[2].tokens[j].posY;
-        gameBoard[playersList[2].tokens[j].posX][playersList[2].tokens[j].posY] = '$';
-    }
+// Keyboard of the human seats in the threaded game
+TerminalSession terminalSession;
 
-    // Yellow Player
-    for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
-        playersList[3].tokens[j].posX = 11 + (j / 2);
-        playersList[3].tokens[j].posY = 11 + (j % 2);
-        playersList[3].tokens[j].startX = playersList[3].tokens[j].posX;
-        playersList[3].tokens[j].startY = playersList[3].tokens[j].posY;
-        gameBoard[playersList[3].tokens[j].posX][playersList[3].tokens[j].posY] = '%';
-    }
-}
+// Binary log of the threaded game's turns (NULL = not logging)
+EventLogWriter *eventLog = NULL;
 
-// Function to initialize the game board
-void initializeBoard() {
-    // Clear the board
-    for (int i = 0; i < BOARD_DIMENSION; i++) {
-        for (int j = 0; j < BOARD_DIMENSION; j++) {
-            gameBoard[i][j] = ' ';
-        }
-    }
+// Snapshot pack the threaded game appends to after every turn (NULL = no checkpoints)
+SnapshotPackWriter *checkpointPack = NULL;
 
-    // Define home zones
-    for (int i = 0; i < 6; i++) {
-        for (int j = 0; j < 6; j++) {
-            gameBoard[i][j] = 'R'; // Red home zone
-            gameBoard[i][j + 9] = 'G'; // Green home zone
-            gameBoard[i + 9][j + 9] = 'Y'; // Yellow home zone
-            gameBoard[i + 9][j] = 'B'; // Blue home zone
-        }
-    }
+// Ring the threaded game broadcasts every turn to (NULL = no spectators)
+SpectatorRing *spectatorRing = NULL;
 
-    // Central area
-    for (int i = 6; i <= 8; i++) {
-        for (int j = 6; j <= 8; j++) {
-            gameBoard[i][j] = '*';
+// Function to initialize the players
+void setupPlayers(GameContext *game) {
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        game->playersList[i].playerID = i + 1;
+        game->playersList[i].killCount = 0;
+        game->playersList[i].sixesRolledConsecutively = 0;
+        game->playersList[i].isActive = true;
+        game->playersList[i].color = NULL;
+        game->playersList[i].finishedTokens = 0;
+
+        // Initialize tokens in the yard
+        for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
+            game->playersList[i].tokens[j].isInYard = true;
+            game->playersList[i].tokens[j].isInHome = false;
+            game->playersList[i].tokens[j].hasReachedHome = false;
         }
     }
 
-    // Horizontal paths
-    for (int j = 1; j < 14; j++) {
-        gameBoard[7][j] = '-';
-    }
+    // Assign colors to players
+    game->playersList[0].color = "Blue";
+    game->playersList[1].color = "Red";
+    game->playersList[2].color = "Green";
+    game->playersList[3].color = "Yellow";
 
-    // Vertical paths
-    for (int i = 1; i < 6; i++) {
-        gameBoard[i][7] = '|';
+    // Place tokens in their yard spots on the board
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
+            GameToken *token = &game->playersList[i].tokens[j];
+            token->posX = yardCorners[i].x + (j / 2);
+            token->posY = yardCorners[i].y + (j % 2);
+            token->startX = token->posX;
+            token->startY = token->posY;
+        }
     }
-    for (int i = 9; i < 14; i++) {
-        gameBoard[i][7] = '|';
+}
+
+// Function to build the board a frame shows: the fixed layout with every
+// unfinished token drawn from the players' token state. Where tokens share a
+// cell the lowest-numbered player is shown.
+void composeBoard(const GameContext *game, char board[BOARD_DIMENSION][BOARD_DIMENSION]) {
+    memcpy(board, boardTemplate.cells, sizeof(boardTemplate.cells));
+    for (int p = MAX_PLAYERS - 1; p >= 0; p--) {
+        for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
+            const GameToken *token = &game->playersList[p].tokens[j];
+            if (!token->hasReachedHome) board[token->posX][token->posY] = playerSymbols[p];
+        }
     }
+}
 
-    // Safe spaces
-    gameBoard[2][6] = 'S';
-    gameBoard[1][8] = 'S';
-    gameBoard[6][12] = 'S';
-    gameBoard[8][13] = 'S';
-    gameBoard[6][1] = 'S';
-    gameBoard[8][2] = 'S';
-    gameBoard[13][6] = 'S';
-    gameBoard[12][8] = 'S';
+// Function to draw a frame of the game, building the board only for frames that are shown
+bool renderGame(BoardRenderer *renderer, const GameContext *game, bool force) {
+    if (!rendererFrameDue(renderer, force)) return false;
+    char board[BOARD_DIMENSION][BOARD_DIMENSION];
+    composeBoard(game, board);
+    return renderFrame(renderer, board, true);
 }
 
 // Function to display the Ludo board with colors
-void displayBoard() {
-    printf("\n=== LUDO GAME BOARD ===\n");
-    printf("--------------------------------------------------------------\n");
-    for (int i = 0; i < BOARD_DIMENSION; i++) {
-        for (int j = 0; j < BOARD_DIMENSION; j++) {
-            if (j == 0) printf(" | ");
-            switch (gameBoard[i][j]) {
-                case 'R':
-                    printf("\033[1;31m%2c \033[0m| ", gameBoard[i][j]); // Red
-                    break;
-                case 'G':
-                    printf("\033[1;32m%2c \033[0m| ", gameBoard[i][j]); // Green
-                    break;
-                case 'Y':
-                    printf("\033[1;33m%2c \033[0m| ", gameBoard[i][j]); // Yellow
-                    break;
-                case 'B':
-                    printf("\033[1;34m%2c \033[0m| ", gameBoard[i][j]); // Blue
-                    break;
-                case 'S':
-                    printf("\033[1;37m%2c \033[0m| ", gameBoard[i][j]); // Safe
-                    break;
-                case '*':
-                    printf("\033[1;35m%2c \033[0m| ", gameBoard[i][j]); // Center
-                    break;
-                case '-' :
-                case '|' :
-                    printf("\033[1;36m%2c \033[0m| ", gameBoard[i][j]); // Paths
-                    break;
-                default:
-                    printf("%2c | ", gameBoard[i][j]); // Empty
-            }
-        }
-        printf("\n--------------------------------------------------------------\n");
-    }
+void displayBoard(GameContext *game) {
+    INSTRUMENT_SCOPE(PHASE_DISPLAY_BOARD);
+    // A human's move is drawn at once, whatever the frame-rate cap says
+    bool keyPending = terminalSession.keyPending;
+    renderGame(&terminalRenderer, game, keyPending);
+    if (keyPending) terminalKeyShown(&terminalSession);
+}
 
-    // Re-mark safe spaces if they are empty
-    BoardPosition safeSpots[] = {
-        {2, 6}, {1, 8}, {6, 12}, {8, 13},
-        {6, 1}, {8, 2}, {13, 6}, {12, 8}
-    };
-    int totalSafeSpots = sizeof(safeSpots) / sizeof(safeSpots[0]);
-    for (int i = 0; i < totalSafeSpots; i++) {
-        if (gameBoard[safeSpots[i].x][safeSpots[i].y] == ' ') {
-            gameBoard[safeSpots[i].x][safeSpots[i].y] = 'S';
-        }
-    }
+// Function to print game events (silenced in headless mode)
+void gameLog(const char *format, ...) {
+    if (headlessMode) return;
+
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
 }
 
 // Function to simulate a dice roll
-int diceRoll() {
-    return (rand() % 6) + 1;
+int diceRoll(GameContext *game) {
+    INSTRUMENT_SCOPE(PHASE_DICE_ROLL);
+    return diceRngRoll(&game->rng);
 }
 
 // Function to move a token out of the yard
-void releaseToken(PlayerInfo *player, int tokenIdx) {
+void releaseToken(GameContext *game, PlayerInfo *player, int tokenIdx) {
     if (player->tokens[tokenIdx].isInYard) {
         int startX = initialPositions[player->playerID - 1][0];
         int startY = initialPositions[player->playerID - 1][1];
 
-        // Clear the yard position
-        gameBoard[player->tokens[tokenIdx].posX][player->tokens[tokenIdx].posY] = '?';
-
         // Update token position
         player->tokens[tokenIdx].posX = startX;
         player->tokens[tokenIdx].posY = startY;
         player->tokens[tokenIdx].isInYard = false;
+        occupancyAdd(&game->occupancy, player->playerID - 1, tokenIdx, PROGRESS_TRACK);
 
-        // Determine symbol based on player color
-        char symbol;
-        switch (player->playerID) {
-            case 1: symbol = '@'; break; // Blue
-            case 2: symbol = '#'; break; // Red
-            case 3: symbol = '$'; break; // Green
-            case 4: symbol = '%'; break; // Yellow
-            default: symbol = '?'; break;
-        }
-
-        // Place token on the board
-        gameBoard[startX][startY] = symbol;
-
-        printf("Player %d released a token to position (%d, %d)\n", player->playerID, startX, startY);
+        gameLog("Player %d released a token to position (%d, %d)\n", player->playerID, startX, startY);
     }
 }
 
 // Forward declarations for movement functions
-void moveToken(PlayerInfo *player, int diceValue);
+void moveToken(GameContext *game, PlayerInfo *player, int diceValue);
 
 // Function to handle the dice roll outcome
-void processDiceRoll(PlayerInfo *player, int roll) {
+void processDiceRoll(GameContext *game, PlayerInfo *player, int roll) {
+    INSTRUMENT_SCOPE(PHASE_PROCESS_DICE_ROLL);
     if (roll == 6) {
-        printf("Player %d rolled a 6! Attempting to release a token...\n", player->playerID);
+        gameLog("Player %d rolled a 6! Attempting to release a token...\n", player->playerID);
         
         // Attempt to release a token from the yard
         for (int i = 0; i < TOKENS_PER_PLAYER; i++) {
             if (player->tokens[i].isInYard) {
-                releaseToken(player, i);
+                releaseToken(game, player, i);
                 return; // Only release one token per six
             }
         }
 
         // If no tokens are in the yard, grant another turn
-        printf("No tokens in the yard for Player %d. They get another turn!\n", player->playerID);
+        gameLog("No tokens in the yard for Player %d. They get another turn!\n", player->playerID);
         player->sixesRolledConsecutively++;
         if (player->sixesRolledConsecutively >= 3) {
-            printf("Player %d rolled three consecutive sixes! Their turn is forfeited.\n", player->playerID);
+            gameLog("Player %d rolled three consecutive sixes! Their turn is forfeited.\n", player->playerID);
             player->sixesRolledConsecutively = 0;
         }
     } else {
-        printf("Player %d rolled a %d.\n", player->playerID, roll);
+        gameLog("Player %d rolled a %d.\n", player->playerID, roll);
         player->sixesRolledConsecutively = 0; // Reset consecutive sixes
-        moveToken(player, roll);
+        moveToken(game, player, roll);
     }
 }
 
+// Function to read the monotonic clock in nanoseconds
+long long monotonicNanos() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+// Function to record how long the turn took to reach the next player
+void recordHandoff(GameContext *game) {
+    if (game->gameStatus.handoffStartNs == 0) return;
+
+    long long latency = monotonicNanos() - game->gameStatus.handoffStartNs;
+    game->gameStatus.handoffCount++;
+    game->gameStatus.handoffTotalNs += latency;
+    if (latency > game->gameStatus.handoffMaxNs) game->gameStatus.handoffMaxNs = latency;
+    game->gameStatus.handoffStartNs = 0;
+}
+
+// Function to make every player thread leave its loop (mutexLock must be held)
+void stopPlayers(GameContext *game) {
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        game->playersList[i].isActive = false;
+        pthread_cond_signal(&game->gameStatus.turnSignal[i]);
+    }
+}
+
+// Function to hand the turn to the next player (mutexLock must be held)
+void passTurn(GameContext *game) {
+    game->gameStatus.currentTurn = (game->gameStatus.currentTurn % MAX_PLAYERS) + 1;
+    game->gameStatus.handoffStartNs = monotonicNanos();
+    game->gameStatus.turnsPlayed++;
+
+    // Stop every player once the turn limit is reached
+    if (game->gameStatus.turnLimit > 0 && game->gameStatus.turnsPlayed >= game->gameStatus.turnLimit) {
+        stopPlayers(game);
+        return;
+    }
+
+    pthread_cond_signal(&game->gameStatus.turnSignal[game->gameStatus.currentTurn - 1]);
+}
+
+void packGameState(const GameContext *game, PackedGameState *state);
+
+// Function to append the turn just played to the event log
+void logTurn(GameContext *game, int roll) {
+    PackedGameState after;
+    packGameState(game, &after);
+    eventLogRecordTurn(eventLog, roll, &after);
+}
+
+// Function to broadcast the turn just played to the spectators
+void broadcastTurn(GameContext *game, int roll) {
+    long long startNs = spectatorClockNs();
+    PackedGameState after;
+    packGameState(game, &after);
+    spectatorPublishTurn(spectatorRing, roll, &after, startNs);
+}
+
+void saveGameSnapshot(const GameContext *game, GameSnapshot *snapshot);
+
+// Function to append the position after a turn to the checkpoint pack,
+// flushed so an interrupted game can be resumed from it
+void checkpointTurn(GameContext *game) {
+    GameSnapshot snapshot;
+    saveGameSnapshot(game, &snapshot);
+    snapshotPackAppend(checkpointPack, &snapshot);
+    fflush(checkpointPack->file);
+}
+
+// Function to play a single turn for the player (mutexLock must be held)
+void playTurn(GameContext *game, PlayerInfo *player) {
+    int roll = diceRoll(game);
+    gameLog("Player %d's turn. Rolled: %d\n", player->playerID, roll);
+    processDiceRoll(game, player, roll);
+    if (eventLog) logTurn(game, roll);
+    if (spectatorRing) broadcastTurn(game, roll);
+    if (!headlessMode) displayBoard(game);
+}
+
 // Thread function for each player
 void *playerRoutine(void *arg) {
-    PlayerInfo *player = (PlayerInfo *)arg;
+    PlayerThreadArgs *args = (PlayerThreadArgs *)arg;
+    GameContext *game = args->game;
+    PlayerInfo *player = args->player;
 
+    instrumentedLock(&game->gameStatus.mutexLock);
     while (player->isActive) {
-        pthread_mutex_lock(&gameStatus.mutexLock);
+        // Sleep until the previous player passes the baton
+        if (game->gameStatus.currentTurn != player->playerID) {
+            instrumentedWait(&game->gameStatus.turnSignal[player->playerID - 1], &game->gameStatus.mutexLock);
+            if (player->isActive && game->gameStatus.currentTurn != player->playerID) {
+                INSTRUMENT_COUNT(COUNTER_WASTED_WAKEUPS);
+            }
+            continue;
+        }
 
-        if (gameStatus.currentTurn == player->playerID) {
-            int roll = diceRoll();
-            printf("Player %d's turn. Rolled: %d\n", player->playerID, roll);
-            processDiceRoll(player, roll);
-            displayBoard();
+        recordHandoff(game);
+        playTurn(game, player);
+
+        // Simulate turn duration without blocking the monitor
+        if (game->gameStatus.turnDelayMicros > 0) {
+            instrumentedUnlock(&game->gameStatus.mutexLock);
+            usleep(game->gameStatus.turnDelayMicros);
+            instrumentedLock(&game->gameStatus.mutexLock);
+        }
 
-            // Pass turn to the next player
-            gameStatus.currentTurn = (gameStatus.currentTurn % MAX_PLAYERS) + 1;
+        passTurn(game);
+        if (checkpointPack) checkpointTurn(game);
+    }
+    instrumentedUnlock(&game->gameStatus.mutexLock);
+
+    return NULL;
+}
+
+// Thread function for each player using the original lock/poll/sleep handoff,
+// kept as a baseline for the handoff benchmark
+void *pollingPlayerRoutine(void *arg) {
+    PlayerThreadArgs *args = (PlayerThreadArgs *)arg;
+    GameContext *game = args->game;
+    PlayerInfo *player = args->player;
+
+    while (player->isActive) {
+        instrumentedLock(&game->gameStatus.mutexLock);
+
+        if (player->isActive && game->gameStatus.currentTurn == player->playerID) {
+            recordHandoff(game);
+            playTurn(game, player);
+            passTurn(game);
+        } else if (player->isActive) {
+            INSTRUMENT_COUNT(COUNTER_WASTED_WAKEUPS);
         }
 
-        pthread_mutex_unlock(&gameStatus.mutexLock);
-        usleep(30000); // Simulate turn duration
+        instrumentedUnlock(&game->gameStatus.mutexLock);
+        usleep(TURN_DELAY_US); // Poll interval
     }
 
     return NULL;
 }
 
+// Function to print turn handoff statistics
+void printHandoffStats(GameContext *game) {
+    double averageUs = game->gameStatus.handoffCount > 0 ?
+        game->gameStatus.handoffTotalNs / 1000.0 / game->gameStatus.handoffCount : 0.0;
+    printf("Turn handoffs: %ld, average latency: %.1f us, max latency: %.1f us\n",
+           game->gameStatus.handoffCount, averageUs, game->gameStatus.handoffMaxNs / 1000.0);
+}
+
 // Function to initialize the board path
 void initializeBoardPath() {
-    // Define the sequential path around the board
-    BoardPosition tempPath[52] = {
-        {0, 6}, {0, 7}, {0, 8}, {1, 8}, {2, 8}, {3, 8}, {4, 8}, {5, 8},
-        {6, 9}, {6, 10}, {6, 11}, {6, 12}, {6, 13}, {6, 14}, {7, 14},
-        {8, 14}, {8, 13}, {8, 12}, {8, 11}, {8, 10}, {8, 9}, {9, 8},
-        {10, 8}, {11, 8}, {12, 8}, {13, 8}, {14, 8}, {14, 7}, {14, 6},
-        {13, 6}, {12, 6}, {11, 6}, {10, 6}, {9, 6}, {8, 5}, {8, 4},
-        {8, 3}, {8, 2}, {8, 1}, {8, 0}, {7, 0}, {6, 0}, {6, 1},
-        {6, 2}, {6, 3}, {6, 4}, {6, 5}, {5, 6}, {4, 6}, {3, 6},
-        {2, 6}, {1, 6}
-    };
-    memcpy(boardPath, tempPath, sizeof(tempPath));
+    memcpy(boardPath, trackLayout, sizeof(trackLayout));
 }
 
 // Function to validate if a token is on the board path
 bool isOnPath(PlayerInfo *player, int tokenIdx) {
-    for(int i = 0; i < 52; i++) {
-        if(player->tokens[tokenIdx].posX == boardPath[i].x && 
-           player->tokens[tokenIdx].posY == boardPath[i].y) {
-            return true;
-        }
-    }
-    return false;
+    return routeTables.trackIndexAt[player->tokens[tokenIdx].posX][player->tokens[tokenIdx].posY] >= 0;
+}
+
+// Function to look up a token's progress along its route (-1 if it is in the yard)
+int tokenProgress(PlayerInfo *player, int tokenIdx) {
+    if (player->tokens[tokenIdx].isInYard) return -1;
+    return routeTables.progressAt[player->playerID - 1][player->tokens[tokenIdx].posX][player->tokens[tokenIdx].posY];
 }
 
 // Helper functions to get token positions
@@ -360,95 +461,63 @@ int getTokenY(PlayerInfo *player, int idx) {
     return player->tokens[idx].posY;
 }
 
-// Function to update the game board when a token moves
-void refreshBoard(char *playerColor, int oldX, int oldY, int newX, int newY) {
-    gameBoard[oldX][oldY] = ' ';
-    if (strcmp(playerColor, "Blue") == 0) {
-        gameBoard[newX][newY] = '@';
-    } else if (strcmp(playerColor, "Red") == 0) {
-        gameBoard[newX][newY] = '#';
-    } else if (strcmp(playerColor, "Green") == 0) {
-        gameBoard[newX][newY] = '$';
-    } else if (strcmp(playerColor, "Yellow") == 0) {
-        gameBoard[newX][newY] = '%';
-    }
-}
-
 // Function to validate a token's new position
 bool validateTokenPosition(PlayerInfo *player, int tokenIdx, int x, int y) {
-    for(int i = 0; i < 52; i++) {
-        if(player->tokens[tokenIdx].posX == boardPath[i].x && 
-           player->tokens[tokenIdx].posY == boardPath[i].y) {
-            return true;
-        }
-    }
-    return false;
+    return isOnPath(player, tokenIdx);
 }
 
 // Function prototypes for home path management
-bool enterHomePath(PlayerInfo *player, int tokenIdx, int diceValue);
+bool enterHomePath(GameContext *game, PlayerInfo *player, int tokenIdx, int diceValue);
 bool isInHomePath(PlayerInfo *player, int tokenIdx);
-bool canAdvanceInHomePath(PlayerInfo *player, int tokenIdx, int diceValue);
+bool canAdvanceInHomePath(GameContext *game, PlayerInfo *player, int tokenIdx, int diceValue);
+
+// Function to count a token that reached home, ranking its player the moment
+// the last one arrives and waking the monitor
+void recordFinishedToken(GameContext *game, PlayerInfo *player) {
+    player->finishedTokens++;
+    int p = player->playerID - 1;
+    if (player->finishedTokens < TOKENS_PER_PLAYER || game->playerRanks[p] != 0) return;
+
+    game->playerRanks[p] = game->rankCounter++;
+    game->activePlayerCount--;
+    gameLog("Player %d finished in place %d!\n", player->playerID, game->playerRanks[p]);
+
+    // Headless games have no monitor to wake
+    if (!headlessMode) {
+        game->gameStatus.rankChangedNs = monotonicNanos();
+        pthread_cond_signal(&game->gameStatus.rankChanged);
+    }
+}
 
 // Check if a token is in the home path
 bool isInHomePath(PlayerInfo *player, int tokenIdx) {
-    BoardPosition *homePath;
-    switch(player->playerID) {
-        case 1: homePath = blueHomePath; break;
-        case 2: homePath = redHomePath; break;
-        case 3: homePath = greenHomePath; break;
-        case 4: homePath = yellowHomePath; break;
-        default: return false;
-    }
-
-    for (int i = 0; i < HOME_PATH_LENGTH; i++) {
-        if (player->tokens[tokenIdx].posX == homePath[i].x && 
-            player->tokens[tokenIdx].posY == homePath[i].y) {
-            return true;
-        }
-    }
-    return false;
+    return progressInHomePath(routeTables.progressAt[player->playerID - 1]
+                                                    [player->tokens[tokenIdx].posX][player->tokens[tokenIdx].posY]);
 }
 
 // Check if a token can move within the home path
-bool canAdvanceInHomePath(PlayerInfo *player, int tokenIdx, int diceValue) {
-    BoardPosition *homePath;
-    switch(player->playerID) {
-        case 1: homePath = blueHomePath; break;
-        case 2: homePath = redHomePath; break;
-        case 3: homePath = greenHomePath; break;
-        case 4: homePath = yellowHomePath; break;
-        default: return false;
-    }
+bool canAdvanceInHomePath(GameContext *game, PlayerInfo *player, int tokenIdx, int diceValue) {
+    const BoardPosition *homePath = homePathLayout[player->playerID - 1];
+    int progress = tokenProgress(player, tokenIdx);
 
-    int currentIndex = -1;
-    for (int i = 0; i < HOME_PATH_LENGTH; i++) {
-        if (player->tokens[tokenIdx].posX == homePath[i].x && 
-            player->tokens[tokenIdx].posY == homePath[i].y) {
-            currentIndex = i;
-            break;
-        }
-    }
-
-    if (currentIndex == -1 || currentIndex + diceValue >= HOME_PATH_LENGTH) {
+    if (!progressInHomePath(progress) || routeTables.target[player->playerID - 1][progress][diceValue] == NO_MOVE) {
         return false;
     }
 
+    int currentIndex = progress - PROGRESS_HOME;
     int newIndex = currentIndex + diceValue;
     player->tokens[tokenIdx].posX = homePath[newIndex].x;
     player->tokens[tokenIdx].posY = homePath[newIndex].y;
+    occupancyMove(&game->occupancy, player->playerID - 1, tokenIdx, progress, progress + diceValue);
 
-    refreshBoard(player->color, homePath[currentIndex].x, homePath[currentIndex].y, 
-                homePath[newIndex].x, homePath[newIndex].y);
-
-    printf("Player %d's token moved within home path to (%d, %d)\n", 
-           player->playerID, homePath[newIndex].x, homePath[newIndex].y);
+    gameLog("Player %d's token moved within home path to (%d, %d)\n", 
+            player->playerID, homePath[newIndex].x, homePath[newIndex].y);
 
     if (newIndex == HOME_PATH_LENGTH - 1) {
         player->tokens[tokenIdx].isInHome = true;
         player->tokens[tokenIdx].hasReachedHome = true;
-        gameBoard[player->tokens[tokenIdx].posX][player->tokens[tokenIdx].posY] = ' ';
-        printf("Player %d's token has reached home!\n", player->playerID);
+        gameLog("Player %d's token has reached home!\n", player->playerID);
+        recordFinishedToken(game, player);
     }
 
     return true;
@@ -456,40 +525,15 @@ bool canAdvanceInHomePath(PlayerInfo *player, int tokenIdx, int diceValue) {
 
 // Check if a token can enter the home path
 bool canEnterHomePath(PlayerInfo *player, int tokenIdx) {
-    int currentX = player->tokens[tokenIdx].posX;
-    int currentY = player->tokens[tokenIdx].posY;
-
-    // Define home entry points for each player
-    BoardPosition homeEntries[MAX_PLAYERS] = {
-        {8, 7},   // Blue
-        {6, 7},   // Red
-        {7, 6},   // Green
-        {7, 8}    // Yellow
-    };
-
-    BoardPosition entryPoint = homeEntries[player->playerID - 1];
-
-    bool isNearEntry = (
-        abs(currentX - entryPoint.x) <= 1 && 
-        abs(currentY - entryPoint.y) <= 1
-    );
-
-    return isNearEntry;
+    int progress = tokenProgress(player, tokenIdx);
+    return progress >= 0 && routeTables.canEnterHome[player->playerID - 1][progress];
 }
 
 // Function to move a token into the home path
-bool enterHomePath(PlayerInfo *player, int tokenIdx, int diceValue) {
-    BoardPosition *homePath;
-    switch(player->playerID) {
-        case 1: homePath = blueHomePath; break;
-        case 2: homePath = redHomePath; break;
-        case 3: homePath = greenHomePath; break;
-        case 4: homePath = yellowHomePath; break;
-        default: return false;
-    }
+bool enterHomePath(GameContext *game, PlayerInfo *player, int tokenIdx, int diceValue) {
+    const BoardPosition *homePath = homePathLayout[player->playerID - 1];
 
-    int oldX = player->tokens[tokenIdx].posX;
-    int oldY = player->tokens[tokenIdx].posY;
+    occupancyMove(&game->occupancy, player->playerID - 1, tokenIdx, tokenProgress(player, tokenIdx), PROGRESS_HOME);
 
     BoardPosition newPos = homePath[0];
     player->tokens[tokenIdx].posX = newPos.x;
@@ -497,59 +541,43 @@ bool enterHomePath(PlayerInfo *player, int tokenIdx, int diceValue) {
     player->tokens[tokenIdx].isInHome = true;
     player->tokens[tokenIdx].isInYard = false;
 
-    refreshBoard(player->color, oldX, oldY, newPos.x, newPos.y);
-
-    printf("Player %d's token entered home path at (%d, %d)\n", 
-           player->playerID, newPos.x, newPos.y);
+    gameLog("Player %d's token entered home path at (%d, %d)\n", 
+            player->playerID, newPos.x, newPos.y);
 
     return true;
 }
 
-// Function to eliminate an opponent's token
-bool eliminateOpponent(PlayerInfo *currentPlayer, int newX, int newY) {
-    for (int i = 0; i < MAX_PLAYERS; i++) {
-        if (i == currentPlayer->playerID - 1) continue; // Skip self
-
-        for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
-            if (!playersList[i].tokens[j].isInYard && 
-                playersList[i].tokens[j].posX == newX && 
-                playersList[i].tokens[j].posY == newY) {
-                
-                // Determine the symbol based on opponent's color
-                char opponentSymbol;
-                switch (i) {
-                    case 0: opponentSymbol = '@'; break; // Blue
-                    case 1: opponentSymbol = '#'; break; // Red
-                    case 2: opponentSymbol = '$'; break; // Green
-                    case 3: opponentSymbol = '%'; break; // Yellow
-                    default: opponentSymbol = '?'; break;
-                }
+// Function to eliminate an opponent's token: a lone opponent token on a cell
+// that is not a safe spot, looked up in the occupancy index
+bool eliminateOpponent(GameContext *game, PlayerInfo *currentPlayer, int newX, int newY) {
+    INSTRUMENT_SCOPE(PHASE_ELIMINATE_OPPONENT);
+    int trackIndex = routeTables.trackIndexAt[newX][newY];
+    if (trackIndex < 0) return false;
 
-                // Remove opponent's token from the board
-                gameBoard[newX][newY] = ' ';
+    int victim = occupancyCaptureVictim(&game->occupancy, currentPlayer->playerID - 1, trackIndex);
+    if (victim < 0) return false; // Empty, safe spot or blockades only
 
-                // Reset opponent's token to the yard
-                playersList[i].tokens[j].isInYard = true;
-                playersList[i].tokens[j].posX = playersList[i].tokens[j].startX;
-                playersList[i].tokens[j].posY = playersList[i].tokens[j].startY;
+    int i = victim / TOKENS_PER_PLAYER;
+    int j = victim % TOKENS_PER_PLAYER;
+    GameToken *token = &game->playersList[i].tokens[j];
+    occupancyRemove(&game->occupancy, i, j, routeTables.progressAt[i][newX][newY]);
 
-                // Place the token back in the yard on the board
-                gameBoard[playersList[i].tokens[j].posX][playersList[i].tokens[j].posY] = opponentSymbol;
+    // Reset opponent's token to the yard
+    token->isInYard = true;
+    token->posX = token->startX;
+    token->posY = token->startY;
 
-                // Increment current player's kill count
-                currentPlayer->killCount++;
+    // Increment current player's kill count
+    currentPlayer->killCount++;
 
-                printf("Player %d has eliminated a token of Player %d!\n", 
-                       currentPlayer->playerID, playersList[i].playerID);
-                return true;
-            }
-        }
-    }
-    return false;
+    gameLog("Player %d has eliminated a token of Player %d!\n",
+            currentPlayer->playerID, game->playersList[i].playerID);
+    return true;
 }
 
 // Function to move a token based on dice value
-void moveToken(PlayerInfo *player, int diceValue) {
+void moveToken(GameContext *game, PlayerInfo *player, int diceValue) {
+    INSTRUMENT_SCOPE(PHASE_MOVE_TOKEN);
     int movableTokens[TOKENS_PER_PLAYER];
     int movableCount = 0;
 
@@ -563,148 +591,1900 @@ void moveToken(PlayerInfo *player, int diceValue) {
     // Prioritize moving tokens in the home path
     for (int i = 0; i < TOKENS_PER_PLAYER; i++) {
         if (isInHomePath(player, i)) {
-            if (canAdvanceInHomePath(player, i, diceValue)) {
+            if (canAdvanceInHomePath(game, player, i, diceValue)) {
                 return;
             }
         }
     }
 
     if (movableCount == 0) {
-        printf("Player %d has no tokens available to move.\n", player->playerID);
+        gameLog("Player %d has no tokens available to move.\n", player->playerID);
         return;
     }
 
-    // Select a random token to move
     int selectedToken = -1;
-    for (int attempts = 0; attempts < TOKENS_PER_PLAYER; attempts++) {
-        selectedToken = rand() % TOKENS_PER_PLAYER;
-        if (!player->tokens[selectedToken].isInYard && !player->tokens[selectedToken].isInHome) {
-            break;
+    int seat = player->playerID - 1;
+    if (game->seats.choose[seat]) {
+        // Let the seat's strategy pick among the legal moves
+        PackedGameState state;
+        PackedMove moves[TOKENS_PER_PLAYER];
+        packGameState(game, &state);
+        state.currentTurn = seat;
+        int count = generateMoves(&state, &game->occupancy, diceValue, moves);
+        int choice = game->seats.choose[seat](game->seats.seatData[seat], &state, &game->occupancy,
+                                              moves, count, &game->rng);
+        if (choice >= 0) selectedToken = moves[choice].token;
+    } else {
+        // Select a random token to move
+        for (int attempts = 0; attempts < TOKENS_PER_PLAYER; attempts++) {
+            selectedToken = diceRngBelow(&game->rng, TOKENS_PER_PLAYER);
+            if (!player->tokens[selectedToken].isInYard && !player->tokens[selectedToken].isInHome) {
+                break;
+            }
         }
     }
 
     if (selectedToken == -1 || player->tokens[selectedToken].isInYard || player->tokens[selectedToken].isInHome) {
-        printf("No valid tokens found for Player %d to move.\n", player->playerID);
+        gameLog("No valid tokens found for Player %d to move.\n", player->playerID);
         return;
     }
 
-    int currentX = player->tokens[selectedToken].posX;
-    int currentY = player->tokens[selectedToken].posY;
-
     // Find current position in the path
-    int pathIndex = -1;
-    for (int i = 0; i < 52; i++) {
-        if (boardPath[i].x == currentX && boardPath[i].y == currentY) {
-            pathIndex = i;
-            break;
-        }
-    }
-
-    if (pathIndex == -1) {
-        printf("Error: Player %d's token not found on the path.\n", player->playerID);
+    int progress = tokenProgress(player, selectedToken);
+    if (!progressOnTrack(progress)) {
+        gameLog("Error: Player %d's token not found on the path.\n", player->playerID);
         return;
     }
 
-    // Calculate new position
-    int newPathIndex = (pathIndex + diceValue) % 52;
-    int newX = boardPath[newPathIndex].x;
-    int newY = boardPath[newPathIndex].y;
-
     // Check if token can enter the home path
     if (canEnterHomePath(player, selectedToken)) {
-        if (enterHomePath(player, selectedToken, diceValue)) {
+        if (enterHomePath(game, player, selectedToken, diceValue)) {
             return;
         }
     }
 
+    // Look up the new position along the player's route
+    int newProgress = routeTables.target[player->playerID - 1][progress][diceValue];
+    int newX = routeTables.cell[player->playerID - 1][newProgress].x;
+    int newY = routeTables.cell[player->playerID - 1][newProgress].y;
+
     // Check and eliminate any opponent's token at the new position
-    eliminateOpponent(player, newX, newY);
+    eliminateOpponent(game, player, newX, newY);
+    occupancyMove(&game->occupancy, player->playerID - 1, selectedToken, progress, newProgress);
 
-    // Update the board and token's position
-    refreshBoard(player->color, currentX, currentY, newX, newY);
+    // Update the token's position
     player->tokens[selectedToken].posX = newX;
     player->tokens[selectedToken].posY = newY;
 
-    printf("Player %d moved a token to (%d, %d)\n", player->playerID, newX, newY);
-    printf("Player %d's kill count: %d\n", player->playerID, player->killCount);
+    gameLog("Player %d moved a token to (%d, %d)\n", player->playerID, newX, newY);
+    gameLog("Player %d's kill count: %d\n", player->playerID, player->killCount);
+}
+
+// Function to print how quickly the monitor saw rank changes
+void printRankingStats(GameContext *game) {
+    GameStatus *status = &game->gameStatus;
+    printf("Rank changes seen by the monitor: %ld, average latency: %.1f us, max latency: %.1f us\n",
+           status->rankWakeups, status->rankWakeups > 0 ? status->rankWakeTotalNs / 1000.0 / status->rankWakeups : 0.0,
+           status->rankWakeMaxNs / 1000.0);
+    printf("Monitor lock acquisitions: %ld\n", status->monitorLockTakes);
 }
 
 // Master thread to monitor game status and rankings
 void *gameMonitor(void *arg) {
-    while (1) {
-        pthread_mutex_lock(&gameStatus.mutexLock);
-
-        int activePlayers = 0;
-        for (int i = 0; i < MAX_PLAYERS; i++) {
-            if (playersList[i].isActive) {
-                activePlayers++;
-
-                // Check if all tokens have reached home
-                bool allTokensHome = true;
-                for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
-                    if (!playersList[i].tokens[j].hasReachedHome) {
-                        allTokensHome = false;
-                        break;
-                    }
-                }
+    GameContext *game = (GameContext *)arg;
+
+    instrumentedLock(&game->gameStatus.mutexLock);
+    game->gameStatus.monitorLockTakes++;
+
+    // Sleep until a rank changes; the player finishing a token does the ranking
+    int announcedRanks = game->rankCounter;
+    while (game->activePlayerCount > 1) {
+        instrumentedWait(&game->gameStatus.rankChanged, &game->gameStatus.mutexLock);
+        game->gameStatus.monitorLockTakes++;
+        if (game->rankCounter == announcedRanks) continue; // Spurious wake-up
+
+        long long latencyNs = monotonicNanos() - game->gameStatus.rankChangedNs;
+        game->gameStatus.rankWakeups++;
+        game->gameStatus.rankWakeTotalNs += latencyNs;
+        if (latencyNs > game->gameStatus.rankWakeMaxNs) game->gameStatus.rankWakeMaxNs = latencyNs;
+        announcedRanks = game->rankCounter;
+    }
 
-                // Assign ranking if all tokens are home
-                if (allTokensHome && playerRanks[i] == 0) {
-                    playerRanks[i] = rankCounter++;
-                    activePlayerCount--;
-                }
+    // Only one player remains: end the game
+    if (!headlessMode) renderGame(&terminalRenderer, game, true);
+    printf("=== GAME OVER ===\n");
+    printf("Final Rankings:\n");
+    for (int r = 1; r <= MAX_PLAYERS; r++) {
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            if (game->playerRanks[p] == r) {
+                printf("%d. Player %d\n", r, game->playersList[p].playerID);
             }
         }
+    }
 
-        // End the game if only one player remains
-        if (activePlayerCount <= 1) {
-            printf("=== GAME OVER ===\n");
-            printf("Final Rankings:\n");
-            for (int r = 1; r <= MAX_PLAYERS; r++) {
-                for (int p = 0; p < MAX_PLAYERS; p++) {
-                    if (playerRanks[p] == r) {
-                        printf("%d. Player %d\n", r, playersList[p].playerID);
-                    }
-                }
+    // Display kill counts
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        printf("Player %d's total kills: %d\n", game->playersList[i].playerID, game->playersList[i].killCount);
+    }
+    printHandoffStats(game);
+    printRankingStats(game);
+    if (!headlessMode) rendererPrintStats(&terminalRenderer);
+    instrumentPrintReport();
+    if (eventLog) {
+        eventLogEndGame(eventLog);
+        printf("Event log: %ld turns in %ld bytes\n", eventLog->eventsWritten, eventLog->bytesWritten);
+    }
+
+    // Let the player threads finish instead of exiting the process
+    game->gameOver = true;
+    stopPlayers(game);
+    instrumentedUnlock(&game->gameStatus.mutexLock);
+    return NULL;
+}
+
+// Function to reset all game state before a new game
+void resetGame(GameContext *game) {
+    setupPlayers(game);
+
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        game->playerRanks[i] = 0;
+    }
+    game->rankCounter = 1;
+    game->activePlayerCount = MAX_PLAYERS;
+    game->gameOver = false;
+    game->gameStatus.currentTurn = 1;
+    game->gameStatus.turnLimit = 0;
+    game->gameStatus.turnsPlayed = 0;
+    game->gameStatus.handoffStartNs = 0;
+    game->gameStatus.handoffCount = 0;
+    game->gameStatus.handoffTotalNs = 0;
+    game->gameStatus.handoffMaxNs = 0;
+    game->gameStatus.rankChangedNs = 0;
+    game->gameStatus.rankWakeups = 0;
+    game->gameStatus.rankWakeTotalNs = 0;
+    game->gameStatus.rankWakeMaxNs = 0;
+    game->gameStatus.monitorLockTakes = 0;
+    occupancyClear(&game->occupancy);
+}
+
+// Function to initialize the turn synchronization primitives
+void initializeTurnSync(GameContext *game) {
+    pthread_mutex_init(&game->gameStatus.mutexLock, NULL);
+    pthread_cond_init(&game->gameStatus.rankChanged, NULL);
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        pthread_cond_init(&game->gameStatus.turnSignal[i], NULL);
+    }
+}
+
+// Function to release the turn synchronization primitives
+void destroyTurnSync(GameContext *game) {
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        pthread_cond_destroy(&game->gameStatus.turnSignal[i]);
+    }
+    pthread_cond_destroy(&game->gameStatus.rankChanged);
+    pthread_mutex_destroy(&game->gameStatus.mutexLock);
+}
+
+// Function to play one turn on the calling thread
+void playHeadlessTurn(GameContext *game) {
+    PlayerInfo *player = &game->playersList[game->gameStatus.currentTurn - 1];
+    processDiceRoll(game, player, diceRoll(game));
+    game->gameStatus.currentTurn = (game->gameStatus.currentTurn % MAX_PLAYERS) + 1;
+}
+
+// Function to play one full game on the calling thread, returns turns played
+long playHeadlessGame(GameContext *game) {
+    resetGame(game);
+
+    long turns = 0;
+    while (game->activePlayerCount > 1) {
+        playHeadlessTurn(game);
+        turns++;
+    }
+    return turns;
+}
+
+// Function to convert a game into its packed form
+void packGameState(const GameContext *game, PackedGameState *state) {
+    packedResetState(state);
+
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        const PlayerInfo *player = &game->playersList[p];
+
+        for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
+            const GameToken *token = &player->tokens[j];
+            uint8_t progress = PROGRESS_YARD;
+
+            if (token->hasReachedHome) {
+                progress = PROGRESS_FINISHED;
+            } else if (!token->isInYard) {
+                progress = routeTables.progressAt[p][token->posX][token->posY];
             }
+            state->tokens[p * TOKENS_PER_PLAYER + j] = progress;
+        }
+
+        packedSetSixCount(state, p, player->sixesRolledConsecutively);
+        packedSetRank(state, p, game->playerRanks[p]);
+        state->killCounts[p] = player->killCount > 255 ? 255 : player->killCount;
+    }
+    state->currentTurn = game->gameStatus.currentTurn - 1;
+}
+
+// Function to rebuild the players and board of a game from its packed form
+void unpackGameState(const PackedGameState *state, GameContext *game) {
+    resetGame(game);
+
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        PlayerInfo *player = &game->playersList[p];
 
-            // Display kill counts
-            for (int i = 0; i < MAX_PLAYERS; i++) {
-                printf("Player %d's total kills: %d\n", playersList[i].playerID, playersList[i].killCount);
+        for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
+            GameToken *token = &player->tokens[j];
+            int progress = state->tokens[p * TOKENS_PER_PLAYER + j];
+            BoardPosition position = progressToPosition(p, j, progress);
+
+            token->posX = position.x;
+            token->posY = position.y;
+            token->isInYard = (progress == PROGRESS_YARD);
+            token->isInHome = progressInHomePath(progress);
+            token->hasReachedHome = (progress == PROGRESS_FINISHED);
+        }
+
+        player->finishedTokens = 0;
+        for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
+            if (player->tokens[j].hasReachedHome) player->finishedTokens++;
+        }
+        player->sixesRolledConsecutively = packedSixCount(state, p);
+        player->killCount = state->killCounts[p];
+        game->playerRanks[p] = packedRank(state, p);
+    }
+
+    occupancyBuild(&game->occupancy, state);
+    game->rankCounter = packedRankedCount(state) + 1;
+    game->activePlayerCount = MAX_PLAYERS - packedRankedCount(state);
+    game->gameStatus.currentTurn = state->currentTurn + 1;
+}
+
+// Function to snapshot a game: position, dice and turn count
+void saveGameSnapshot(const GameContext *game, GameSnapshot *snapshot) {
+    PackedGameState state;
+    packGameState(game, &state);
+    snapshotCapture(snapshot, &state, &game->rng, (uint32_t)game->gameStatus.turnsPlayed);
+}
+
+// Function to put a game back at a snapshot; returns false for another snapshot version
+bool restoreGameSnapshot(GameContext *game, const GameSnapshot *snapshot) {
+    PackedGameState state;
+    if (!snapshotRestore(snapshot, &state, &game->rng)) return false;
+    unpackGameState(&state, game);
+    game->gameStatus.turnsPlayed = snapshot->turnsPlayed;
+    return true;
+}
+
+// Function to check that the packed engine replays games exactly like the GameContext engine
+void runPackedVerification(int gameCount, uint64_t baseSeed) {
+    headlessMode = true;
+    GameContext *game = (GameContext *)calloc(1, sizeof(GameContext));
+    int capacity = 4096;
+    PackedGameState *history = (PackedGameState *)malloc(capacity * sizeof(PackedGameState));
+    int mismatches = 0;
+    int indexMismatches = 0;
+
+    for (int g = 0; g < gameCount; g++) {
+        uint64_t seed = baseSeed + g;
+
+        // Record the GameContext game turn by turn; its occupancy index must
+        // match one rebuilt from the tokens after every turn
+        diceRngSeed(&game->rng, seed);
+        resetGame(game);
+        int turns = 0;
+        bool indexValid = true;
+        OccupancyIndex rebuilt;
+        while (game->activePlayerCount > 1) {
+            playHeadlessTurn(game);
+            if (turns == capacity) {
+                capacity *= 2;
+                history = (PackedGameState *)realloc(history, capacity * sizeof(PackedGameState));
+            }
+            packGameState(game, &history[turns]);
+            occupancyBuild(&rebuilt, &history[turns++]);
+            if (indexValid && !occupancyEquals(&game->occupancy, &rebuilt)) {
+                printf("Game %d (seed %llu): GameContext occupancy index wrong at turn %d\n",
+                       g, (unsigned long long)seed, turns);
+                indexValid = false;
+                indexMismatches++;
             }
+        }
+
+        // Replay it with the packed engine from the same seed
+        DiceRng rng;
+        diceRngSeed(&rng, seed);
+        PackedGameState state;
+        OccupancyIndex occupancy;
+        packedResetState(&state);
+        occupancyClear(&occupancy);
+        for (int t = 0; t < turns; t++) {
+            packedPlayTurn(&state, &occupancy, &rng);
+            if (!packedStateEquals(&state, &history[t])) {
+                printf("Game %d (seed %llu) diverges at turn %d\n", g, (unsigned long long)seed, t + 1);
+                mismatches++;
+                break;
+            }
+            occupancyBuild(&rebuilt, &state);
+            if (!occupancyEquals(&occupancy, &rebuilt)) {
+                printf("Game %d (seed %llu): packed occupancy index wrong at turn %d\n",
+                       g, (unsigned long long)seed, t + 1);
+                indexMismatches++;
+                break;
+            }
+        }
+
+        // Round trip through the GameContext view must be lossless
+        PackedGameState roundTrip;
+        unpackGameState(&state, game);
+        packGameState(game, &roundTrip);
+        if (!packedStateEquals(&state, &roundTrip)) {
+            printf("Game %d (seed %llu) does not survive pack/unpack\n", g, (unsigned long long)seed);
+            mismatches++;
+        }
+    }
+
+    printf("Packed engine verification: %d games, %d mismatches, %d occupancy index mismatches\n",
+           gameCount, mismatches, indexMismatches);
+    free(history);
+    free(game);
+}
+
+// Function to run a batch of headless games and report throughput
+void runHeadlessBatch(int gameCount, bool useGameContext, uint64_t baseSeed) {
+    headlessMode = true;
+    GameContext *game = (GameContext *)calloc(1, sizeof(GameContext));
+    PackedGameState state;
+    DiceRng rng;
+
+    int wins[MAX_PLAYERS] = {0};
+    long totalTurns = 0;
+    uint64_t checksum = 0;
+
+    struct timespec startTime, endTime;
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+    for (int g = 0; g < gameCount; g++) {
+        if (useGameContext) {
+            diceRngSeed(&game->rng, baseSeed + g);
+            totalTurns += playHeadlessGame(game);
+            packGameState(game, &state);
+        } else {
+            diceRngSeed(&rng, baseSeed + g);
+            totalTurns += playPackedGame(&state, &rng);
+        }
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            if (packedRank(&state, p) == 1) wins[p]++;
+        }
+        checksum = checksum * 31 + packedStateHash(&state);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
+    double elapsed = (endTime.tv_sec - startTime.tv_sec) +
+                     (endTime.tv_nsec - startTime.tv_nsec) / 1e9;
 
-            exit(0);
+    printf("=== HEADLESS BATCH (%s) ===\n", useGameContext ? "GameContext" : "packed");
+    printf("Games played: %d, seed %llu\n", gameCount, (unsigned long long)baseSeed);
+    printf("Average turns per game: %.1f\n", gameCount > 0 ? (double)totalTurns / gameCount : 0.0);
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        printf("Player %d wins: %d\n", p + 1, wins[p]);
+    }
+    printf("Elapsed: %.3f s\n", elapsed);
+    printf("Throughput: %.0f games/sec\n", elapsed > 0 ? gameCount / elapsed : 0.0);
+    printf("Result checksum: %016llx\n", (unsigned long long)checksum);
+
+    free(game);
+}
+
+// Function to run a batch of headless games in lockstep lanes and report throughput.
+// The results are the packed batch's, game for game, so the checksum is the same.
+void runLaneBatch(int gameCount, uint64_t baseSeed) {
+    PackedGameState *states = (PackedGameState *)malloc(sizeof(PackedGameState) * (gameCount > 0 ? gameCount : 1));
+    int wins[MAX_PLAYERS] = {0};
+    uint64_t checksum = 0;
+
+    long long startNs = monotonicNanos();
+    long totalTurns = lanePlayGames(0, gameCount, baseSeed, states, NULL);
+    for (int g = 0; g < gameCount; g++) {
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            if (packedRank(&states[g], p) == 1) wins[p]++;
+        }
+        checksum = checksum * 31 + packedStateHash(&states[g]);
+    }
+    double elapsed = (monotonicNanos() - startNs) / 1e9;
+
+    printf("=== HEADLESS BATCH (lockstep, %d lanes, %s) ===\n", LANE_COUNT, LANE_ISA);
+    printf("Games played: %d, seed %llu\n", gameCount, (unsigned long long)baseSeed);
+    printf("Average turns per game: %.1f\n", gameCount > 0 ? (double)totalTurns / gameCount : 0.0);
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        printf("Player %d wins: %d\n", p + 1, wins[p]);
+    }
+    printf("Elapsed: %.3f s\n", elapsed);
+    printf("Throughput: %.0f games/sec\n", elapsed > 0 ? gameCount / elapsed : 0.0);
+    printf("Result checksum: %016llx\n", (unsigned long long)checksum);
+
+    free(states);
+}
+
+// Function to play a batch of packed games under a rules variant
+template <typename Rules>
+void runVariantBatch(int gameCount, uint64_t baseSeed) {
+    PackedState<Rules> state;
+    DiceRng rng;
+    int wins[Rules::players] = {0};
+    long totalTurns = 0;
+    long kills = 0;
+    uint64_t checksum = 0;
+
+    long long startNs = monotonicNanos();
+    for (int g = 0; g < gameCount; g++) {
+        diceRngSeed(&rng, baseSeed + g);
+        totalTurns += playPackedGame(&state, &rng);
+        for (int p = 0; p < Rules::players; p++) {
+            if (packedRank(&state, p) == 1) wins[p]++;
+            kills += state.killCounts[p];
+        }
+        checksum = checksum * 31 + packedStateHash(&state);
+    }
+    double elapsed = (monotonicNanos() - startNs) / 1e9;
+
+    printf("=== HEADLESS BATCH (packed, %d players, %d-cell track) ===\n", Rules::players, Rules::trackLength);
+    printf("Games played: %d, seed %llu\n", gameCount, (unsigned long long)baseSeed);
+    printf("Average turns per game: %.1f, captures per game: %.1f\n",
+           gameCount > 0 ? (double)totalTurns / gameCount : 0.0, gameCount > 0 ? (double)kills / gameCount : 0.0);
+    for (int p = 0; p < Rules::players; p++) {
+        printf("Player %d wins: %d\n", p + 1, wins[p]);
+    }
+    printf("Elapsed: %.3f s\n", elapsed);
+    printf("Throughput: %.0f games/sec\n", elapsed > 0 ? gameCount / elapsed : 0.0);
+    printf("Result checksum: %016llx\n", (unsigned long long)checksum);
+}
+
+// Pool task that plays a slice of tournament games
+void playTournamentBatch(void *arg, int workerID) {
+    (void)workerID;
+    TournamentBatch *batch = (TournamentBatch *)arg;
+    PackedGameState state;
+    DiceRng rng;
+
+    for (int g = batch->firstGame; g < batch->firstGame + batch->gameCount; g++) {
+        GameResult *result = &batch->results[g];
+        diceRngSeed(&rng, batch->baseSeed + g);
+        result->turns = playPackedGame(&state, &rng);
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            result->playerRanks[p] = packedRank(&state, p);
+            result->killCounts[p] = state.killCounts[p];
         }
+    }
+}
+
+// Function to play independent games on a work-stealing pool; the caller frees the results
+GameResult *runTournament(int gameCount, int workerCount, uint64_t baseSeed) {
+    headlessMode = true;
+
+    GameResult *results = (GameResult *)calloc(gameCount, sizeof(GameResult));
+    int batchCount = (gameCount + TOURNAMENT_BATCH_SIZE - 1) / TOURNAMENT_BATCH_SIZE;
+    TournamentBatch *batches = (TournamentBatch *)calloc(batchCount, sizeof(TournamentBatch));
+
+    WorkStealingPool *pool = poolCreate(workerCount);
+    for (int b = 0; b < batchCount; b++) {
+        batches[b].results = results;
+        batches[b].baseSeed = baseSeed;
+        batches[b].firstGame = b * TOURNAMENT_BATCH_SIZE;
+        batches[b].gameCount = gameCount - batches[b].firstGame;
+        if (batches[b].gameCount > TOURNAMENT_BATCH_SIZE) batches[b].gameCount = TOURNAMENT_BATCH_SIZE;
+        poolSubmit(pool, playTournamentBatch, &batches[b]);
+    }
+    poolRun(pool);
+    poolDestroy(pool);
+
+    free(batches);
+    return results;
+}
 
-        pthread_mutex_unlock(&gameStatus.mutexLock);
-        sleep(1);
+// Function to run a tournament and report results and throughput
+void runTournamentReport(int gameCount, int workerCount, uint64_t baseSeed) {
+    long long startNs = monotonicNanos();
+    GameResult *results = runTournament(gameCount, workerCount, baseSeed);
+    double elapsed = (monotonicNanos() - startNs) / 1e9;
+
+    int wins[MAX_PLAYERS] = {0};
+    long totalTurns = 0;
+    uint64_t checksum = 0;
+    for (int g = 0; g < gameCount; g++) {
+        totalTurns += results[g].turns;
+        checksum = checksum * 31 + results[g].turns;
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            if (results[g].playerRanks[p] == 1) wins[p]++;
+            checksum = checksum * 31 + results[g].playerRanks[p] * 256 + results[g].killCounts[p];
+        }
     }
 
+    printf("=== TOURNAMENT ===\n");
+    printf("Games played: %d on %d workers, seed %llu\n", gameCount, workerCount, (unsigned long long)baseSeed);
+    printf("Average turns per game: %.1f\n", gameCount > 0 ? (double)totalTurns / gameCount : 0.0);
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        printf("Player %d wins: %d\n", p + 1, wins[p]);
+    }
+    printf("Elapsed: %.3f s\n", elapsed);
+    printf("Throughput: %.0f games/sec\n", elapsed > 0 ? gameCount / elapsed : 0.0);
+    printf("Result checksum: %016llx\n", (unsigned long long)checksum);
+
+    free(results);
+}
+
+// Pool task that keeps claiming batches of games and records them into its
+// worker's own accumulator
+template <typename Rules>
+void playStatsGames(void *arg, int workerID) {
+    StatsRun *run = (StatsRun *)arg;
+    StatsAccumulator *stats = &run->workerStats[workerID];
+    PackedState<Rules> state;
+    DiceRng rng;
+
+    long first;
+    while ((first = run->nextGame.fetch_add(TOURNAMENT_BATCH_SIZE)) < run->gameCount) {
+        long last = first + TOURNAMENT_BATCH_SIZE < run->gameCount ? first + TOURNAMENT_BATCH_SIZE : run->gameCount;
+        for (long g = first; g < last; g++) {
+            diceRngSeed(&rng, run->baseSeed + g);
+            statsPlayGame(&state, &rng, stats);
+        }
+    }
+}
+
+// Function to gather statistics over many games on the pool. Memory does not
+// grow with the game count: workers claim games from a counter and record
+// into per-worker accumulators, merged once at the end.
+template <typename Rules>
+void runStatsReport(long gameCount, int workerCount, uint64_t baseSeed, const char *csvPath, const char *jsonPath) {
+    if (workerCount < 1) workerCount = 1;
+    StatsRun *run = new StatsRun();
+    run->nextGame = 0;
+    run->gameCount = gameCount;
+    run->baseSeed = baseSeed;
+    run->workerStats = new StatsAccumulator[workerCount];
+    for (int w = 0; w < workerCount; w++) statsReset(&run->workerStats[w], Rules::players);
+
+    long long startNs = monotonicNanos();
+    WorkStealingPool *pool = poolCreate(workerCount);
+    for (int w = 0; w < workerCount; w++) poolSubmit(pool, playStatsGames<Rules>, run);
+    poolRun(pool);
+    poolDestroy(pool);
+    double elapsed = (monotonicNanos() - startNs) / 1e9;
+
+    StatsAccumulator *total = new StatsAccumulator();
+    statsReset(total, Rules::players);
+    for (int w = 0; w < workerCount; w++) statsMerge(total, &run->workerStats[w]);
+
+    printf("=== GAME STATISTICS (%d players) ===\n", Rules::players);
+    statsPrint(total);
+    printf("Elapsed: %.3f s on %d workers (%.0f games/sec), %zu bytes of accumulators per worker\n", elapsed,
+           workerCount, elapsed > 0 ? gameCount / elapsed : 0.0, sizeof(StatsAccumulator));
+    if (csvPath && statsWriteCsv(total, csvPath)) printf("Statistics written to %s\n", csvPath);
+    if (jsonPath && statsWriteJson(total, jsonPath)) printf("Statistics written to %s\n", jsonPath);
+
+    delete total;
+    delete[] run->workerStats;
+    delete run;
+}
+
+// Function to play turns of a game with one thread per player until the
+// turn limit (the game's synchronization must be initialized); returns the elapsed ns
+long long playThreadedTurns(GameContext *game, long turnCount, bool usePolling) {
+    game->gameStatus.turnLimit = turnCount;
+    game->gameStatus.turnDelayMicros = 0;
+    long long startNs = monotonicNanos();
+
+    pthread_t playerThreads[MAX_PLAYERS];
+    PlayerThreadArgs threadArgs[MAX_PLAYERS];
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        threadArgs[i].game = game;
+        threadArgs[i].player = &game->playersList[i];
+        pthread_create(&playerThreads[i], NULL,
+                       usePolling ? pollingPlayerRoutine : playerRoutine, &threadArgs[i]);
+    }
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        pthread_join(playerThreads[i], NULL);
+    }
+    return monotonicNanos() - startNs;
+}
+
+// Function to get the CPU time the process has used, user and system
+double processCpuSeconds() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+// Function to measure turn handoff cost of the player threads
+void runHandoffBenchmark(long turnCount, bool usePolling, uint64_t seed) {
+    headlessMode = true;
+    GameContext *game = (GameContext *)calloc(1, sizeof(GameContext));
+    diceRngSeed(&game->rng, seed);
+    resetGame(game);
+    initializeTurnSync(game);
+
+    struct rusage usageBefore, usageAfter;
+    getrusage(RUSAGE_SELF, &usageBefore);
+    long long elapsedNs = playThreadedTurns(game, turnCount, usePolling);
+    getrusage(RUSAGE_SELF, &usageAfter);
+    long contextSwitches = (usageAfter.ru_nvcsw - usageBefore.ru_nvcsw) +
+                           (usageAfter.ru_nivcsw - usageBefore.ru_nivcsw);
+
+    printf("=== HANDOFF BENCHMARK (%s) ===\n", usePolling ? "polling" : "baton");
+    printf("Turns played: %ld in %.3f s\n", game->gameStatus.turnsPlayed, elapsedNs / 1e9);
+    printHandoffStats(game);
+    printf("Context switches per turn: %.2f\n",
+           game->gameStatus.turnsPlayed > 0 ? (double)contextSwitches / game->gameStatus.turnsPlayed : 0.0);
+    instrumentPrintReport();
+
+    destroyTurnSync(game);
+    free(game);
+}
+
+#ifdef CORO_SCHEDULER_AVAILABLE
+// One game in flight on a coroutine worker: its four seats and its monitor
+// are coroutines that only ever run on that worker
+struct CoroGame {
+    GameContext *game;                  // Game state, played by the usual rule functions
+    long gameIndex;                     // Game being played (seeded baseSeed + gameIndex)
+    bool over;                          // Set by the monitor when one player is left
+    int liveTasks;                      // Seat and monitor coroutines not finished yet
+    CoroSignal turnSignal[MAX_PLAYERS]; // Turn baton: wakes only the next seat
+    CoroSignal rankChanged;             // Wakes the monitor when a player is ranked
+    CoroTask tasks[MAX_PLAYERS + 1];    // The seats, then the monitor
+    CoroGame *nextFinished;             // Link in the worker's list of finished games
+};
+
+// Games of a coroutine run, claimed one at a time by the workers
+struct CoroRun {
+    std::atomic<long> nextGame;     // Next game to start
+    long gameCount;                 // Games to play
+    uint64_t baseSeed;              // Game g is seeded with baseSeed + g
+    int gamesPerWorker;             // Games each worker keeps in flight
+    PackedGameState *finalStates;   // Final state of every game, in game order
+    std::atomic<long> turnsPlayed;  // Turns played by all workers
+    std::atomic<long> resumes;      // Coroutine resumes by all workers
+};
+
+// A worker thread's scheduler and the games it runs
+struct CoroGameWorker {
+    CoroWorker worker;     // Run queue of the worker's coroutines
+    CoroRun *run;          // Shared run the games come from
+    CoroGame *finished;    // Games whose coroutines have all returned
+};
+
+// Function to note that one of a game's coroutines is about to return
+void coroTaskDone(CoroGameWorker *gw, CoroGame *cg) {
+    if (--cg->liveTasks > 0) return;
+    cg->nextFinished = gw->finished;
+    gw->finished = cg;
+}
+
+// Seat coroutine: playerRoutine without a thread. Waits for the baton, plays
+// the turn with the same rule functions and hands the baton on.
+CoroTask coroPlayer(CoroGameWorker *gw, CoroGame *cg, PlayerInfo *player) {
+    GameContext *game = cg->game;
+    for (;;) {
+        while (!cg->over && game->gameStatus.currentTurn != player->playerID) {
+            co_await coroWait(&cg->turnSignal[player->playerID - 1]);
+        }
+        if (cg->over) break;
+
+        int rankCounter = game->rankCounter;
+        playTurn(game, player);
+        game->gameStatus.currentTurn = (game->gameStatus.currentTurn % MAX_PLAYERS) + 1;
+        game->gameStatus.turnsPlayed++;
+
+        // The monitor is queued first, so a finished game ends before the next turn
+        if (game->rankCounter != rankCounter) coroNotify(&gw->worker, &cg->rankChanged);
+        coroNotify(&gw->worker, &cg->turnSignal[game->gameStatus.currentTurn - 1]);
+    }
+    coroTaskDone(gw, cg);
+}
+
+// Monitor coroutine: waits for rank changes and ends the game when one player is left
+CoroTask coroMonitor(CoroGameWorker *gw, CoroGame *cg) {
+    while (cg->game->activePlayerCount > 1) {
+        co_await coroWait(&cg->rankChanged);
+    }
+    cg->over = true;
+    for (int i = 0; i < MAX_PLAYERS; i++) coroNotify(&gw->worker, &cg->turnSignal[i]);
+    coroTaskDone(gw, cg);
+}
+
+// Function to start the next game of the run in a slot; returns false when none are left
+bool coroStartGame(CoroGameWorker *gw, CoroGame *cg) {
+    long index = gw->run->nextGame.fetch_add(1, std::memory_order_relaxed);
+    if (index >= gw->run->gameCount) return false;
+
+    cg->gameIndex = index;
+    diceRngSeed(&cg->game->rng, gw->run->baseSeed + index);
+    resetGame(cg->game);
+    cg->over = false;
+    cg->liveTasks = MAX_PLAYERS + 1;
+    cg->rankChanged.waiter = nullptr;
+    for (int i = 0; i < MAX_PLAYERS; i++) cg->turnSignal[i].waiter = nullptr;
+
+    cg->tasks[MAX_PLAYERS] = coroMonitor(gw, cg);
+    for (int i = 0; i < MAX_PLAYERS; i++) cg->tasks[i] = coroPlayer(gw, cg, &cg->game->playersList[i]);
+    for (int i = 0; i <= MAX_PLAYERS; i++) coroSchedule(&gw->worker, cg->tasks[i].handle);
+    return true;
+}
+
+// Function to record a finished game and free its coroutines
+void coroEndGame(CoroGameWorker *gw, CoroGame *cg) {
+    packGameState(cg->game, &gw->run->finalStates[cg->gameIndex]);
+    gw->run->turnsPlayed.fetch_add(cg->game->gameStatus.turnsPlayed, std::memory_order_relaxed);
+    for (int i = 0; i <= MAX_PLAYERS; i++) cg->tasks[i].handle.destroy();
+}
+
+// Worker thread: keeps its share of games in flight until the run has no more
+void *coroWorkerRoutine(void *arg) {
+    CoroGameWorker *gw = (CoroGameWorker *)arg;
+    int slotCount = gw->run->gamesPerWorker;
+    coroWorkerInit(&gw->worker, slotCount * (MAX_PLAYERS + 1));
+    gw->finished = NULL;
+
+    CoroGame *games = new CoroGame[slotCount];
+    for (int i = 0; i < slotCount; i++) {
+        games[i].game = (GameContext *)calloc(1, sizeof(GameContext));
+        if (!coroStartGame(gw, &games[i])) games[i].liveTasks = 0;
+    }
+
+    while (coroRunOne(&gw->worker)) {
+        while (gw->finished) {
+            CoroGame *cg = gw->finished;
+            gw->finished = cg->nextFinished;
+            coroEndGame(gw, cg);
+            coroStartGame(gw, cg);
+        }
+    }
+
+    gw->run->resumes.fetch_add(gw->worker.resumes, std::memory_order_relaxed);
+    for (int i = 0; i < slotCount; i++) free(games[i].game);
+    delete[] games;
+    coroWorkerDestroy(&gw->worker);
     return NULL;
 }
 
-int main() {
-    srand(time(NULL));
+// Function to play games as coroutines on one thread per worker, thousands in
+// flight at once, and compare turns per CPU second and memory per game with
+// the thread-per-player design
+void runCoroutineGames(long gameCount, int workerCount, int concurrentGames, uint64_t baseSeed) {
+    headlessMode = true;
+    if (workerCount < 1) workerCount = 1;
+    if (concurrentGames < workerCount) concurrentGames = workerCount;
+
+    CoroRun *run = new CoroRun();
+    run->nextGame.store(0);
+    run->gameCount = gameCount;
+    run->baseSeed = baseSeed;
+    run->gamesPerWorker = (concurrentGames + workerCount - 1) / workerCount;
+    run->finalStates = (PackedGameState *)calloc(gameCount > 0 ? gameCount : 1, sizeof(PackedGameState));
+    run->turnsPlayed.store(0);
+    run->resumes.store(0);
+    long framesBefore = coroFrameCount.load();
+    long frameBytesBefore = coroFrameBytes.load();
+
+    double cpuBefore = processCpuSeconds();
+    long long startNs = monotonicNanos();
+    pthread_t *threads = new pthread_t[workerCount];
+    CoroGameWorker *workers = new CoroGameWorker[workerCount];
+    for (int w = 0; w < workerCount; w++) {
+        workers[w].run = run;
+        pthread_create(&threads[w], NULL, coroWorkerRoutine, &workers[w]);
+    }
+    for (int w = 0; w < workerCount; w++) pthread_join(threads[w], NULL);
+    double elapsed = (monotonicNanos() - startNs) / 1e9;
+    double cpuSeconds = processCpuSeconds() - cpuBefore;
+
+    int wins[MAX_PLAYERS] = {0};
+    uint64_t checksum = 0;
+    for (long g = 0; g < gameCount; g++) {
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            if (packedRank(&run->finalStates[g], p) == 1) wins[p]++;
+        }
+        checksum = checksum * 31 + packedStateHash(&run->finalStates[g]);
+    }
+    long turns = run->turnsPlayed.load();
+    long frames = coroFrameCount.load() - framesBefore;
+    double frameBytes = frames > 0 ? (double)(coroFrameBytes.load() - frameBytesBefore) / frames : 0.0;
+    size_t gameBytes = sizeof(GameContext) + sizeof(CoroGame) + (size_t)((MAX_PLAYERS + 1) * frameBytes);
+
+    printf("=== COROUTINE GAMES ===\n");
+    printf("Games played: %ld, seed %llu, on %d worker threads with %d games in flight\n", gameCount,
+           (unsigned long long)baseSeed, workerCount, run->gamesPerWorker * workerCount);
+    printf("Average turns per game: %.1f\n", gameCount > 0 ? (double)turns / gameCount : 0.0);
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        printf("Player %d wins: %d\n", p + 1, wins[p]);
+    }
+    printf("Elapsed: %.3f s (%.3f s CPU), coroutine resumes: %ld\n", elapsed, cpuSeconds, run->resumes.load());
+    printf("Turns/sec per core: %.0f\n", cpuSeconds > 0 ? turns / cpuSeconds : 0.0);
+    printf("Memory per game: %zu bytes (GameContext %zu, slot %zu, %d coroutine frames of %.0f bytes)\n",
+           gameBytes, sizeof(GameContext), sizeof(CoroGame), MAX_PLAYERS + 1, frameBytes);
+    printf("Result checksum: %016llx\n", (unsigned long long)checksum);
+
+    // The same rules on four player threads and a monitor per game
+    const long threadedTurns = 20000;
+    GameContext *game = (GameContext *)calloc(1, sizeof(GameContext));
+    diceRngSeed(&game->rng, baseSeed);
+    resetGame(game);
+    initializeTurnSync(game);
+    cpuBefore = processCpuSeconds();
+    playThreadedTurns(game, threadedTurns, false);
+    double threadedCpu = processCpuSeconds() - cpuBefore;
+    destroyTurnSync(game);
+    free(game);
+
+    size_t stackBytes = 0;
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    pthread_attr_getstacksize(&attributes, &stackBytes);
+    pthread_attr_destroy(&attributes);
+
+    printf("--- thread per player (%ld turns) ---\n", threadedTurns);
+    printf("Turns/sec per core: %.0f\n", threadedCpu > 0 ? threadedTurns / threadedCpu : 0.0);
+    printf("Memory per game: %zu bytes + %d thread stacks of %zu KiB reserved\n",
+           sizeof(GameContext), MAX_PLAYERS + 1, stackBytes / 1024);
+
+    delete[] workers;
+    delete[] threads;
+    free(run->finalStates);
+    delete run;
+}
+#endif
+
+// Function to play 2-player games with Blue playing endgames from the tablebase
+// (random moves before that) and Green random, against the same seeds with
+// both random
+void runTablebaseMatch(const char *path, int gameCount, uint64_t baseSeed) {
+    Tablebase *table = tablebaseOpen(path);
+    if (!table) return;
+
+    int tableWins = 0, randomWins = 0;
+    long probedTurns = 0, probedGames = 0;
+    long long probeNs = 0;
+    for (int g = 0; g < gameCount; g++) {
+        EndgameState state;
+        DiceRng rng;
+        diceRngSeed(&rng, baseSeed + g);
+        playPackedGame(&state, &rng);
+        if (packedRank(&state, 0) == 1) randomWins++;
+
+        EndgameOccupancy occupancy;
+        diceRngSeed(&rng, baseSeed + g);
+        packedResetState(&state);
+        occupancyClear(&occupancy);
+        bool probed = false;
+        while (!packedGameOver(&state)) {
+            int roll = diceRngRoll(&rng);
+            PackedMove moves[TOKENS_PER_PLAYER];
+            int count = generateMoves(&state, &occupancy, roll, moves);
+            int choice = -1;
+            if (state.currentTurn == 0 && count > 1) {
+                long long startNs = monotonicNanos();
+                choice = tablebaseChooseMove(table, &state, &occupancy, moves, count, NULL);
+                probeNs += monotonicNanos() - startNs;
+                if (choice >= 0) {
+                    probedTurns++;
+                    probed = true;
+                }
+            }
+            if (choice < 0) choice = chooseRandomMove<EndgameRules>(moves, count, &rng);
+            packedFinishTurn(&state, &occupancy, roll, choice >= 0 ? &moves[choice] : NULL);
+        }
+        if (packedRank(&state, 0) == 1) tableWins++;
+        if (probed) probedGames++;
+    }
+
+    printf("=== TABLEBASE MATCH (%d games, 2 players) ===\n", gameCount);
+    printf("Blue wins with endgame table: %.2f%%, all random: %.2f%%\n",
+           gameCount > 0 ? 100.0 * tableWins / gameCount : 0.0, gameCount > 0 ? 100.0 * randomWins / gameCount : 0.0);
+    printf("Games reaching a table endgame with a choice: %ld, table moves: %ld, %.0f ns per move\n",
+           probedGames, probedTurns, probedTurns > 0 ? (double)probeNs / probedTurns : 0.0);
+    tablebaseClose(table);
+}
+
+// Function to measure the cost of drawing the board after every turn, as full
+// frames and as cell diffs, written to /dev/null as if it were a terminal
+void runRenderBenchmark(long turnCount, uint64_t seed) {
+    headlessMode = true;
+    int nullFd = open("/dev/null", O_WRONLY);
+    if (nullFd < 0) {
+        perror("open /dev/null");
+        return;
+    }
+
+    const char *modeNames[2] = { "full frames", "cell diffs" };
+    printf("=== RENDER BENCHMARK (%ld turns) ===\n", turnCount);
+    for (int mode = 0; mode < 2; mode++) {
+        BoardRenderer *renderer = (BoardRenderer *)malloc(sizeof(BoardRenderer));
+        rendererInit(renderer, nullFd, 0, mode == 1);
+        renderer->isTerminal = true;
+
+        GameContext *game = (GameContext *)calloc(1, sizeof(GameContext));
+        diceRngSeed(&game->rng, seed);
+        resetGame(game);
+
+        long long renderNs = 0;
+        for (long turn = 0; turn < turnCount; turn++) {
+            if (game->activePlayerCount <= 1) resetGame(game);
+            playHeadlessTurn(game);
+
+            long long startNs = monotonicNanos();
+            renderGame(renderer, game, false);
+            renderNs += monotonicNanos() - startNs;
+        }
+
+        printf("--- %s ---\n", modeNames[mode]);
+        rendererPrintStats(renderer);
+        printf("Time per frame: %.0f ns\n", renderer->framesRendered > 0 ? (double)renderNs / renderer->framesRendered : 0.0);
+        free(game);
+        free(renderer);
+    }
+    // printf rendering on a line-buffered terminal flushed at every printf holding a newline
+    printf("(printf rendering: %d write calls per frame on a terminal)\n", 2 + BOARD_DIMENSION);
+    close(nullFd);
+}
+
+// Function to play packed games and append every turn to an event log
+void runLogRecording(const char *path, int gameCount, uint64_t baseSeed) {
+    EventLogWriter *writer = eventLogCreate(path, DEFAULT_KEYFRAME_INTERVAL);
+    if (!writer) return;
+
+    long long startNs = monotonicNanos();
+    for (int g = 0; g < gameCount; g++) {
+        PackedGameState state;
+        OccupancyIndex occupancy;
+        DiceRng rng;
+        diceRngSeed(&rng, baseSeed + g);
+        packedResetState(&state);
+        occupancyClear(&occupancy);
+
+        eventLogBeginGame(writer, g, baseSeed + g);
+        while (!packedGameOver(&state)) {
+            int roll = packedPlayTurn(&state, &occupancy, &rng);
+            eventLogRecordTurn(writer, roll, &state);
+        }
+        eventLogEndGame(writer);
+    }
+    double elapsed = (monotonicNanos() - startNs) / 1e9;
+
+    printf("=== EVENT LOG ===\n");
+    printf("Logged %d games, %ld turns to %s\n", gameCount, writer->eventsWritten, path);
+    printf("Size: %ld bytes, %.2f bytes per turn\n", writer->bytesWritten,
+           writer->eventsWritten > 0 ? (double)writer->bytesWritten / writer->eventsWritten : 0.0);
+    printf("Elapsed: %.3f s (%.0f games/sec)\n", elapsed, elapsed > 0 ? gameCount / elapsed : 0.0);
+    eventLogClose(writer);
+}
+
+// Function to show a logged game at a turn, check it against a fresh simulation
+// of the logged seed and time random seeks
+void runLogReplay(const char *path, long game, long turn) {
+    EventLogReader *reader = eventLogOpen(path);
+    if (!reader) return;
+    if (eventLogIndexGames(reader) == 0 || game < 0 || game >= reader->gameCount) {
+        printf("Game %ld not found (%ld games in log)\n", game, reader->gameCount);
+        eventLogCloseReader(reader);
+        return;
+    }
+
+    const LogGameEntry *entry = &reader->games[game];
+    if (turn < 0 || turn > entry->turns) turn = entry->turns;
+
+    PackedGameState state;
+    eventLogSeek(reader, game, (uint32_t)turn, &state);
+
+    GameContext *view = (GameContext *)calloc(1, sizeof(GameContext));
+    unpackGameState(&state, view);
+    rendererInit(&terminalRenderer, STDOUT_FILENO, 0, false);
+    terminalRenderer.isTerminal = false;
+    renderGame(&terminalRenderer, view, true);
+
+    printf("Game %u (seed %llu) after turn %ld of %u\n", entry->gameIndex,
+           (unsigned long long)entry->seed, turn, entry->turns);
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        printf("Player %d: rank %d, kills %d\n", p + 1, packedRank(&state, p), state.killCounts[p]);
+    }
+
+    // The packed engine replays the logged seed; the states must agree
+    PackedGameState simulated;
+    OccupancyIndex occupancy;
+    DiceRng rng;
+    diceRngSeed(&rng, entry->seed);
+    packedResetState(&simulated);
+    occupancyClear(&occupancy);
+    for (long t = 0; t < turn; t++) packedPlayTurn(&simulated, &occupancy, &rng);
+    printf("Matches simulation of the seed: %s\n", packedStateEquals(&state, &simulated) ? "yes" : "NO");
+
+    // Random seeks across the whole log
+    const int seekCount = 1000000;
+    uint64_t checksum = 0;
+    DiceRng picker;
+    diceRngSeed(&picker, entry->seed);
+    long long startNs = monotonicNanos();
+    for (int i = 0; i < seekCount; i++) {
+        long g = diceRngBelow(&picker, (uint32_t)reader->gameCount);
+        uint32_t t = diceRngBelow(&picker, reader->games[g].turns + 1);
+        eventLogSeek(reader, g, t, &simulated);
+        checksum += packedStateHash(&simulated);
+    }
+    double seekNs = (double)(monotonicNanos() - startNs) / seekCount;
+    printf("Random seek: %.0f ns (keyframe every %u turns, checksum %016llx)\n",
+           seekNs, reader->keyframeInterval, (unsigned long long)checksum);
+
+    free(view);
+    eventLogCloseReader(reader);
+}
+
+// Function to scan every game in a log and print totals
+void runLogStats(const char *path) {
+    EventLogReader *reader = eventLogOpen(path);
+    if (!reader) return;
+
+    LogAnalytics analytics;
+    long long startNs = monotonicNanos();
+    eventLogScan(reader, &analytics);
+    double elapsed = (monotonicNanos() - startNs) / 1e9;
+
+    printf("=== EVENT LOG STATS ===\n");
+    printf("Games: %ld, turns: %ld, longest game: %ld turns\n",
+           analytics.games, analytics.turns, analytics.longestGame);
+    for (int roll = 1; roll <= 6; roll++) {
+        printf("Rolled %d: %.2f%%\n", roll,
+               analytics.turns > 0 ? 100.0 * analytics.rollCounts[roll] / analytics.turns : 0.0);
+    }
+    printf("Releases: %ld, tokens finished: %ld\n", analytics.releases, analytics.finishes);
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        printf("Player %d: %ld wins, %ld captures\n", p + 1, analytics.winsBySeat[p], analytics.captures[p]);
+    }
+    printf("Scanned %.1f MB in %.3f s (%.0f MB/s, %.0f games/sec)\n", reader->size / 1e6, elapsed,
+           elapsed > 0 ? reader->size / 1e6 / elapsed : 0.0, elapsed > 0 ? analytics.games / elapsed : 0.0);
+    eventLogCloseReader(reader);
+}
+
+// Thread function for a spectator: follows the game through the ring,
+// pausing after each batch of turns as if it were drawing them
+void *spectatorRoutine(void *arg) {
+    SpectatorThreadArgs *args = (SpectatorThreadArgs *)arg;
+    for (;;) {
+        bool over = args->gameOver->load(std::memory_order_acquire);
+        if (spectatorPoll(&args->cursor, SPECTATOR_POLL_BATCH) == 0) {
+            if (over) break; // Everything published has been seen
+            usleep(SPECTATOR_IDLE_US);
+        } else if (args->delayMicros > 0) {
+            usleep(args->delayMicros);
+        }
+    }
+    return NULL;
+}
+
+// Function to subscribe spectators to the ring and start their threads;
+// spectator i pauses i * delayMicros after each batch
+void startSpectators(SpectatorRing *ring, SpectatorThreadArgs *spectators, pthread_t *threads, int count,
+                     int delayMicros, std::atomic<bool> *gameOver) {
+    for (int i = 0; i < count; i++) {
+        spectatorSubscribe(&spectators[i].cursor, ring);
+        spectators[i].delayMicros = i * delayMicros;
+        spectators[i].gameOver = gameOver;
+        pthread_create(&threads[i], NULL, spectatorRoutine, &spectators[i]);
+    }
+}
+
+// Function to print the cost of publishing and what each spectator saw,
+// checking every spectator ended on the game's final state
+void printSpectatorStats(const SpectatorRing *ring, const SpectatorThreadArgs *spectators, int count,
+                         const PackedGameState *finalState) {
+    const Distribution *publish = &ring->publishNs;
+    printf("Spectator ring: %llu slots, %llu turns published\n", (unsigned long long)(ring->mask + 1),
+           (unsigned long long)ring->published.load());
+    printf("Publish: mean %.1f ns, p50 %lld ns, p99 %lld ns, max %lld ns\n", distributionMean(publish),
+           distributionQuantile(publish, 0.50), distributionQuantile(publish, 0.99), publish->max);
+    for (int i = 0; i < count; i++) {
+        const SpectatorCursor *cursor = &spectators[i].cursor;
+        printf("Spectator %d (pause %d us): %ld deltas, %ld resyncs, %ld turns skipped, %ld snapshot retries, "
+               "final state %s\n", i + 1, spectators[i].delayMicros, cursor->deltas, cursor->resyncs,
+               cursor->lostTurns, cursor->snapshotRetries,
+               packedStateEquals(&cursor->state, finalState) ? "matches" : "DIFFERS");
+    }
+}
+
+// Function to play turnCount turns of back-to-back packed games, publishing
+// every turn to ring (NULL = none); returns the elapsed ns
+long long playBroadcastTurns(long turnCount, uint64_t seed, SpectatorRing *ring, PackedGameState *state) {
+    OccupancyIndex occupancy;
+    DiceRng rng;
+    diceRngSeed(&rng, seed);
+    packedResetState(state);
+    occupancyClear(&occupancy);
+
+    long long startNs = monotonicNanos();
+    for (long t = 0; t < turnCount; t++) {
+        if (packedGameOver(state)) {
+            packedResetState(state);
+            occupancyClear(&occupancy);
+            if (ring) spectatorPublishNewGame(ring);
+        }
+        int roll = packedPlayTurn(state, &occupancy, &rng);
+        if (ring) spectatorPublishTurn(ring, roll, state, spectatorClockNs()); // Already packed
+    }
+    return monotonicNanos() - startNs;
+}
+
+// Function to play packed games at full speed with spectators of
+// increasing pause behind them, and measure what publishing costs
+void runSpectatorBenchmark(long turnCount, int spectatorCount, int ringSlots, int delayMicros, uint64_t seed) {
+    PackedGameState state;
+    long long plainNs = playBroadcastTurns(turnCount, seed, NULL, &state);
+
+    SpectatorRing *ring = spectatorRingCreate(ringSlots, NULL);
+    SpectatorThreadArgs spectators[MAX_SPECTATORS];
+    pthread_t threads[MAX_SPECTATORS];
+    std::atomic<bool> gameOver(false);
+    startSpectators(ring, spectators, threads, spectatorCount, delayMicros, &gameOver);
+
+    long long broadcastNs = playBroadcastTurns(turnCount, seed, ring, &state);
+    gameOver.store(true, std::memory_order_release);
+    for (int i = 0; i < spectatorCount; i++) pthread_join(threads[i], NULL);
+
+    printf("=== SPECTATOR BENCHMARK ===\n");
+    printf("Turns: %ld, %d spectators\n", turnCount, spectatorCount);
+    printf("Without spectators: %.1f ns per turn\n", turnCount > 0 ? (double)plainNs / turnCount : 0.0);
+    printf("Publishing:         %.1f ns per turn\n", turnCount > 0 ? (double)broadcastNs / turnCount : 0.0);
+    // The difference also holds the clock reads that time each publish and any time the spectators ran
+    printf("Added per turn:     %.1f ns\n", turnCount > 0 ? (double)(broadcastNs - plainNs) / turnCount : 0.0);
+    printSpectatorStats(ring, spectators, spectatorCount, &state);
+    spectatorRingDestroy(ring);
+}
+
+// Function to play packed games and save the position before every turn to a snapshot pack
+void runSnapshotRecording(const char *path, int gameCount, uint64_t baseSeed) {
+    SnapshotPackWriter *writer = snapshotPackCreate(path, true);
+    if (!writer) return;
+
+    long long startNs = monotonicNanos();
+    for (int g = 0; g < gameCount; g++) {
+        PackedGameState state;
+        OccupancyIndex occupancy;
+        DiceRng rng;
+        GameSnapshot snapshot;
+        diceRngSeed(&rng, baseSeed + g);
+        packedResetState(&state);
+        occupancyClear(&occupancy);
+
+        uint32_t turns = 0;
+        while (!packedGameOver(&state)) {
+            snapshotCapture(&snapshot, &state, &rng, turns);
+            snapshotPackAppend(writer, &snapshot);
+            packedPlayTurn(&state, &occupancy, &rng);
+            turns++;
+        }
+    }
+    double elapsed = (monotonicNanos() - startNs) / 1e9;
+
+    printf("=== SNAPSHOT PACK ===\n");
+    printf("Saved %ld positions of %d games to %s (%zu bytes each)\n", writer->snapshotCount, gameCount, path,
+           sizeof(GameSnapshot));
+    printf("Elapsed: %.3f s (%.0f snapshots/sec)\n", elapsed, elapsed > 0 ? writer->snapshotCount / elapsed : 0.0);
+    snapshotPackClose(writer);
+}
+
+// Function to walk a snapshot pack in place: position totals, restore and save
+// times on a GameContext, and a check that resuming a snapshot and playing one
+// turn gives the snapshot that follows it
+void runSnapshotStats(const char *path) {
+    SnapshotPack *pack = snapshotPackOpen(path);
+    if (!pack) return;
+
+    long finishedTokens = 0;
+    long yardTokens = 0;
+    long rankedPlayers = 0;
+    long resumeChecks = 0;
+    long resumeMismatches = 0;
+    long long startNs = monotonicNanos();
+    for (long i = 0; i < pack->count; i++) {
+        const GameSnapshot *snapshot = &pack->snapshots[i];
+        for (int t = 0; t < TOTAL_TOKENS; t++) {
+            if (snapshot->state.tokens[t] == PROGRESS_FINISHED) finishedTokens++;
+            if (snapshot->state.tokens[t] == PROGRESS_YARD) yardTokens++;
+        }
+        rankedPlayers += packedRankedCount(&snapshot->state);
+
+        if (i + 1 < pack->count && pack->snapshots[i + 1].turnsPlayed == snapshot->turnsPlayed + 1) {
+            PackedGameState state;
+            OccupancyIndex occupancy;
+            DiceRng rng;
+            GameSnapshot next;
+            snapshotRestore(snapshot, &state, &rng);
+            occupancyBuild(&occupancy, &state);
+            packedPlayTurn(&state, &occupancy, &rng);
+            snapshotCapture(&next, &state, &rng, snapshot->turnsPlayed + 1);
+            resumeChecks++;
+            if (memcmp(&next, &pack->snapshots[i + 1], sizeof(next)) != 0) resumeMismatches++;
+        }
+    }
+    double scanSeconds = (monotonicNanos() - startNs) / 1e9;
+
+    // Restore into a full GameContext and save it back; the round trip must be exact
+    GameContext *game = (GameContext *)calloc(1, sizeof(GameContext));
+    long timed = pack->count < 1000000 ? pack->count : 1000000;
+    long roundTripMismatches = 0;
+    long long restoreNs = 0;
+    long long saveNs = 0;
+    for (long i = 0; i < timed; i++) {
+        GameSnapshot saved;
+        long long beforeNs = monotonicNanos();
+        restoreGameSnapshot(game, &pack->snapshots[i]);
+        long long restoredNs = monotonicNanos();
+        saveGameSnapshot(game, &saved);
+        saveNs += monotonicNanos() - restoredNs;
+        restoreNs += restoredNs - beforeNs;
+        if (memcmp(&saved, &pack->snapshots[i], sizeof(saved)) != 0) roundTripMismatches++;
+    }
+    free(game);
+
+    long tokens = pack->count * TOTAL_TOKENS;
+    printf("=== SNAPSHOT PACK STATS ===\n");
+    printf("Snapshots: %ld (%.1f MB, version %d)\n", pack->count, pack->size / 1e6, SNAPSHOT_VERSION);
+    printf("Tokens in the yard: %.1f%%, finished: %.1f%%, ranked players per position: %.2f\n",
+           tokens > 0 ? 100.0 * yardTokens / tokens : 0.0, tokens > 0 ? 100.0 * finishedTokens / tokens : 0.0,
+           pack->count > 0 ? (double)rankedPlayers / pack->count : 0.0);
+    printf("Scanned in place in %.3f s (%.0f snapshots/sec)\n", scanSeconds,
+           scanSeconds > 0 ? pack->count / scanSeconds : 0.0);
+    printf("Resumed and played one turn: %ld checks, %ld mismatches\n", resumeChecks, resumeMismatches);
+    printf("GameContext restore: %.0f ns, save: %.0f ns, round trip mismatches: %ld of %ld\n",
+           timed > 0 ? (double)restoreNs / timed : 0.0, timed > 0 ? (double)saveNs / timed : 0.0,
+           roundTripMismatches, timed);
+    snapshotPackCloseReader(pack);
+}
+
+const char *optionValue(int argc, char *argv[], const char *name);
+
+// Function to let a human pick the move from the keyboard. The game lock is
+// released while waiting: the other seats are parked on their turn signals,
+// so nothing changes the game until the lock is taken back.
+int humanChooseMove(void *seatData, const PackedGameState *state, const OccupancyIndex *occupancy,
+                    const PackedMove *moves, int count, DiceRng *rng) {
+    (void)occupancy;
+    HumanSeat *human = (HumanSeat *)seatData;
+    GameContext *game = human->game;
+    if (count <= 1) return count - 1; // Nothing to decide
+
+    // Show the position being decided on, then the legal moves
+    renderGame(&terminalRenderer, game, true);
+    gameLog("Player %d, move which token?", state->currentTurn + 1);
+    for (int i = 0; i < count; i++) {
+        gameLog("  %d: %d -> %d%s", moves[i].token + 1, moves[i].from, moves[i].to,
+                (moves[i].flags & MOVE_CAPTURE) ? " capture" : "");
+    }
+    if (human->timeoutMs > 0) gameLog("  (%d s)", (human->timeoutMs + 999) / 1000);
+    gameLog("\n");
+    fflush(stdout);
+
+    terminalDiscardInput(&terminalSession);
+    instrumentedUnlock(&game->gameStatus.mutexLock);
+
+    int choice = -1;
+    long long deadlineNs = monotonicNanos() + (long long)human->timeoutMs * 1000000LL;
+    while (choice < 0) {
+        int waitMs = -1;
+        if (human->timeoutMs > 0) {
+            long long leftNs = deadlineNs - monotonicNanos();
+            if (leftNs <= 0) break;
+            waitMs = (int)((leftNs + 999999) / 1000000);
+        }
+        int key = terminalReadKey(&terminalSession, waitMs);
+        if (key < 0) break;
+        for (int i = 0; i < count; i++) {
+            if (key == '1' + moves[i].token) choice = i;
+        }
+    }
+
+    instrumentedLock(&game->gameStatus.mutexLock);
+    human->prompts++;
+    if (choice >= 0) {
+        terminalKeyUsed(&terminalSession);
+        return choice;
+    }
+    human->automaticMoves++;
+    gameLog("No answer from Player %d, moving automatically.\n", state->currentTurn + 1);
+    return chooseRandomMove(moves, count, rng);
+}
+
+// Function to print how the human seats played and how quickly their moves reached the screen
+void printHumanStats(const HumanSeat humans[MAX_PLAYERS]) {
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        if (!humans[p].game) continue;
+        printf("Human seat %d: %ld moves chosen, %ld automatic\n", p + 1,
+               humans[p].prompts - humans[p].automaticMoves, humans[p].automaticMoves);
+    }
+    printf("Keys read: %ld, timeouts: %ld\n", terminalSession.keysRead, terminalSession.timeouts);
+    if (terminalSession.keyFrames > 0) {
+        printf("Key to frame: avg %.1f us, max %.1f us\n",
+               terminalSession.keyToFrameTotalNs / 1000.0 / terminalSession.keyFrames,
+               terminalSession.keyToFrameMaxNs / 1000.0);
+    }
+}
+
+// Function to put humans on the seats listed by --human-seats (e.g. "1,3") and
+// start reading the keyboard. Returns the number of human seats.
+int setupHumanSeats(int argc, char *argv[], GameContext *game, HumanSeat humans[MAX_PLAYERS]) {
+    const char *seatList = optionValue(argc, argv, "--human-seats");
+    if (!seatList) return 0;
+
+    const char *timeout = optionValue(argc, argv, "--turn-timeout-ms");
+    int humanCount = 0;
+    for (const char *c = seatList; *c; c++) {
+        int seat = *c - '1';
+        if (seat < 0 || seat >= MAX_PLAYERS) continue;
+
+        humans[seat].game = game;
+        humans[seat].timeoutMs = timeout ? atoi(timeout) : HUMAN_TURN_TIMEOUT_MS;
+        game->seats.choose[seat] = humanChooseMove;
+        game->seats.seatData[seat] = &humans[seat];
+        humanCount++;
+    }
+    if (humanCount > 0 && !terminalSessionBegin(&terminalSession, STDIN_FILENO)) return 0;
+    return humanCount;
+}
+
+// Function to put the rollout AI on the seats listed by --ai-seats (e.g. "1,3").
+// Returns the AI, or NULL if no seat uses it.
+RolloutAI *setupAISeats(int argc, char *argv[], SeatTable *seats, const char *defaultSeats, uint64_t seed) {
+    const char *seatList = optionValue(argc, argv, "--ai-seats");
+    if (!seatList) seatList = defaultSeats;
+    if (!seatList) return NULL;
+
+    const char *playouts = optionValue(argc, argv, "--ai-playouts");
+    const char *timeMicros = optionValue(argc, argv, "--ai-time-us");
+    const char *workers = optionValue(argc, argv, "--ai-workers");
+    RolloutAI *ai = NULL;
+
+    for (const char *c = seatList; *c; c++) {
+        int seat = *c - '1';
+        if (seat < 0 || seat >= MAX_PLAYERS) continue;
+
+        if (!ai) {
+            ai = rolloutCreate(workers ? atoi(workers) : (int)sysconf(_SC_NPROCESSORS_ONLN),
+                               playouts ? atol(playouts) : (timeMicros ? 0 : 256),
+                               timeMicros ? atol(timeMicros) : 0, seed ^ 0xA1A1A1A1ULL);
+        }
+        seats->choose[seat] = rolloutChooseMove;
+        seats->seatData[seat] = ai;
+    }
+    return ai;
+}
+
+// Function to create searchers on the seats listed by --search-seats (e.g. "2").
+// All of them share one transposition table; returns it, or NULL if no seat searches.
+TranspositionTable *setupSearchSeats(int argc, char *argv[], const char *defaultSeats,
+                                     bool searchSeats[MAX_PLAYERS], ExpectiSearcher *searcher) {
+    const char *seatList = optionValue(argc, argv, "--search-seats");
+    if (!seatList) seatList = defaultSeats;
+    if (!seatList) return NULL;
+
+    const char *depth = optionValue(argc, argv, "--search-depth");
+    const char *timeMicros = optionValue(argc, argv, "--search-time-us");
+    const char *tableMB = optionValue(argc, argv, "--tt-mb");
+    bool anySeat = false;
+    for (const char *c = seatList; *c; c++) {
+        int seat = *c - '1';
+        if (seat >= 0 && seat < MAX_PLAYERS) searchSeats[seat] = anySeat = true;
+    }
+    if (!anySeat) return NULL;
+
+    TranspositionTable *tt = ttCreate(tableMB ? atoi(tableMB) : 64);
+    searcherInit(searcher, tt, depth ? atoi(depth) : 5, timeMicros ? atol(timeMicros) : 0);
+    return tt;
+}
+
+// Function to get the score a strategy gives the move it chose, for the decision cache
+DecisionScore decisionScoreFor(MoveChooser choose) {
+    if (choose == rolloutChooseMove) return rolloutLastScore;
+    if (choose == expectiChooseMove) return expectiLastScore;
+    return NULL;
+}
+
+// Function to create the decision cache asked for with --decision-cache-mb n; NULL if not asked
+DecisionCache *setupDecisionCache(int argc, char *argv[]) {
+    const char *cacheMB = optionValue(argc, argv, "--decision-cache-mb");
+    return cacheMB ? decisionCacheCreate(atoi(cacheMB)) : NULL;
+}
+
+// Pool task that plays a slice of search match games with the worker's searcher
+void playSearchMatchBatch(void *arg, int workerID) {
+    SearchMatchBatch *batch = (SearchMatchBatch *)arg;
+    SeatTable seats;
+    memset(&seats, 0, sizeof(seats));
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        if (batch->searchSeats[p]) {
+            seats.choose[p] = expectiChooseMove;
+            seats.seatData[p] = &batch->searchers[workerID];
+        }
+    }
+    DecisionCacheSeat cacheSeats[MAX_PLAYERS];
+    if (batch->decisionCache) decisionCacheWrapSeats(batch->decisionCache, &seats, cacheSeats, decisionScoreFor);
+
+    for (int g = batch->games.firstGame; g < batch->games.firstGame + batch->games.gameCount; g++) {
+        GameResult *result = &batch->games.results[g];
+        PackedGameState state;
+        OccupancyIndex occupancy;
+        DiceRng rng;
+        diceRngSeed(&rng, batch->games.baseSeed + g);
+        packedResetState(&state);
+        occupancyClear(&occupancy);
+
+        result->turns = 0;
+        while (!packedGameOver(&state)) {
+            packedPlaySeatedTurn(&state, &occupancy, &rng, &seats);
+            result->turns++;
+        }
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            result->playerRanks[p] = packedRank(&state, p);
+            result->killCounts[p] = state.killCounts[p];
+        }
+    }
+}
+
+// Function to play seeded games with search seats on a work-stealing pool,
+// all workers sharing one transposition table, and compare with random seats
+void runSearchMatch(int gameCount, int workerCount, int argc, char *argv[], uint64_t baseSeed) {
+    headlessMode = true;
+    if (workerCount < 1) workerCount = 1;
+
+    bool searchSeats[MAX_PLAYERS] = {false};
+    ExpectiSearcher settings;
+    TranspositionTable *tt = setupSearchSeats(argc, argv, "1", searchSeats, &settings);
+    if (!tt) {
+        printf("No search seats\n");
+        return;
+    }
+
+    ExpectiSearcher *searchers = (ExpectiSearcher *)calloc(workerCount, sizeof(ExpectiSearcher));
+    for (int i = 0; i < workerCount; i++) searchers[i] = settings;
+    DecisionCache *decisionCache = setupDecisionCache(argc, argv);
+
+    GameResult *results = (GameResult *)calloc(gameCount, sizeof(GameResult));
+    int batchCount = gameCount; // One game per task: searched games vary a lot in cost
+    SearchMatchBatch *batches = (SearchMatchBatch *)calloc(batchCount, sizeof(SearchMatchBatch));
+
+    long long startNs = monotonicNanos();
+    WorkStealingPool *pool = poolCreate(workerCount);
+    for (int b = 0; b < batchCount; b++) {
+        batches[b].games.results = results;
+        batches[b].games.firstGame = b;
+        batches[b].games.gameCount = 1;
+        batches[b].games.baseSeed = baseSeed;
+        memcpy(batches[b].searchSeats, searchSeats, sizeof(searchSeats));
+        batches[b].searchers = searchers;
+        batches[b].decisionCache = decisionCache;
+        poolSubmit(pool, playSearchMatchBatch, &batches[b]);
+    }
+    poolRun(pool);
+    poolDestroy(pool);
+    double elapsed = (monotonicNanos() - startNs) / 1e9;
+
+    GameResult *baseline = runTournament(gameCount, workerCount, baseSeed);
+    int searchWins[MAX_PLAYERS] = {0};
+    int randomWins[MAX_PLAYERS] = {0};
+    for (int g = 0; g < gameCount; g++) {
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            if (results[g].playerRanks[p] == 1) searchWins[p]++;
+            if (baseline[g].playerRanks[p] == 1) randomWins[p]++;
+        }
+    }
+
+    ExpectiSearcher total;
+    searcherInit(&total, tt, 1, 0);
+    for (int i = 0; i < workerCount; i++) searcherMergeStats(&total, &searchers[i]);
+    // Node rate per worker thread: searchNs adds up the time of every worker
+    printf("=== SEARCH MATCH ===\n");
+    printf("Games played: %d on %d workers, seed %llu, depth limit %d turns\n", gameCount, workerCount,
+           (unsigned long long)baseSeed, settings.maxDepth);
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        printf("Player %d (%s): %.1f%% wins, %.1f%% with a random seat\n", p + 1,
+               searchSeats[p] ? "search" : "random", 100.0 * searchWins[p] / gameCount,
+               100.0 * randomWins[p] / gameCount);
+    }
+    searcherPrintStats(&total, tt);
+    if (decisionCache) decisionCachePrintStats(decisionCache);
+    printf("Elapsed: %.3f s\n", elapsed);
+
+    free(baseline);
+    free(results);
+    free(batches);
+    free(searchers);
+    ttDestroy(tt);
+    decisionCacheDestroy(decisionCache);
+}
+
+// Function to play the same seeded games with and without AI seats and
+// compare the win rate of every seat
+void runAIMatch(int gameCount, int argc, char *argv[], uint64_t baseSeed) {
+    headlessMode = true;
+    SeatTable seats;
+    memset(&seats, 0, sizeof(seats));
+    RolloutAI *ai = setupAISeats(argc, argv, &seats, "1", baseSeed);
+    if (!ai) {
+        printf("No AI seats\n");
+        return;
+    }
+    DecisionCache *decisionCache = setupDecisionCache(argc, argv);
+    DecisionCacheSeat cacheSeats[MAX_PLAYERS];
+    if (decisionCache) decisionCacheWrapSeats(decisionCache, &seats, cacheSeats, decisionScoreFor);
+
+    int aiWins[MAX_PLAYERS] = {0};
+    int randomWins[MAX_PLAYERS] = {0};
+    long long startNs = monotonicNanos();
+    for (int g = 0; g < gameCount; g++) {
+        PackedGameState state;
+        OccupancyIndex occupancy;
+        DiceRng rng;
+
+        diceRngSeed(&rng, baseSeed + g);
+        packedResetState(&state);
+        occupancyClear(&occupancy);
+        while (!packedGameOver(&state)) packedPlaySeatedTurn(&state, &occupancy, &rng, &seats);
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            if (packedRank(&state, p) == 1) aiWins[p]++;
+        }
+
+        diceRngSeed(&rng, baseSeed + g);
+        playPackedGame(&state, &rng);
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            if (packedRank(&state, p) == 1) randomWins[p]++;
+        }
+    }
+    double elapsed = (monotonicNanos() - startNs) / 1e9;
+
+    printf("=== AI MATCH ===\n");
+    printf("Games played: %d, seed %llu\n", gameCount, (unsigned long long)baseSeed);
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        printf("Player %d (%s): %.1f%% wins, %.1f%% with a random seat\n", p + 1,
+               seats.choose[p] ? "AI" : "random", 100.0 * aiWins[p] / gameCount, 100.0 * randomWins[p] / gameCount);
+    }
+    rolloutPrintStats(ai);
+    if (decisionCache) decisionCachePrintStats(decisionCache);
+    printf("Elapsed: %.3f s\n", elapsed);
+    rolloutDestroy(ai);
+    decisionCacheDestroy(decisionCache);
+}
+
+static GameServer *runningServer = NULL;
+
+static void stopServerOnSignal(int) {
+    if (runningServer) serverRequestStop(runningServer);
+}
+
+// Function to serve games until interrupted
+void runServer(const char *address, int loopCount, uint64_t seed) {
+    runningServer = serverStart(address, loopCount, seed);
+    if (!runningServer) return;
+
+    signal(SIGINT, stopServerOnSignal);
+    signal(SIGTERM, stopServerOnSignal);
+    printf("Serving games on %s with %d event loops, Ctrl-C to stop\n", runningServer->address,
+           runningServer->loopCount);
+    serverWait(runningServer);
+
+    serverPrintStats(runningServer);
+    serverStop(runningServer);
+    runningServer = NULL;
+}
+
+// Function to drive a server with the load client, starting one in-process
+// on a temporary Unix socket unless an address is given
+void runLoadTest(int gameCount, int connectionCount, int argc, char *argv[], uint64_t seed) {
+    const char *concurrentOption = optionValue(argc, argv, "--concurrent");
+    const char *seatsOption = optionValue(argc, argv, "--client-seats");
+    const char *loopsOption = optionValue(argc, argv, "--loops");
+    int concurrentGames = concurrentOption ? atoi(concurrentOption) : 64;
+    int seatsPerGame = seatsOption ? atoi(seatsOption) : MAX_PLAYERS;
+
+    const char *address = optionValue(argc, argv, "--connect");
+    GameServer *server = NULL;
+    char socketPath[64];
+    if (!address) {
+        snprintf(socketPath, sizeof(socketPath), "/tmp/ludo-load-%d.sock", (int)getpid());
+        server = serverStart(socketPath, loopsOption ? atoi(loopsOption) : 1, seed);
+        if (!server) return;
+        address = socketPath;
+    }
+
+    if (!runLoadClient(address, gameCount, connectionCount, concurrentGames, seatsPerGame, seed ^ 0x5DEECE66DULL)) {
+        printf("Load test against %s did not complete\n", address);
+    }
+    if (server) {
+        serverRequestStop(server);
+        serverWait(server);
+        serverPrintStats(server);
+        serverStop(server);
+    }
+}
+
+// Function to check whether a command-line flag is present
+bool hasOption(int argc, char *argv[], const char *name) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], name) == 0) return true;
+    }
+    return false;
+}
+
+// Function to get the value following a command-line option, or NULL
+const char *optionValue(int argc, char *argv[], const char *name) {
+    for (int i = 1; i < argc - 1; i++) {
+        if (strcmp(argv[i], name) == 0) return argv[i + 1];
+    }
+    return NULL;
+}
+
+// The benchmark binary (benchmark.cpp) builds these sources with its own main()
+#ifndef LUDO_BENCHMARK
+int main(int argc, char *argv[]) {
+    // Every mode accepts --seed <n> to replay a run exactly
+    const char *seedOption = optionValue(argc, argv, "--seed");
+    uint64_t seed = seedOption ? strtoull(seedOption, NULL, 10) : (uint64_t)time(NULL);
 
     // Initialize game components
     initializeBoardPath();
-    initializeBoard();
-    setupPlayers();
-    displayBoard();
+
+    // Headless batch mode: ./final --headless [games] [--context | --lanes] [--players 2|4|6]
+    if (argc > 1 && strcmp(argv[1], "--headless") == 0) {
+        int gameCount = (argc > 2 && argv[2][0] != '-') ? atoi(argv[2]) : 100000;
+        const char *playersOption = optionValue(argc, argv, "--players");
+        int players = playersOption ? atoi(playersOption) : MAX_PLAYERS;
+        if (players == 2) {
+            runVariantBatch<TwoPlayerRules>(gameCount, seed);
+        } else if (players == 6) {
+            runVariantBatch<SixPlayerRules>(gameCount, seed);
+        } else if (hasOption(argc, argv, "--lanes")) {
+            runLaneBatch(gameCount, seed);
+        } else {
+            runHeadlessBatch(gameCount, hasOption(argc, argv, "--context"), seed);
+        }
+        return 0;
+    }
+
+    // Packed engine check: ./final --verify-packed [games]
+    if (argc > 1 && strcmp(argv[1], "--verify-packed") == 0) {
+        runPackedVerification((argc > 2 && argv[2][0] != '-') ? atoi(argv[2]) : 1000, seed);
+        return 0;
+    }
+
+    // Tournament mode: ./final --tournament [games] [workers]
+    if (argc > 1 && strcmp(argv[1], "--tournament") == 0) {
+        int gameCount = (argc > 2 && argv[2][0] != '-') ? atoi(argv[2]) : 100000;
+        int workerCount = (argc > 3 && argv[3][0] != '-') ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+        runTournamentReport(gameCount, workerCount, seed);
+        return 0;
+    }
+
+    // Coroutine games: ./final --coroutines [games] [workers] [--concurrent n]
+    if (argc > 1 && strcmp(argv[1], "--coroutines") == 0) {
+#ifdef CORO_SCHEDULER_AVAILABLE
+        long gameCount = (argc > 2 && argv[2][0] != '-') ? atol(argv[2]) : 20000;
+        int workerCount = (argc > 3 && argv[3][0] != '-') ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+        const char *concurrent = optionValue(argc, argv, "--concurrent");
+        runCoroutineGames(gameCount, workerCount, concurrent ? atoi(concurrent) : 4096, seed);
+        return 0;
+#else
+        fprintf(stderr, "Coroutine games need a C++20 build (g++ -std=c++20)\n");
+        return 1;
+#endif
+    }
+
+    // Endgame tablebase: ./final --build-tablebase <file> [workers]
+    if (argc > 2 && strcmp(argv[1], "--build-tablebase") == 0) {
+        int workerCount = (argc > 3 && argv[3][0] != '-') ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+        return tablebaseGenerate(argv[2], workerCount) ? 0 : 1;
+    }
+
+    // Endgame tablebase in play: ./final --tablebase-match <file> [games]
+    if (argc > 2 && strcmp(argv[1], "--tablebase-match") == 0) {
+        runTablebaseMatch(argv[2], (argc > 3 && argv[3][0] != '-') ? atoi(argv[3]) : 100000, seed);
+        return 0;
+    }
+
+    // Statistics run: ./final --stats [games] [workers] [--players 2|4|6] [--csv file] [--json file]
+    if (argc > 1 && strcmp(argv[1], "--stats") == 0) {
+        long gameCount = (argc > 2 && argv[2][0] != '-') ? atol(argv[2]) : 100000;
+        int workerCount = (argc > 3 && argv[3][0] != '-') ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+        const char *playersOption = optionValue(argc, argv, "--players");
+        const char *csvPath = optionValue(argc, argv, "--csv");
+        const char *jsonPath = optionValue(argc, argv, "--json");
+        int players = playersOption ? atoi(playersOption) : MAX_PLAYERS;
+        if (players == 2) {
+            runStatsReport<TwoPlayerRules>(gameCount, workerCount, seed, csvPath, jsonPath);
+        } else if (players == 6) {
+            runStatsReport<SixPlayerRules>(gameCount, workerCount, seed, csvPath, jsonPath);
+        } else {
+            runStatsReport<StandardRules>(gameCount, workerCount, seed, csvPath, jsonPath);
+        }
+        return 0;
+    }
+
+    // Turn handoff benchmark: ./final --handoff-bench [turns] [--polling]
+    if (argc > 1 && strcmp(argv[1], "--handoff-bench") == 0) {
+        long turnCount = (argc > 2 && argv[2][0] != '-') ? atol(argv[2]) : 1000;
+        runHandoffBenchmark(turnCount, hasOption(argc, argv, "--polling"), seed);
+        return 0;
+    }
+
+    // Spectator ring benchmark: ./final --spectator-bench [turns] [spectators] [--ring-slots n]
+    //                           [--spectator-delay-us us]
+    if (argc > 1 && strcmp(argv[1], "--spectator-bench") == 0) {
+        long turnCount = (argc > 2 && argv[2][0] != '-') ? atol(argv[2]) : 10000000;
+        int spectatorCount = (argc > 3 && argv[3][0] != '-') ? atoi(argv[3]) : 4;
+        const char *slotsOption = optionValue(argc, argv, "--ring-slots");
+        const char *delayOption = optionValue(argc, argv, "--spectator-delay-us");
+        if (spectatorCount > MAX_SPECTATORS) spectatorCount = MAX_SPECTATORS;
+        runSpectatorBenchmark(turnCount, spectatorCount, slotsOption ? atoi(slotsOption) : SPECTATOR_RING_SLOTS,
+                              delayOption ? atoi(delayOption) : 100, seed);
+        return 0;
+    }
+
+    // Event log: ./final --record-log <file> [games], --replay <file> [game] [turn], --log-stats <file>
+    if (argc > 2 && strcmp(argv[1], "--record-log") == 0) {
+        runLogRecording(argv[2], (argc > 3 && argv[3][0] != '-') ? atoi(argv[3]) : 10000, seed);
+        return 0;
+    }
+    if (argc > 2 && strcmp(argv[1], "--replay") == 0) {
+        runLogReplay(argv[2], (argc > 3 && argv[3][0] != '-') ? atol(argv[3]) : 0,
+                     (argc > 4 && argv[4][0] != '-') ? atol(argv[4]) : -1);
+        return 0;
+    }
+    if (argc > 2 && strcmp(argv[1], "--log-stats") == 0) {
+        runLogStats(argv[2]);
+        return 0;
+    }
+
+    // AI evaluation: ./final --ai-match [games] [--ai-seats 1,3] [--ai-playouts n] [--ai-time-us n] [--ai-workers n]
+    //                 [--decision-cache-mb n]
+    if (argc > 1 && strcmp(argv[1], "--ai-match") == 0) {
+        runAIMatch((argc > 2 && argv[2][0] != '-') ? atoi(argv[2]) : 100, argc, argv, seed);
+        return 0;
+    }
+
+    // Search evaluation: ./final --search-match [games] [workers] [--search-seats 1] [--search-depth n]
+    //                     [--search-time-us n] [--tt-mb n] [--decision-cache-mb n]
+    if (argc > 1 && strcmp(argv[1], "--search-match") == 0) {
+        int gameCount = (argc > 2 && argv[2][0] != '-') ? atoi(argv[2]) : 100;
+        int workerCount = (argc > 3 && argv[3][0] != '-') ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+        runSearchMatch(gameCount, workerCount, argc, argv, seed);
+        return 0;
+    }
+
+    // Snapshot packs: ./final --record-snapshots <file> [games], --snapshot-stats <file>
+    if (argc > 2 && strcmp(argv[1], "--record-snapshots") == 0) {
+        runSnapshotRecording(argv[2], (argc > 3 && argv[3][0] != '-') ? atoi(argv[3]) : 10000, seed);
+        return 0;
+    }
+    if (argc > 2 && strcmp(argv[1], "--snapshot-stats") == 0) {
+        runSnapshotStats(argv[2]);
+        return 0;
+    }
+
+    // Render benchmark: ./final --render-bench [turns]
+    if (argc > 1 && strcmp(argv[1], "--render-bench") == 0) {
+        runRenderBenchmark((argc > 2 && argv[2][0] != '-') ? atol(argv[2]) : 10000, seed);
+        return 0;
+    }
+
+    // Game server: ./final --serve [port or socket path] [--loops n]
+    if (argc > 1 && strcmp(argv[1], "--serve") == 0) {
+        const char *loopsOption = optionValue(argc, argv, "--loops");
+        runServer((argc > 2 && argv[2][0] != '-') ? argv[2] : "7777", loopsOption ? atoi(loopsOption) : 1, seed);
+        return 0;
+    }
+
+    // Server load test: ./final --load-test [games] [connections] [--concurrent n] [--client-seats n]
+    //                   [--connect address] [--loops n]
+    if (argc > 1 && strcmp(argv[1], "--load-test") == 0) {
+        int gameCount = (argc > 2 && argv[2][0] != '-') ? atoi(argv[2]) : 10000;
+        int connectionCount = (argc > 3 && argv[3][0] != '-') ? atoi(argv[3]) : 4;
+        runLoadTest(gameCount, connectionCount, argc, argv, seed);
+        return 0;
+    }
+
+    GameContext *game = (GameContext *)calloc(1, sizeof(GameContext));
+    diceRngSeed(&game->rng, seed);
+    resetGame(game);
+
+    // Resume a checkpointed game: ./final --resume <pack> [--resume-index n] (default: last snapshot)
+    const char *resumePath = optionValue(argc, argv, "--resume");
+    if (resumePath) {
+        SnapshotPack *pack = snapshotPackOpen(resumePath);
+        if (!pack) return 1;
+        const char *indexOption = optionValue(argc, argv, "--resume-index");
+        long index = indexOption ? atol(indexOption) : pack->count - 1;
+        if (index < 0 || index >= pack->count) {
+            printf("Snapshot %ld not found (%ld snapshots in %s)\n", index, pack->count, resumePath);
+            snapshotPackCloseReader(pack);
+            return 1;
+        }
+        restoreGameSnapshot(game, &pack->snapshots[index]);
+        printf("Resuming from snapshot %ld: turn %u, player %d to move\n", index,
+               pack->snapshots[index].turnsPlayed, game->gameStatus.currentTurn);
+        snapshotPackCloseReader(pack);
+    }
+    rendererInit(&terminalRenderer, STDOUT_FILENO, MAX_FRAMES_PER_SECOND, true);
+    displayBoard(game);
+
+    // AI seats in the threaded game: ./final --ai-seats 1,3
+    RolloutAI *ai = setupAISeats(argc, argv, &game->seats, NULL, seed);
+
+    // Search seats in the threaded game: ./final --search-seats 2
+    bool searchSeats[MAX_PLAYERS] = {false};
+    ExpectiSearcher searcher;
+    TranspositionTable *tt = setupSearchSeats(argc, argv, NULL, searchSeats, &searcher);
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        if (searchSeats[p]) {
+            game->seats.choose[p] = expectiChooseMove;
+            game->seats.seatData[p] = &searcher;
+        }
+    }
+
+    // Decisions of the AI and search seats cached: ./final --decision-cache-mb n
+    DecisionCache *decisionCache = setupDecisionCache(argc, argv);
+    DecisionCacheSeat cacheSeats[MAX_PLAYERS];
+    if (decisionCache) decisionCacheWrapSeats(decisionCache, &game->seats, cacheSeats, decisionScoreFor);
+
+    // Human seats in the threaded game: ./final --human-seats 1 [--turn-timeout-ms n]
+    HumanSeat humans[MAX_PLAYERS];
+    memset(humans, 0, sizeof(humans));
+    int humanCount = setupHumanSeats(argc, argv, game, humans);
+
+    // Threaded game with a turn log: ./final --log <file>
+    const char *logPath = optionValue(argc, argv, "--log");
+    if (logPath) {
+        eventLog = eventLogCreate(logPath, DEFAULT_KEYFRAME_INTERVAL);
+        if (eventLog) eventLogBeginGame(eventLog, 0, seed);
+    }
+
+    // Threaded game saved after every turn: ./final --checkpoint <pack>
+    const char *checkpointPath = optionValue(argc, argv, "--checkpoint");
+    if (checkpointPath) {
+        checkpointPack = snapshotPackCreate(checkpointPath, true);
+        if (!checkpointPack) return 1;
+    }
+
+    // Threaded game watched through the broadcast ring: ./final --spectators n [--spectator-delay-us us]
+    const char *spectatorsOption = optionValue(argc, argv, "--spectators");
+    const char *spectatorDelayOption = optionValue(argc, argv, "--spectator-delay-us");
+    int spectatorCount = spectatorsOption ? atoi(spectatorsOption) : 0;
+    if (spectatorCount > MAX_SPECTATORS) spectatorCount = MAX_SPECTATORS;
+    SpectatorThreadArgs spectators[MAX_SPECTATORS];
+    pthread_t spectatorThreads[MAX_SPECTATORS];
+    std::atomic<bool> spectatorsDone(false);
+    if (spectatorCount > 0) {
+        PackedGameState start;
+        packGameState(game, &start); // A resumed game starts mid-way
+        spectatorRing = spectatorRingCreate(SPECTATOR_RING_SLOTS, &start);
+        startSpectators(spectatorRing, spectators, spectatorThreads, spectatorCount,
+                        spectatorDelayOption ? atoi(spectatorDelayOption) : 0, &spectatorsDone);
+    }
 
     // Initialize threading
     pthread_t playerThreads[MAX_PLAYERS];
+    PlayerThreadArgs threadArgs[MAX_PLAYERS];
     pthread_t monitorThread;
-    pthread_mutex_init(&gameStatus.mutexLock, NULL);
+    initializeTurnSync(game);
 
-    gameStatus.currentTurn = 1;
+    game->gameStatus.turnDelayMicros = TURN_DELAY_US;
 
     // Start the game monitor thread
-    pthread_create(&monitorThread, NULL, gameMonitor, NULL);
+    pthread_create(&monitorThread, NULL, gameMonitor, game);
 
     // Start player threads
     for (int i = 0; i < MAX_PLAYERS; i++) {
-        pthread_create(&playerThreads[i], NULL, playerRoutine, &playersList[i]);
+        threadArgs[i].game = game;
+        threadArgs[i].player = &game->playersList[i];
+        pthread_create(&playerThreads[i], NULL, playerRoutine, &threadArgs[i]);
     }
 
     // Wait for all player threads to finish
@@ -713,8 +2493,42 @@ int main() {
     }
 
     // Clean up
-    pthread_cancel(monitorThread);
-    pthread_mutex_destroy(&gameStatus.mutexLock);
+    pthread_join(monitorThread, NULL);
+    if (spectatorRing) {
+        spectatorsDone.store(true, std::memory_order_release);
+        for (int i = 0; i < spectatorCount; i++) pthread_join(spectatorThreads[i], NULL);
+        PackedGameState finalState;
+        packGameState(game, &finalState);
+        printSpectatorStats(spectatorRing, spectators, spectatorCount, &finalState);
+        spectatorRingDestroy(spectatorRing);
+        spectatorRing = NULL;
+    }
+    rendererShutdown(&terminalRenderer);
+    terminalSessionEnd(&terminalSession);
+    eventLogClose(eventLog);
+    snapshotPackClose(checkpointPack);
+
+    // Instrumentation of every thread, written once all of them have finished
+    const char *instrumentPath = optionValue(argc, argv, "--instrument-json");
+    if (instrumentPath && instrumentWriteJson(instrumentPath)) {
+        printf("Instrumentation written to %s\n", instrumentPath);
+    }
+    if (ai) {
+        rolloutPrintStats(ai);
+        rolloutDestroy(ai);
+    }
+    if (tt) {
+        searcherPrintStats(&searcher, tt);
+        ttDestroy(tt);
+    }
+    if (decisionCache) {
+        decisionCachePrintStats(decisionCache);
+        decisionCacheDestroy(decisionCache);
+    }
+    if (humanCount > 0) printHumanStats(humans);
+    destroyTurnSync(game);
+    free(game);
 
     return 0;
-}
\ No newline at end of file
+}
+#endif
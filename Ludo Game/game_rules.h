@@ -0,0 +1,166 @@
+#ifndef GAME_RULES_H
+#define GAME_RULES_H
+
+#include <stdint.h>
+#include "route_tables.h"
+
+/*
+ * Rule variants for the packed engine.
+ * A rules type fixes the number of players, tokens, track and home path
+ * cells at compile time, and says where each seat starts, where it turns
+ * into its home path and which track cells are safe. The engine in
+ * packed_state.h is templated on it, so every variant gets its own tables
+ * (RuleRoutes, generated by constexpr) and its own code with the loop
+ * bounds and moduli folded in.
+ *
+ *   StandardRules  - the 4-player game on the 15x15 board (board_layout.h)
+ *   TwoPlayerRules - Blue and Green, opposite corners of the same board
+ *   SixPlayerRules - 6 players on a 78-cell ring, 13 cells apart
+ *
+ * Progress keeps the meaning it has in route_tables.h: 0 is the yard,
+ * 1..trackLength the track from the seat's start cell, then the home path.
+ */
+
+// Smallest unsigned type holding a number of bits
+template <int Bits> struct UnsignedBits { typedef uint64_t type; };
+template <> struct UnsignedBits<8> { typedef uint8_t type; };
+template <> struct UnsignedBits<16> { typedef uint16_t type; };
+template <> struct UnsignedBits<32> { typedef uint32_t type; };
+
+constexpr int roundBits(int bits) {
+    return bits <= 8 ? 8 : bits <= 16 ? 16 : bits <= 32 ? 32 : 64;
+}
+
+template <int Players, int Tokens, int Track, int HomePath>
+struct RulesBase {
+    static constexpr int players = Players;
+    static constexpr int tokensPerPlayer = Tokens;
+    static constexpr int totalTokens = Players * Tokens;
+    static constexpr int trackLength = Track;
+    static constexpr int homePathLength = HomePath;
+    static constexpr int progressHome = PROGRESS_TRACK + Track;          // First home path cell
+    static constexpr int progressFinished = progressHome + HomePath - 1; // Last home path cell
+    static constexpr int progressCount = progressFinished + 1;
+
+    typedef typename UnsignedBits<roundBits(Players * Tokens)>::type TokenMask; // One bit per token
+    typedef typename UnsignedBits<roundBits(2 * Players)>::type SixMask;       // 2 bits per player
+    typedef typename UnsignedBits<roundBits(4 * Players)>::type RankMask;      // 4 bits per player
+
+    static constexpr bool onTrack(int progress) {
+        return progress >= PROGRESS_TRACK && progress < progressHome;
+    }
+    static constexpr bool inHomePath(int progress) {
+        return progress >= progressHome;
+    }
+};
+
+struct StandardRules : RulesBase<MAX_PLAYERS, TOKENS_PER_PLAYER, TRACK_LENGTH, HOME_PATH_LENGTH> {
+    static constexpr int startIndex(int seat) {
+        return routeTables.trackIndex[seat][PROGRESS_TRACK];
+    }
+    static constexpr bool entersHome(int seat, int progress) {
+        return routeTables.canEnterHome[seat][progress];
+    }
+    static constexpr bool isSafe(int trackIndex) {
+        return routeTables.safeTrack[trackIndex];
+    }
+};
+
+struct TwoPlayerRules : RulesBase<2, TOKENS_PER_PLAYER, TRACK_LENGTH, HOME_PATH_LENGTH> {
+    static constexpr int boardSeat(int seat) {
+        return seat * 2;
+    }
+    static constexpr int startIndex(int seat) {
+        return routeTables.trackIndex[boardSeat(seat)][PROGRESS_TRACK];
+    }
+    static constexpr bool entersHome(int seat, int progress) {
+        return routeTables.canEnterHome[boardSeat(seat)][progress];
+    }
+    static constexpr bool isSafe(int trackIndex) {
+        return routeTables.safeTrack[trackIndex];
+    }
+};
+
+struct SixPlayerRules : RulesBase<6, TOKENS_PER_PLAYER, 78, HOME_PATH_LENGTH> {
+    static constexpr int armLength = trackLength / players;
+
+    static constexpr int startIndex(int seat) {
+        return seat * armLength;
+    }
+    // The last two cells before the start lead into the home path
+    static constexpr bool entersHome(int /* seat */, int progress) {
+        return progress >= progressHome - 2 && progress < progressHome;
+    }
+    // Start cells and the eighth cell of every arm
+    static constexpr bool isSafe(int trackIndex) {
+        return trackIndex % armLength == 0 || trackIndex % armLength == 8;
+    }
+};
+
+// Route tables of a variant: the same lookups route_tables.h gives the board
+template <typename Rules>
+struct RuleRoutes {
+    uint8_t trackIndex[Rules::players][Rules::progressCount]; // Track index for track progress
+    uint8_t target[Rules::players][Rules::progressCount][7];  // Progress after rolling 1..6, or NO_MOVE
+    bool safeTrack[Rules::trackLength];                       // Track indexes of the safe cells
+};
+
+template <typename Rules>
+constexpr RuleRoutes<Rules> buildRuleRoutes() {
+    RuleRoutes<Rules> routes = {};
+
+    for (int i = 0; i < Rules::trackLength; i++) {
+        routes.safeTrack[i] = Rules::isSafe(i);
+    }
+    for (int p = 0; p < Rules::players; p++) {
+        for (int step = 0; step < Rules::trackLength; step++) {
+            routes.trackIndex[p][PROGRESS_TRACK + step] = (uint8_t)((Rules::startIndex(p) + step) % Rules::trackLength);
+        }
+
+        // Landing progress for every roll: a six only releases, other rolls only move
+        for (int progress = 0; progress < Rules::progressCount; progress++) {
+            for (int roll = 0; roll <= 6; roll++) {
+                int target = NO_MOVE;
+                if (progress == PROGRESS_YARD) {
+                    if (roll == 6) target = PROGRESS_TRACK;
+                } else if (roll >= 1 && roll <= 5) {
+                    if (Rules::inHomePath(progress)) {
+                        if (progress + roll <= Rules::progressFinished) target = progress + roll;
+                    } else if (Rules::entersHome(p, progress)) {
+                        target = Rules::progressHome;
+                    } else {
+                        target = (progress - PROGRESS_TRACK + roll) % Rules::trackLength + PROGRESS_TRACK;
+                    }
+                }
+                routes.target[p][progress][roll] = (uint8_t)target;
+            }
+        }
+    }
+    return routes;
+}
+
+template <typename Rules>
+constexpr RuleRoutes<Rules> ruleRoutes = buildRuleRoutes<Rules>();
+
+// The standard variant must be the board's own rules, table for table
+constexpr bool standardRoutesMatchBoard() {
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        for (int progress = 0; progress < PROGRESS_COUNT; progress++) {
+            if (progressOnTrack(progress) &&
+                ruleRoutes<StandardRules>.trackIndex[p][progress] != routeTables.trackIndex[p][progress]) {
+                return false;
+            }
+            for (int roll = 0; roll <= 6; roll++) {
+                if (ruleRoutes<StandardRules>.target[p][progress][roll] != routeTables.target[p][progress][roll]) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static_assert(standardRoutesMatchBoard(), "StandardRules routes differ from the board's route tables");
+static_assert(SixPlayerRules::progressCount <= 0xFF, "Progress fits in a byte");
+
+#endif
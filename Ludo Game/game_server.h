@@ -0,0 +1,739 @@
+#ifndef GAME_SERVER_H
+#define GAME_SERVER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <atomic>
+#include "packed_state.h"
+#include "event_log.h"
+
+/*
+ * Multi-game server.
+ * Games are state machines on the packed engine, driven by a few event
+ * loops (one thread and one epoll instance each) instead of five threads
+ * per game. A game runs turn after turn until a client seat has to choose
+ * a token, sends the choice request and parks until the move arrives.
+ * Seats nobody joined are played by random bots.
+ *
+ * Every wire message is 12 bytes (WireMessage). Clients send JOIN and MOVE;
+ * the server answers JOINED, sends CHOOSE when a seat must pick a move,
+ * one TURN per turn played (the event log's 32-bit turn event, which is
+ * the state delta) and GAME_OVER. Replies are queued per connection and
+ * written once per pass of the event loop.
+ *
+ * The server listens on localhost only: a number is a TCP port on
+ * 127.0.0.1, anything else a Unix socket path. Each loop matches seats
+ * among its own connections.
+ */
+
+#define MSG_JOIN 1      // Client: arg = seats wanted (1-4), flags = JOIN_FILL_BOTS, payload = client tag
+#define MSG_MOVE 2      // Client: arg = index of the chosen move in the CHOOSE message
+#define MSG_JOINED 3    // Server: seat = first seat, arg = seat count, flags = seat mask, payload = client tag
+#define MSG_CHOOSE 4    // Server: seat to move, arg = roll, flags = move count, payload = move tokens, one per byte
+#define MSG_TURN 5      // Server: seat that played, payload = LogEvent of the turn
+#define MSG_GAME_OVER 6 // Server: payload = final ranks, 4 bits per seat
+
+#define JOIN_FILL_BOTS 0x01 // Start at once with bots on the seats left over
+
+typedef struct {
+    uint8_t type;     // MSG_*
+    uint8_t seat;     // Seat the message is about
+    uint8_t arg;      // Meaning depends on type
+    uint8_t flags;    // Meaning depends on type
+    uint32_t gameId;  // Game the message is about (0 for JOIN)
+    uint32_t payload; // Meaning depends on type
+} WireMessage;
+
+static_assert(sizeof(WireMessage) == 12, "Wire messages are 12 bytes");
+
+#define SEAT_BOT -1  // Seat played by the server
+#define SEAT_FREE -2 // Seat still open for a JOIN
+
+#define GAME_UNUSED 0
+#define GAME_WAITING_SEATS 1 // Taking joins
+#define GAME_WAITING_MOVE 2  // Parked on a client's choice
+#define GAME_FINISHED 3
+
+#define SERVER_MAX_EVENTS 256
+#define SERVER_INPUT_SIZE 4096
+#define SERVER_OUTPUT_LIMIT (4 << 20) // A client this far behind is disconnected
+#define SERVER_MAX_LOOPS 16
+#define GAME_SLOT_BITS 16
+#define GAME_LOOP_BITS 4
+
+typedef struct {
+    uint32_t id;                     // Wire id: slot, loop and generation
+    uint16_t generation;             // Bumped whenever the slot is reused
+    uint8_t phase;                   // GAME_*
+    int seatFd[MAX_PLAYERS];         // Connection holding each seat, SEAT_BOT or SEAT_FREE
+    int seatsTaken;                  // Seats held by clients
+    PackedGameState state;           // Position
+    OccupancyIndex occupancy;        // Occupancy of the position
+    DiceRng rng;                     // Dice and bot choices of this game
+    int pendingRoll;                 // Roll waiting for a client's choice
+    int pendingCount;                // Moves offered in the CHOOSE message
+    PackedMove pendingMoves[TOKENS_PER_PLAYER];
+    uint32_t turns;                  // Turns played
+} ServerGame;
+
+typedef struct {
+    int fd;
+    uint8_t input[SERVER_INPUT_SIZE]; // Bytes read but not yet parsed
+    int inputLength;
+    uint8_t *output;                  // Messages queued for the client
+    int outputLength;
+    int outputCapacity;
+    bool queued;                      // In the loop's flush list
+    bool waitingWritable;             // EPOLLOUT armed because the socket was full
+    bool closing;                     // Closed at the end of the pass
+} ServerConnection;
+
+typedef struct GameServer GameServer;
+
+typedef struct {
+    GameServer *server;
+    int index;                        // Loop number, part of every game id
+    int epollFd;
+    ServerConnection **connections;   // Indexed by file descriptor
+    int connectionCapacity;
+    int *flushList;                   // Connections with queued output this pass
+    int flushCount;
+    ServerGame *games;                // Game slots
+    int gameCount;
+    int gameCapacity;
+    int *freeSlots;                   // Finished slots ready for reuse
+    int freeCount;
+    int openGame;                     // Slot taking joins (-1 = none)
+    int closingCount;                 // Connections waiting to be removed
+    uint64_t nextSeed;                // Seed of the next game
+
+    long connectionsAccepted;
+    long gamesStarted;
+    long gamesFinished;
+    long turnsPlayed;
+    long clientMoves;                 // Choices made by clients
+    long badMessages;                 // Messages that were not valid at the time
+    long messagesIn;
+    long messagesOut;
+    long readCalls;
+    long writeCalls;
+} ServerLoop;
+
+struct GameServer {
+    int listenFd;
+    int wakeFd;                       // eventfd that stops every loop
+    bool isUnix;
+    char address[108];
+    int loopCount;
+    ServerLoop loops[SERVER_MAX_LOOPS];
+    pthread_t threads[SERVER_MAX_LOOPS];
+    bool joined;                      // Loop threads already joined
+    std::atomic<bool> stopping;
+};
+
+// Function to read the monotonic clock for latency measurements
+static long long serverClockNs() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+// Function to check whether an address names a TCP port
+static bool isPortAddress(const char *address) {
+    if (!*address) return false;
+    for (const char *c = address; *c; c++) {
+        if (*c < '0' || *c > '9') return false;
+    }
+    return true;
+}
+
+static void setNonBlocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+// Function to open a socket connected to a server address, or -1
+int serverConnect(const char *address) {
+    int fd;
+    if (isPortAddress(address)) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)atoi(address));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+            perror(address);
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    } else {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", address);
+        if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+            perror(address);
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+    }
+    return fd;
+}
+
+// Function to open the listening socket; returns false if the address cannot be used
+static bool serverListen(GameServer *server, const char *address) {
+    snprintf(server->address, sizeof(server->address), "%s", address);
+    server->isUnix = !isPortAddress(address);
+
+    if (server->isUnix) {
+        server->listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", address);
+        unlink(address);
+        if (server->listenFd < 0 || bind(server->listenFd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+            perror(address);
+            return false;
+        }
+    } else {
+        server->listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(server->listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)atoi(address));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (server->listenFd < 0 || bind(server->listenFd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+            perror(address);
+            return false;
+        }
+    }
+    if (listen(server->listenFd, 1024) < 0) {
+        perror("listen");
+        return false;
+    }
+    setNonBlocking(server->listenFd);
+    return true;
+}
+
+// Function to mark a connection for removal at the end of the pass
+static void markClosing(ServerLoop *loop, ServerConnection *connection) {
+    if (connection->closing) return;
+    connection->closing = true;
+    loop->closingCount++;
+}
+
+// Function to queue a message for a connection
+static void queueMessage(ServerLoop *loop, int fd, const WireMessage *message) {
+    ServerConnection *connection = fd >= 0 && fd < loop->connectionCapacity ? loop->connections[fd] : NULL;
+    if (!connection || connection->closing) return;
+
+    if (connection->outputLength + (int)sizeof(WireMessage) > connection->outputCapacity) {
+        if (connection->outputCapacity >= SERVER_OUTPUT_LIMIT) {
+            markClosing(loop, connection); // The client stopped reading
+        } else {
+            connection->outputCapacity = connection->outputCapacity ? connection->outputCapacity * 2 : 4096;
+            connection->output = (uint8_t *)realloc(connection->output, connection->outputCapacity);
+        }
+    }
+    if (!connection->closing) {
+        memcpy(connection->output + connection->outputLength, message, sizeof(WireMessage));
+        connection->outputLength += sizeof(WireMessage);
+        loop->messagesOut++;
+    }
+    if (!connection->queued) {
+        connection->queued = true;
+        loop->flushList[loop->flushCount++] = fd;
+    }
+}
+
+// Function to send a message to every client seated in a game, once per connection
+static void broadcastMessage(ServerLoop *loop, const ServerGame *game, const WireMessage *message) {
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        int fd = game->seatFd[p];
+        if (fd < 0) continue;
+
+        bool alreadySent = false;
+        for (int q = 0; q < p; q++) {
+            if (game->seatFd[q] == fd) alreadySent = true;
+        }
+        if (!alreadySent) queueMessage(loop, fd, message);
+    }
+}
+
+// Function to take a free game slot and reset it for a new game
+static ServerGame *allocateGame(ServerLoop *loop) {
+    int slot;
+    if (loop->freeCount > 0) {
+        slot = loop->freeSlots[--loop->freeCount];
+    } else {
+        if (loop->gameCount == loop->gameCapacity) {
+            if (loop->gameCapacity == (1 << GAME_SLOT_BITS)) return NULL;
+            loop->gameCapacity = loop->gameCapacity ? loop->gameCapacity * 2 : 256;
+            loop->games = (ServerGame *)realloc(loop->games, loop->gameCapacity * sizeof(ServerGame));
+            loop->freeSlots = (int *)realloc(loop->freeSlots, loop->gameCapacity * sizeof(int));
+        }
+        slot = loop->gameCount++;
+        memset(&loop->games[slot], 0, sizeof(ServerGame));
+    }
+
+    ServerGame *game = &loop->games[slot];
+    game->generation++;
+    game->id = (uint32_t)slot | ((uint32_t)loop->index << GAME_SLOT_BITS) |
+               ((uint32_t)game->generation << (GAME_SLOT_BITS + GAME_LOOP_BITS));
+    game->phase = GAME_WAITING_SEATS;
+    game->seatsTaken = 0;
+    game->turns = 0;
+    for (int p = 0; p < MAX_PLAYERS; p++) game->seatFd[p] = SEAT_FREE;
+    packedResetState(&game->state);
+    occupancyClear(&game->occupancy);
+    diceRngSeed(&game->rng, loop->nextSeed++);
+    return game;
+}
+
+// Function to find a live game by its wire id, or NULL
+static ServerGame *findGame(ServerLoop *loop, uint32_t id) {
+    uint32_t slot = id & ((1u << GAME_SLOT_BITS) - 1);
+    if ((int)slot >= loop->gameCount) return NULL;
+
+    ServerGame *game = &loop->games[slot];
+    return game->id == id && game->phase != GAME_UNUSED && game->phase != GAME_FINISHED ? game : NULL;
+}
+
+// Function to play a game's turns until a client must choose or the game ends
+static void runGame(ServerLoop *loop, ServerGame *game) {
+    while (!packedGameOver(&game->state)) {
+        int player = game->state.currentTurn;
+        int roll = diceRngRoll(&game->rng);
+        PackedMove moves[TOKENS_PER_PLAYER];
+        int count = generateMoves(&game->state, &game->occupancy, roll, moves);
+
+        const PackedMove *move = NULL;
+        if (game->seatFd[player] >= 0 && packedTurnHasChoice(roll, moves, count)) {
+            if (count > 1) {
+                // Park the game until the seat answers
+                WireMessage choose = { MSG_CHOOSE, (uint8_t)player, (uint8_t)roll, (uint8_t)count, game->id, 0 };
+                for (int i = 0; i < count; i++) choose.payload |= (uint32_t)moves[i].token << (8 * i);
+                memcpy(game->pendingMoves, moves, sizeof(moves));
+                game->pendingRoll = roll;
+                game->pendingCount = count;
+                game->phase = GAME_WAITING_MOVE;
+                queueMessage(loop, game->seatFd[player], &choose);
+                return;
+            }
+            move = &moves[0];
+        } else {
+            int choice = chooseRandomMove(moves, count, &game->rng);
+            if (choice >= 0) move = &moves[choice];
+        }
+
+        PackedGameState before = game->state;
+        packedFinishTurn(&game->state, &game->occupancy, roll, move);
+        WireMessage turn = { MSG_TURN, (uint8_t)player, 0, 0, game->id, eventLogEncode(&before, &game->state, roll) };
+        broadcastMessage(loop, game, &turn);
+        game->turns++;
+        loop->turnsPlayed++;
+    }
+
+    WireMessage over = { MSG_GAME_OVER, 0, 0, 0, game->id, game->state.ranks };
+    broadcastMessage(loop, game, &over);
+    game->phase = GAME_FINISHED;
+    loop->gamesFinished++;
+    loop->freeSlots[loop->freeCount++] = (int)(game - loop->games);
+}
+
+// Function to start a game whose seats are settled; open seats get bots
+static void startGame(ServerLoop *loop, ServerGame *game) {
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        if (game->seatFd[p] == SEAT_FREE) game->seatFd[p] = SEAT_BOT;
+    }
+    if (loop->openGame == (int)(game - loop->games)) loop->openGame = -1;
+    game->phase = GAME_WAITING_MOVE;
+    loop->gamesStarted++;
+    runGame(loop, game);
+}
+
+// Function to seat a client: in the open game if it has room, otherwise in a new one
+static void handleJoin(ServerLoop *loop, int fd, const WireMessage *message) {
+    int wanted = message->arg < 1 ? 1 : (message->arg > MAX_PLAYERS ? MAX_PLAYERS : message->arg);
+    bool fillBots = (message->flags & JOIN_FILL_BOTS) != 0;
+
+    ServerGame *game = NULL;
+    if (!fillBots && loop->openGame >= 0) {
+        ServerGame *open = &loop->games[loop->openGame];
+        if (MAX_PLAYERS - open->seatsTaken >= wanted) {
+            game = open;
+        } else {
+            startGame(loop, open); // Cannot fit: play it with bots and open a new one
+        }
+    }
+    if (!game) {
+        game = allocateGame(loop);
+        if (!game) {
+            loop->badMessages++;
+            return;
+        }
+        if (!fillBots) loop->openGame = (int)(game - loop->games);
+    }
+
+    int firstSeat = -1;
+    uint8_t seatMask = 0;
+    for (int p = 0; p < MAX_PLAYERS && wanted > 0; p++) {
+        if (game->seatFd[p] != SEAT_FREE) continue;
+        game->seatFd[p] = fd;
+        game->seatsTaken++;
+        seatMask |= (uint8_t)(1 << p);
+        if (firstSeat < 0) firstSeat = p;
+        wanted--;
+    }
+
+    WireMessage joined = { MSG_JOINED, (uint8_t)firstSeat, (uint8_t)__builtin_popcount(seatMask), seatMask,
+                           game->id, message->payload };
+    queueMessage(loop, fd, &joined);
+    if (fillBots || game->seatsTaken == MAX_PLAYERS) startGame(loop, game);
+}
+
+// Function to apply a client's choice and run the game on
+static void handleMove(ServerLoop *loop, int fd, const WireMessage *message) {
+    ServerGame *game = findGame(loop, message->gameId);
+    if (!game || game->phase != GAME_WAITING_MOVE || game->seatFd[game->state.currentTurn] != fd ||
+        message->arg >= game->pendingCount) {
+        loop->badMessages++;
+        return;
+    }
+
+    int player = game->state.currentTurn;
+    PackedGameState before = game->state;
+    packedFinishTurn(&game->state, &game->occupancy, game->pendingRoll, &game->pendingMoves[message->arg]);
+    WireMessage turn = { MSG_TURN, (uint8_t)player, 0, 0, game->id,
+                         eventLogEncode(&before, &game->state, game->pendingRoll) };
+    broadcastMessage(loop, game, &turn);
+    game->turns++;
+    loop->turnsPlayed++;
+    loop->clientMoves++;
+    runGame(loop, game);
+}
+
+// Function to register an accepted connection with a loop
+static void addConnection(ServerLoop *loop, int fd) {
+    if (fd >= loop->connectionCapacity) {
+        int capacity = loop->connectionCapacity ? loop->connectionCapacity : 64;
+        while (capacity <= fd) capacity *= 2;
+        loop->connections = (ServerConnection **)realloc(loop->connections, capacity * sizeof(ServerConnection *));
+        loop->flushList = (int *)realloc(loop->flushList, capacity * sizeof(int));
+        for (int i = loop->connectionCapacity; i < capacity; i++) loop->connections[i] = NULL;
+        loop->connectionCapacity = capacity;
+    }
+
+    ServerConnection *connection = (ServerConnection *)calloc(1, sizeof(ServerConnection));
+    connection->fd = fd;
+    loop->connections[fd] = connection;
+    setNonBlocking(fd);
+    if (!loop->server->isUnix) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    epoll_ctl(loop->epollFd, EPOLL_CTL_ADD, fd, &event);
+    loop->connectionsAccepted++;
+}
+
+// Function to drop a connection; its seats are handed to bots
+static void removeConnection(ServerLoop *loop, int fd) {
+    ServerConnection *connection = loop->connections[fd];
+    epoll_ctl(loop->epollFd, EPOLL_CTL_DEL, fd, NULL);
+    close(fd);
+    free(connection->output);
+    free(connection);
+    loop->connections[fd] = NULL;
+
+    for (int g = 0; g < loop->gameCount; g++) {
+        ServerGame *game = &loop->games[g];
+        if (game->phase == GAME_UNUSED || game->phase == GAME_FINISHED) continue;
+
+        bool seated = false;
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            if (game->seatFd[p] != fd) continue;
+            seated = true;
+            if (game->phase == GAME_WAITING_SEATS) {
+                game->seatFd[p] = SEAT_FREE;
+                game->seatsTaken--;
+            } else {
+                game->seatFd[p] = SEAT_BOT;
+            }
+        }
+
+        // A game parked on the departed client's choice continues with a bot move
+        if (seated && game->phase == GAME_WAITING_MOVE && game->seatFd[game->state.currentTurn] == SEAT_BOT &&
+            game->pendingCount > 0) {
+            int player = game->state.currentTurn;
+            PackedGameState before = game->state;
+            int choice = chooseRandomMove(game->pendingMoves, game->pendingCount, &game->rng);
+            packedFinishTurn(&game->state, &game->occupancy, game->pendingRoll,
+                             choice >= 0 ? &game->pendingMoves[choice] : NULL);
+            game->pendingCount = 0;
+            WireMessage turn = { MSG_TURN, (uint8_t)player, 0, 0, game->id,
+                                 eventLogEncode(&before, &game->state, game->pendingRoll) };
+            broadcastMessage(loop, game, &turn);
+            game->turns++;
+            loop->turnsPlayed++;
+            runGame(loop, game);
+        }
+    }
+}
+
+// Function to write a connection's queued messages; arms EPOLLOUT if the socket is full
+static void flushConnection(ServerLoop *loop, ServerConnection *connection) {
+    int sent = 0;
+    while (sent < connection->outputLength) {
+        ssize_t written = send(connection->fd, connection->output + sent, connection->outputLength - sent, MSG_NOSIGNAL);
+        loop->writeCalls++;
+        if (written > 0) {
+            sent += (int)written;
+        } else if (written < 0 && errno == EINTR) {
+            continue;
+        } else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            markClosing(loop, connection);
+            break;
+        }
+    }
+    if (sent > 0) {
+        memmove(connection->output, connection->output + sent, connection->outputLength - sent);
+        connection->outputLength -= sent;
+    }
+
+    bool wantWritable = connection->outputLength > 0 && !connection->closing;
+    if (wantWritable != connection->waitingWritable) {
+        struct epoll_event event;
+        event.events = (uint32_t)EPOLLIN | (wantWritable ? (uint32_t)EPOLLOUT : 0u);
+        event.data.fd = connection->fd;
+        epoll_ctl(loop->epollFd, EPOLL_CTL_MOD, connection->fd, &event);
+        connection->waitingWritable = wantWritable;
+    }
+}
+
+// Function to read and handle everything a client sent
+static void readConnection(ServerLoop *loop, ServerConnection *connection) {
+    while (!connection->closing) {
+        int space = SERVER_INPUT_SIZE - connection->inputLength;
+        ssize_t received = read(connection->fd, connection->input + connection->inputLength, space);
+        loop->readCalls++;
+        if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            markClosing(loop, connection);
+            break;
+        }
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        connection->inputLength += (int)received;
+
+        int offset = 0;
+        while (connection->inputLength - offset >= (int)sizeof(WireMessage)) {
+            WireMessage message;
+            memcpy(&message, connection->input + offset, sizeof(message));
+            offset += sizeof(message);
+            loop->messagesIn++;
+
+            if (message.type == MSG_JOIN) {
+                handleJoin(loop, connection->fd, &message);
+            } else if (message.type == MSG_MOVE) {
+                handleMove(loop, connection->fd, &message);
+            } else {
+                loop->badMessages++;
+            }
+        }
+        memmove(connection->input, connection->input + offset, connection->inputLength - offset);
+        connection->inputLength -= offset;
+        if (received < space) break; // Drained the socket
+    }
+}
+
+// Thread function for one event loop
+void *serverLoopRoutine(void *arg) {
+    ServerLoop *loop = (ServerLoop *)arg;
+    GameServer *server = loop->server;
+    struct epoll_event events[SERVER_MAX_EVENTS];
+
+    while (!server->stopping.load()) {
+        int ready = epoll_wait(loop->epollFd, events, SERVER_MAX_EVENTS, -1);
+        if (ready < 0 && errno == EINTR) continue;
+
+        for (int i = 0; i < ready; i++) {
+            int fd = events[i].data.fd;
+            if (fd == server->wakeFd) continue;
+
+            if (fd == server->listenFd) {
+                int client;
+                while ((client = accept(server->listenFd, NULL, NULL)) >= 0) addConnection(loop, client);
+                continue;
+            }
+
+            ServerConnection *connection = fd < loop->connectionCapacity ? loop->connections[fd] : NULL;
+            if (!connection) continue;
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) readConnection(loop, connection);
+            if ((events[i].events & EPOLLOUT) && !connection->queued) {
+                connection->queued = true;
+                loop->flushList[loop->flushCount++] = fd;
+            }
+        }
+
+        // One write per connection for everything this pass produced. Removing a
+        // connection can move games on and queue more, so repeat until settled.
+        while (loop->closingCount > 0 || loop->flushCount > 0) {
+            if (loop->closingCount > 0) {
+                loop->closingCount = 0;
+                for (int fd = 0; fd < loop->connectionCapacity; fd++) {
+                    if (loop->connections[fd] && loop->connections[fd]->closing) removeConnection(loop, fd);
+                }
+            }
+
+            int flushCount = loop->flushCount;
+            loop->flushCount = 0;
+            for (int i = 0; i < flushCount; i++) {
+                ServerConnection *connection = loop->connections[loop->flushList[i]];
+                if (!connection) continue;
+                connection->queued = false;
+                if (!connection->closing) flushConnection(loop, connection);
+            }
+        }
+    }
+    return NULL;
+}
+
+// Function to start a server with its event loops; returns NULL if it cannot listen
+GameServer *serverStart(const char *address, int loopCount, uint64_t seed) {
+    GameServer *server = new GameServer();
+    if (loopCount < 1) loopCount = 1;
+    if (loopCount > SERVER_MAX_LOOPS) loopCount = SERVER_MAX_LOOPS;
+    server->loopCount = loopCount;
+    server->stopping.store(false);
+    if (!serverListen(server, address)) {
+        if (server->listenFd >= 0) close(server->listenFd);
+        delete server;
+        return NULL;
+    }
+    server->wakeFd = eventfd(0, EFD_NONBLOCK);
+
+    for (int l = 0; l < loopCount; l++) {
+        ServerLoop *loop = &server->loops[l];
+        memset(loop, 0, sizeof(*loop));
+        loop->server = server;
+        loop->index = l;
+        loop->openGame = -1;
+        loop->nextSeed = seed + ((uint64_t)l << 40);
+        loop->epollFd = epoll_create1(0);
+
+        // Every loop waits on the listening socket; EPOLLEXCLUSIVE wakes one per connection
+        struct epoll_event event;
+        event.events = EPOLLIN | EPOLLEXCLUSIVE;
+        event.data.fd = server->listenFd;
+        epoll_ctl(loop->epollFd, EPOLL_CTL_ADD, server->listenFd, &event);
+        event.events = EPOLLIN;
+        event.data.fd = server->wakeFd;
+        epoll_ctl(loop->epollFd, EPOLL_CTL_ADD, server->wakeFd, &event);
+    }
+    for (int l = 0; l < loopCount; l++) {
+        pthread_create(&server->threads[l], NULL, serverLoopRoutine, &server->loops[l]);
+    }
+    return server;
+}
+
+// Function to ask every loop to stop; safe to call from a signal handler
+void serverRequestStop(GameServer *server) {
+    server->stopping.store(true);
+    uint64_t one = 1;
+    if (write(server->wakeFd, &one, sizeof(one)) < 0) {
+        // The loops are already awake
+    }
+}
+
+// Function to wait until every loop has stopped
+void serverWait(GameServer *server) {
+    if (server->joined) return;
+    for (int l = 0; l < server->loopCount; l++) {
+        pthread_join(server->threads[l], NULL);
+    }
+    server->joined = true;
+}
+
+// Function to print totals over every loop
+void serverPrintStats(const GameServer *server) {
+    ServerLoop total;
+    memset(&total, 0, sizeof(total));
+    for (int l = 0; l < server->loopCount; l++) {
+        const ServerLoop *loop = &server->loops[l];
+        total.connectionsAccepted += loop->connectionsAccepted;
+        total.gamesStarted += loop->gamesStarted;
+        total.gamesFinished += loop->gamesFinished;
+        total.turnsPlayed += loop->turnsPlayed;
+        total.clientMoves += loop->clientMoves;
+        total.badMessages += loop->badMessages;
+        total.messagesIn += loop->messagesIn;
+        total.messagesOut += loop->messagesOut;
+        total.readCalls += loop->readCalls;
+        total.writeCalls += loop->writeCalls;
+        total.gameCapacity += loop->gameCapacity;
+    }
+    printf("=== SERVER (%d event loops on %s) ===\n", server->loopCount, server->address);
+    printf("Connections: %ld, games started: %ld, finished: %ld, game slots: %d\n", total.connectionsAccepted,
+           total.gamesStarted, total.gamesFinished, total.gameCapacity);
+    printf("Turns: %ld, client moves: %ld, invalid messages: %ld\n", total.turnsPlayed, total.clientMoves,
+           total.badMessages);
+    printf("Messages in: %ld, out: %ld, read calls: %ld, write calls: %ld (%.1f messages per write)\n",
+           total.messagesIn, total.messagesOut, total.readCalls, total.writeCalls,
+           total.writeCalls > 0 ? (double)total.messagesOut / total.writeCalls : 0.0);
+}
+
+// Function to stop the loops, close every socket and free the server
+void serverStop(GameServer *server) {
+    serverRequestStop(server);
+    serverWait(server);
+
+    for (int l = 0; l < server->loopCount; l++) {
+        ServerLoop *loop = &server->loops[l];
+        for (int fd = 0; fd < loop->connectionCapacity; fd++) {
+            if (loop->connections[fd]) {
+                close(fd);
+                free(loop->connections[fd]->output);
+                free(loop->connections[fd]);
+            }
+        }
+        close(loop->epollFd);
+        free(loop->connections);
+        free(loop->flushList);
+        free(loop->games);
+        free(loop->freeSlots);
+    }
+    close(server->wakeFd);
+    close(server->listenFd);
+    if (server->isUnix) unlink(server->address);
+    delete server;
+}
+
+#endif
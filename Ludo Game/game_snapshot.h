@@ -0,0 +1,186 @@
+#ifndef GAME_SNAPSHOT_H
+#define GAME_SNAPSHOT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "packed_state.h"
+#include "dice_rng.h"
+
+/*
+ * Game snapshots.
+ * A snapshot is everything needed to continue a game exactly: the packed
+ * position (tokens, turn, sixes, ranks, kills), the dice generator with its
+ * pre-drawn rolls, and the turn count. It has a fixed size and no pointers,
+ * so saving and restoring are plain copies and snapshots can be written
+ * out and mapped back as bytes.
+ *
+ * A pack file is a header followed by snapshots back to back:
+ *
+ *   SnapshotPackHeader, GameSnapshot[count]
+ *
+ * The count is implied by the file size, so writers only ever append. The
+ * format is little-endian.
+ */
+
+#define SNAPSHOT_PACK_MAGIC "LUDOSNP1"
+#define SNAPSHOT_VERSION 1
+
+typedef struct {
+    uint16_t version;                    // SNAPSHOT_VERSION
+    uint8_t rollsLeft;                   // Unused values left in rollBuffer
+    uint8_t reserved;
+    uint32_t turnsPlayed;                // Turns played before the snapshot
+    PackedGameState state;               // Position and player to move
+    uint64_t rngState[4];                // Dice generator state
+    uint8_t rollBuffer[DICE_BATCH_SIZE]; // Pre-drawn dice values
+} GameSnapshot;
+
+static_assert(sizeof(GameSnapshot) == 80, "Snapshots are 80 bytes");
+
+typedef struct {
+    char magic[8];         // SNAPSHOT_PACK_MAGIC
+    uint32_t version;      // SNAPSHOT_VERSION
+    uint32_t snapshotSize; // sizeof(GameSnapshot)
+} SnapshotPackHeader;
+
+typedef struct {
+    FILE *file;         // Pack file, opened for appending
+    long snapshotCount; // Snapshots in the file, including earlier ones
+} SnapshotPackWriter;
+
+typedef struct {
+    int fd;                          // Open pack file
+    const uint8_t *data;             // Mapped file
+    size_t size;                     // Size of the mapping
+    const GameSnapshot *snapshots;   // Snapshots, read in place
+    long count;                      // Entries in snapshots
+} SnapshotPack;
+
+// Function to take a snapshot of a packed game and its dice
+inline void snapshotCapture(GameSnapshot *snapshot, const PackedGameState *state, const DiceRng *rng,
+                            uint32_t turnsPlayed) {
+    snapshot->version = SNAPSHOT_VERSION;
+    snapshot->rollsLeft = (uint8_t)rng->rollsLeft;
+    snapshot->reserved = 0;
+    snapshot->turnsPlayed = turnsPlayed;
+    snapshot->state = *state;
+    memcpy(snapshot->rngState, rng->state, sizeof(snapshot->rngState));
+    memcpy(snapshot->rollBuffer, rng->rollBuffer, sizeof(snapshot->rollBuffer));
+}
+
+// Function to restore a packed game and its dice; returns false for another version
+inline bool snapshotRestore(const GameSnapshot *snapshot, PackedGameState *state, DiceRng *rng) {
+    if (snapshot->version != SNAPSHOT_VERSION) return false;
+    *state = snapshot->state;
+    memcpy(rng->state, snapshot->rngState, sizeof(rng->state));
+    memcpy(rng->rollBuffer, snapshot->rollBuffer, sizeof(rng->rollBuffer));
+    rng->rollsLeft = snapshot->rollsLeft;
+    return true;
+}
+
+static bool snapshotHeaderValid(const SnapshotPackHeader *header) {
+    return memcmp(header->magic, SNAPSHOT_PACK_MAGIC, sizeof(header->magic)) == 0 &&
+           header->version == SNAPSHOT_VERSION && header->snapshotSize == sizeof(GameSnapshot);
+}
+
+// Function to open a pack for appending, writing the header if the file is new
+// or truncate is set; returns NULL on error
+SnapshotPackWriter *snapshotPackCreate(const char *path, bool truncate) {
+    FILE *file = fopen(path, truncate ? "w+b" : "a+b");
+    if (!file) {
+        perror(path);
+        return NULL;
+    }
+
+    SnapshotPackHeader header;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    if (size == 0) {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, SNAPSHOT_PACK_MAGIC, sizeof(header.magic));
+        header.version = SNAPSHOT_VERSION;
+        header.snapshotSize = sizeof(GameSnapshot);
+        fwrite(&header, sizeof(header), 1, file);
+        size = sizeof(header);
+    } else {
+        rewind(file);
+        if (fread(&header, sizeof(header), 1, file) != 1 || !snapshotHeaderValid(&header)) {
+            fprintf(stderr, "%s: not a snapshot pack of version %d\n", path, SNAPSHOT_VERSION);
+            fclose(file);
+            return NULL;
+        }
+        fseek(file, 0, SEEK_END);
+    }
+
+    SnapshotPackWriter *writer = (SnapshotPackWriter *)calloc(1, sizeof(SnapshotPackWriter));
+    writer->file = file;
+    writer->snapshotCount = (size - (long)sizeof(header)) / (long)sizeof(GameSnapshot);
+    setvbuf(file, NULL, _IOFBF, 1 << 16);
+    return writer;
+}
+
+inline void snapshotPackAppend(SnapshotPackWriter *writer, const GameSnapshot *snapshot) {
+    fwrite(snapshot, sizeof(*snapshot), 1, writer->file);
+    writer->snapshotCount++;
+}
+
+void snapshotPackClose(SnapshotPackWriter *writer) {
+    if (!writer) return;
+    fclose(writer->file);
+    free(writer);
+}
+
+// Function to memory-map a pack for reading; returns NULL on error
+SnapshotPack *snapshotPackOpen(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return NULL;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(SnapshotPackHeader)) {
+        fprintf(stderr, "%s: not a snapshot pack\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        perror("mmap");
+        close(fd);
+        return NULL;
+    }
+    if (!snapshotHeaderValid((const SnapshotPackHeader *)data)) {
+        fprintf(stderr, "%s: not a snapshot pack of version %d\n", path, SNAPSHOT_VERSION);
+        munmap(data, info.st_size);
+        close(fd);
+        return NULL;
+    }
+    // Analysis tools walk the pack front to back
+    madvise(data, info.st_size, MADV_SEQUENTIAL);
+
+    SnapshotPack *pack = (SnapshotPack *)calloc(1, sizeof(SnapshotPack));
+    pack->fd = fd;
+    pack->data = (const uint8_t *)data;
+    pack->size = info.st_size;
+    pack->snapshots = (const GameSnapshot *)(pack->data + sizeof(SnapshotPackHeader));
+    pack->count = (info.st_size - sizeof(SnapshotPackHeader)) / sizeof(GameSnapshot);
+    return pack;
+}
+
+void snapshotPackCloseReader(SnapshotPack *pack) {
+    if (!pack) return;
+    munmap((void *)pack->data, pack->size);
+    close(pack->fd);
+    free(pack);
+}
+
+#endif
@@ -0,0 +1,267 @@
+#ifndef GAME_STATS_H
+#define GAME_STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "packed_state.h"
+
+/*
+ * Streaming statistics over simulated games.
+ * Every worker owns a StatsAccumulator and records into it without locks;
+ * the accumulators are merged once the run is over. Distributions keep a
+ * count, sum, minimum and maximum plus a QuantileSketch: a fixed log-linear
+ * histogram (exact below 64, then 32 buckets per power of two, so quantiles
+ * are within about 3%). Sketches merge by adding buckets, and memory is the
+ * same for a thousand games or a billion.
+ */
+
+#define STATS_MAX_SEATS 6
+#define SKETCH_EXACT 64            // Values below this get a bucket each
+#define SKETCH_SUB_BUCKETS 32      // Buckets per power of two above SKETCH_EXACT
+#define SKETCH_MAX_OCTAVE 40       // Values from 2^40 up share the last bucket
+#define SKETCH_BUCKETS (SKETCH_EXACT + (SKETCH_MAX_OCTAVE - 6) * SKETCH_SUB_BUCKETS)
+
+typedef struct {
+    uint64_t buckets[SKETCH_BUCKETS];
+} QuantileSketch;
+
+typedef struct {
+    long count;
+    long long sum;
+    long long min;
+    long long max;
+    QuantileSketch sketch;
+} Distribution;
+
+// Everything recorded by one worker; aligned so workers never share a cache line
+typedef struct alignas(64) {
+    int players;                       // Seats in the games recorded
+    long games;
+    long winsBySeat[STATS_MAX_SEATS];  // First places per seat
+    Distribution gameTurns;            // Turns per game
+    Distribution captures;             // Captures per game
+    Distribution yardStints;           // Turns from entering the yard (start or capture) to release
+    long forfeits;                     // Turns lost to a third consecutive six
+    long gamesWithForfeit;
+    long long yardTokenTurns;          // Turns tokens spent in the yard, summed over tokens
+    long long tokenTurns;              // Turns times tokens, the denominator of the yard share
+} StatsAccumulator;
+
+inline int sketchBucket(long long value) {
+    if (value < SKETCH_EXACT) return value < 0 ? 0 : (int)value;
+    int octave = 63 - __builtin_clzll((unsigned long long)value);
+    if (octave >= SKETCH_MAX_OCTAVE) return SKETCH_BUCKETS - 1;
+    int sub = (int)((value >> (octave - 5)) & (SKETCH_SUB_BUCKETS - 1));
+    return SKETCH_EXACT + (octave - 6) * SKETCH_SUB_BUCKETS + sub;
+}
+
+// Function to get the smallest value that falls in a bucket
+inline long long sketchBucketValue(int bucket) {
+    if (bucket < SKETCH_EXACT) return bucket;
+    int octave = 6 + (bucket - SKETCH_EXACT) / SKETCH_SUB_BUCKETS;
+    int sub = (bucket - SKETCH_EXACT) % SKETCH_SUB_BUCKETS;
+    return (long long)(SKETCH_SUB_BUCKETS + sub) << (octave - 5);
+}
+
+inline void distributionAdd(Distribution *distribution, long long value) {
+    if (distribution->count == 0 || value < distribution->min) distribution->min = value;
+    if (distribution->count == 0 || value > distribution->max) distribution->max = value;
+    distribution->count++;
+    distribution->sum += value;
+    distribution->sketch.buckets[sketchBucket(value)]++;
+}
+
+void distributionMerge(Distribution *total, const Distribution *part) {
+    if (part->count == 0) return;
+    if (total->count == 0 || part->min < total->min) total->min = part->min;
+    if (total->count == 0 || part->max > total->max) total->max = part->max;
+    total->count += part->count;
+    total->sum += part->sum;
+    for (int b = 0; b < SKETCH_BUCKETS; b++) {
+        total->sketch.buckets[b] += part->sketch.buckets[b];
+    }
+}
+
+// Function to estimate a quantile; exact below SKETCH_EXACT and clamped to the observed range
+long long distributionQuantile(const Distribution *distribution, double fraction) {
+    if (distribution->count == 0) return 0;
+    long target = (long)(fraction * (distribution->count - 1));
+    long seen = 0;
+    for (int b = 0; b < SKETCH_BUCKETS; b++) {
+        seen += distribution->sketch.buckets[b];
+        if (seen > target) {
+            long long value = sketchBucketValue(b);
+            if (value < distribution->min) return distribution->min;
+            return value > distribution->max ? distribution->max : value;
+        }
+    }
+    return distribution->max;
+}
+
+inline double distributionMean(const Distribution *distribution) {
+    return distribution->count > 0 ? (double)distribution->sum / distribution->count : 0.0;
+}
+
+void statsReset(StatsAccumulator *stats, int players) {
+    memset(stats, 0, sizeof(*stats));
+    stats->players = players;
+}
+
+void statsMerge(StatsAccumulator *total, const StatsAccumulator *part) {
+    total->games += part->games;
+    for (int p = 0; p < STATS_MAX_SEATS; p++) total->winsBySeat[p] += part->winsBySeat[p];
+    distributionMerge(&total->gameTurns, &part->gameTurns);
+    distributionMerge(&total->captures, &part->captures);
+    distributionMerge(&total->yardStints, &part->yardStints);
+    total->forfeits += part->forfeits;
+    total->gamesWithForfeit += part->gamesWithForfeit;
+    total->yardTokenTurns += part->yardTokenTurns;
+    total->tokenTurns += part->tokenTurns;
+}
+
+// Function to play a full game from the start with random seats, recording
+// it turn by turn into a worker's accumulator; returns turns played
+template <typename Rules>
+long statsPlayGame(PackedState<Rules> *state, DiceRng *rng, StatsAccumulator *stats) {
+    Occupancy<Rules> occupancy;
+    uint32_t yardSince[Rules::totalTokens] = {0}; // Turn each token last entered the yard
+    int forfeits = 0;
+    int captures = 0;
+    packedResetState(state);
+    occupancyClear(&occupancy);
+
+    uint32_t turns = 0;
+    while (!packedGameOver(state)) {
+        int player = state->currentTurn;
+        int sixes = packedSixCount(state, player);
+        int kills = state->killCounts[player];
+        uint8_t before[Rules::totalTokens];
+        memcpy(before, state->tokens, sizeof(before));
+
+        int roll = packedPlayTurn(state, &occupancy, rng);
+        turns++;
+
+        if (roll == 6) {
+            // A six either releases a token or counts towards the forfeit
+            bool released = false;
+            for (int j = 0; j < Rules::tokensPerPlayer; j++) {
+                int t = player * Rules::tokensPerPlayer + j;
+                if (before[t] == PROGRESS_YARD && state->tokens[t] != PROGRESS_YARD) {
+                    distributionAdd(&stats->yardStints, turns - yardSince[t]);
+                    stats->yardTokenTurns += turns - yardSince[t];
+                    released = true;
+                }
+            }
+            if (!released && sixes == 2) forfeits++;
+        } else if (state->killCounts[player] != kills) {
+            for (int t = 0; t < Rules::totalTokens; t++) {
+                if (before[t] != PROGRESS_YARD && state->tokens[t] == PROGRESS_YARD) yardSince[t] = turns;
+            }
+            captures++;
+        }
+    }
+
+    // Tokens still waiting in the yard count up to the last turn
+    for (int t = 0; t < Rules::totalTokens; t++) {
+        if (state->tokens[t] == PROGRESS_YARD) stats->yardTokenTurns += turns - yardSince[t];
+    }
+    stats->tokenTurns += (long long)turns * Rules::totalTokens;
+
+    stats->games++;
+    for (int p = 0; p < Rules::players; p++) {
+        if (packedRank(state, p) == 1) stats->winsBySeat[p]++;
+    }
+    distributionAdd(&stats->gameTurns, turns);
+    distributionAdd(&stats->captures, captures);
+    stats->forfeits += forfeits;
+    if (forfeits > 0) stats->gamesWithForfeit++;
+    return turns;
+}
+
+static void printDistribution(const char *name, const Distribution *distribution) {
+    printf("%-16s %10.1f %8lld %8lld %8lld %8lld %8lld\n", name, distributionMean(distribution),
+           distribution->min, distributionQuantile(distribution, 0.50), distributionQuantile(distribution, 0.90),
+           distributionQuantile(distribution, 0.99), distribution->max);
+}
+
+// Function to print the merged statistics
+void statsPrint(const StatsAccumulator *stats) {
+    printf("Games: %ld, %d seats\n", stats->games, stats->players);
+    for (int p = 0; p < stats->players; p++) {
+        printf("Seat %d win rate: %.2f%%\n", p + 1, stats->games > 0 ? 100.0 * stats->winsBySeat[p] / stats->games : 0.0);
+    }
+    printf("%-16s %10s %8s %8s %8s %8s %8s\n", "distribution", "mean", "min", "p50", "p90", "p99", "max");
+    printDistribution("turns/game", &stats->gameTurns);
+    printDistribution("captures/game", &stats->captures);
+    printDistribution("yard stint", &stats->yardStints);
+    printf("Three-six forfeits: %ld (%.3f per game, %.1f%% of games)\n", stats->forfeits,
+           stats->games > 0 ? (double)stats->forfeits / stats->games : 0.0,
+           stats->games > 0 ? 100.0 * stats->gamesWithForfeit / stats->games : 0.0);
+    printf("Token time in the yard: %.1f%%\n",
+           stats->tokenTurns > 0 ? 100.0 * stats->yardTokenTurns / stats->tokenTurns : 0.0);
+}
+
+static void writeDistributionCsv(FILE *file, const char *name, const Distribution *distribution) {
+    fprintf(file, "%s,%ld,%.4f,%lld,%lld,%lld,%lld,%lld\n", name, distribution->count, distributionMean(distribution),
+            distribution->min, distributionQuantile(distribution, 0.50), distributionQuantile(distribution, 0.90),
+            distributionQuantile(distribution, 0.99), distribution->max);
+}
+
+// Function to write the statistics as CSV, one metric per row; returns false if the file cannot be written
+bool statsWriteCsv(const StatsAccumulator *stats, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+    fprintf(file, "metric,count,mean,min,p50,p90,p99,max\n");
+    writeDistributionCsv(file, "turns_per_game", &stats->gameTurns);
+    writeDistributionCsv(file, "captures_per_game", &stats->captures);
+    writeDistributionCsv(file, "yard_stint_turns", &stats->yardStints);
+    for (int p = 0; p < stats->players; p++) {
+        fprintf(file, "wins_seat_%d,%ld,%.6f,,,,,\n", p + 1, stats->winsBySeat[p],
+                stats->games > 0 ? (double)stats->winsBySeat[p] / stats->games : 0.0);
+    }
+    fprintf(file, "forfeits,%ld,%.6f,,,,,\n", stats->forfeits,
+            stats->games > 0 ? (double)stats->forfeits / stats->games : 0.0);
+    fprintf(file, "games_with_forfeit,%ld,%.6f,,,,,\n", stats->gamesWithForfeit,
+            stats->games > 0 ? (double)stats->gamesWithForfeit / stats->games : 0.0);
+    fprintf(file, "yard_share,%lld,%.6f,,,,,\n", stats->yardTokenTurns,
+            stats->tokenTurns > 0 ? (double)stats->yardTokenTurns / stats->tokenTurns : 0.0);
+    fclose(file);
+    return true;
+}
+
+static void writeDistributionJson(FILE *file, const char *name, const Distribution *distribution, bool last) {
+    fprintf(file, "    \"%s\": {\"count\": %ld, \"mean\": %.4f, \"min\": %lld, \"p50\": %lld, \"p90\": %lld, "
+                  "\"p99\": %lld, \"max\": %lld}%s\n",
+            name, distribution->count, distributionMean(distribution), distribution->min,
+            distributionQuantile(distribution, 0.50), distributionQuantile(distribution, 0.90),
+            distributionQuantile(distribution, 0.99), distribution->max, last ? "" : ",");
+}
+
+// Function to write the statistics as JSON; returns false if the file cannot be written
+bool statsWriteJson(const StatsAccumulator *stats, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+    fprintf(file, "{\n  \"games\": %ld,\n  \"seats\": %d,\n  \"winsBySeat\": [", stats->games, stats->players);
+    for (int p = 0; p < stats->players; p++) {
+        fprintf(file, "%s%ld", p > 0 ? ", " : "", stats->winsBySeat[p]);
+    }
+    fprintf(file, "],\n  \"distributions\": {\n");
+    writeDistributionJson(file, "turnsPerGame", &stats->gameTurns, false);
+    writeDistributionJson(file, "capturesPerGame", &stats->captures, false);
+    writeDistributionJson(file, "yardStintTurns", &stats->yardStints, true);
+    fprintf(file, "  },\n  \"forfeits\": %ld,\n  \"gamesWithForfeit\": %ld,\n  \"yardShare\": %.6f\n}\n",
+            stats->forfeits, stats->gamesWithForfeit,
+            stats->tokenTurns > 0 ? (double)stats->yardTokenTurns / stats->tokenTurns : 0.0);
+    fclose(file);
+    return true;
+}
+
+#endif
@@ -0,0 +1,252 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+#include <atomic>
+
+/*
+ * Hot-path instrumentation, compiled in with -DLUDO_INSTRUMENT.
+ * Each thread records into its own slot: latency histograms with one bucket
+ * per power of two nanoseconds, and event counters. Only the owning thread
+ * writes a slot, so recording is a clock read and a few uncontended
+ * stores. Reports merge every slot. Without LUDO_INSTRUMENT the macros and
+ * lock wrappers compile to the plain calls.
+ */
+
+// Timed phases
+enum {
+    PHASE_DICE_ROLL,
+    PHASE_PROCESS_DICE_ROLL,
+    PHASE_MOVE_TOKEN,
+    PHASE_ELIMINATE_OPPONENT,
+    PHASE_DISPLAY_BOARD,
+    PHASE_LOCK_WAIT, // Time to acquire gameStatus.mutexLock
+    PHASE_LOCK_HOLD, // Time mutexLock is held (waits on a condition excluded)
+    PHASE_COUNT
+};
+
+// Counted events
+enum {
+    COUNTER_LOCK_ACQUISITIONS, // mutexLock acquisitions, including after condition waits
+    COUNTER_WASTED_WAKEUPS,    // Player wake-ups that found it was not their turn
+    COUNTER_COUNT
+};
+
+#define HISTOGRAM_BUCKETS 40     // Bucket b holds latencies in [2^(b-1), 2^b) ns
+#define MAX_INSTRUMENTED_THREADS 256
+
+typedef struct {
+    std::atomic<long> buckets[PHASE_COUNT][HISTOGRAM_BUCKETS]; // Latency histogram per phase
+    std::atomic<long> calls[PHASE_COUNT];                      // Samples per phase
+    std::atomic<long long> totalNs[PHASE_COUNT];               // Sum of latencies per phase
+    std::atomic<long long> maxNs[PHASE_COUNT];                 // Worst latency per phase
+    std::atomic<long> counters[COUNTER_COUNT];                 // Event counts
+} ThreadStats;
+
+// Merged view of every thread's slot
+typedef struct {
+    long buckets[PHASE_COUNT][HISTOGRAM_BUCKETS];
+    long calls[PHASE_COUNT];
+    long long totalNs[PHASE_COUNT];
+    long long maxNs[PHASE_COUNT];
+    long counters[COUNTER_COUNT];
+    int threads;
+} MergedStats;
+
+#ifdef LUDO_INSTRUMENT
+
+static const char *phaseNames[PHASE_COUNT] = {
+    "diceRoll", "processDiceRoll", "moveToken", "eliminateOpponent", "displayBoard", "lockWait", "lockHold"
+};
+static const char *counterNames[COUNTER_COUNT] = { "lockAcquisitions", "wastedWakeups" };
+
+static ThreadStats instrumentSlots[MAX_INSTRUMENTED_THREADS];
+static std::atomic<int> instrumentSlotCount(0);
+static thread_local ThreadStats *threadStats = NULL;
+static thread_local long long lockAcquiredNs = 0;
+
+static inline long long instrumentClockNs() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+// Function to get the calling thread's slot, claiming one on first use.
+// Threads past MAX_INSTRUMENTED_THREADS share the last slot.
+static inline ThreadStats *currentThreadStats() {
+    if (!threadStats) {
+        int slot = instrumentSlotCount.fetch_add(1);
+        if (slot >= MAX_INSTRUMENTED_THREADS) slot = MAX_INSTRUMENTED_THREADS - 1;
+        threadStats = &instrumentSlots[slot];
+    }
+    return threadStats;
+}
+
+// Single-writer add: a relaxed load and store, no locked instruction
+template <typename T>
+static inline void slotAdd(std::atomic<T> &value, T amount) {
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+static inline int histogramBucket(long long ns) {
+    int bucket = ns > 0 ? 64 - __builtin_clzll((unsigned long long)ns) : 0;
+    return bucket < HISTOGRAM_BUCKETS ? bucket : HISTOGRAM_BUCKETS - 1;
+}
+
+// Function to record one latency sample for a phase
+static inline void recordPhase(int phase, long long ns) {
+    ThreadStats *stats = currentThreadStats();
+    slotAdd(stats->buckets[phase][histogramBucket(ns)], 1L);
+    slotAdd(stats->calls[phase], 1L);
+    slotAdd(stats->totalNs[phase], ns);
+    if (ns > stats->maxNs[phase].load(std::memory_order_relaxed)) {
+        stats->maxNs[phase].store(ns, std::memory_order_relaxed);
+    }
+}
+
+static inline void countEvent(int counter) {
+    slotAdd(currentThreadStats()->counters[counter], 1L);
+}
+
+// Times the enclosing scope, however it is left
+struct PhaseTimer {
+    int phase;
+    long long startNs;
+    PhaseTimer(int timedPhase) : phase(timedPhase), startNs(instrumentClockNs()) {}
+    ~PhaseTimer() { recordPhase(phase, instrumentClockNs() - startNs); }
+};
+
+#define INSTRUMENT_SCOPE(phase) PhaseTimer phaseTimer(phase)
+#define INSTRUMENT_COUNT(counter) countEvent(counter)
+
+// Function to lock a mutex, recording the wait and starting the hold time
+static inline void instrumentedLock(pthread_mutex_t *lock) {
+    long long startNs = instrumentClockNs();
+    pthread_mutex_lock(lock);
+    lockAcquiredNs = instrumentClockNs();
+    recordPhase(PHASE_LOCK_WAIT, lockAcquiredNs - startNs);
+    countEvent(COUNTER_LOCK_ACQUISITIONS);
+}
+
+// Function to unlock a mutex, recording the hold time
+static inline void instrumentedUnlock(pthread_mutex_t *lock) {
+    recordPhase(PHASE_LOCK_HOLD, instrumentClockNs() - lockAcquiredNs);
+    pthread_mutex_unlock(lock);
+}
+
+// Function to wait on a condition; the sleep counts as neither wait nor hold
+static inline void instrumentedWait(pthread_cond_t *condition, pthread_mutex_t *lock) {
+    recordPhase(PHASE_LOCK_HOLD, instrumentClockNs() - lockAcquiredNs);
+    pthread_cond_wait(condition, lock);
+    lockAcquiredNs = instrumentClockNs();
+    countEvent(COUNTER_LOCK_ACQUISITIONS);
+}
+
+// Function to merge every thread's slot
+void instrumentMerge(MergedStats *merged) {
+    *merged = MergedStats();
+    int slots = instrumentSlotCount.load();
+    if (slots > MAX_INSTRUMENTED_THREADS) slots = MAX_INSTRUMENTED_THREADS;
+    merged->threads = slots;
+
+    for (int t = 0; t < slots; t++) {
+        ThreadStats *stats = &instrumentSlots[t];
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+                merged->buckets[p][b] += stats->buckets[p][b].load(std::memory_order_relaxed);
+            }
+            merged->calls[p] += stats->calls[p].load(std::memory_order_relaxed);
+            merged->totalNs[p] += stats->totalNs[p].load(std::memory_order_relaxed);
+            long long maxNs = stats->maxNs[p].load(std::memory_order_relaxed);
+            if (maxNs > merged->maxNs[p]) merged->maxNs[p] = maxNs;
+        }
+        for (int c = 0; c < COUNTER_COUNT; c++) {
+            merged->counters[c] += stats->counters[c].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+// Function to estimate a percentile as the upper edge of its histogram bucket
+long long mergedPercentileNs(const MergedStats *merged, int phase, double fraction) {
+    long target = (long)(merged->calls[phase] * fraction);
+    long seen = 0;
+    for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+        seen += merged->buckets[phase][b];
+        if (seen > target) return 1LL << b;
+    }
+    return merged->maxNs[phase];
+}
+
+// Function to print the merged report
+void instrumentPrintReport() {
+    MergedStats merged;
+    instrumentMerge(&merged);
+
+    printf("=== INSTRUMENTATION (%d threads) ===\n", merged.threads);
+    printf("%-18s %10s %10s %10s %10s %12s\n", "phase", "calls", "mean ns", "p50 ns", "p99 ns", "max ns");
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        if (merged.calls[p] == 0) continue;
+        printf("%-18s %10ld %10.0f %10lld %10lld %12lld\n", phaseNames[p], merged.calls[p],
+               (double)merged.totalNs[p] / merged.calls[p], mergedPercentileNs(&merged, p, 0.50),
+               mergedPercentileNs(&merged, p, 0.99), merged.maxNs[p]);
+    }
+    for (int c = 0; c < COUNTER_COUNT; c++) {
+        printf("%s: %ld\n", counterNames[c], merged.counters[c]);
+    }
+}
+
+// Function to write the merged report as JSON; returns false if the file cannot be written
+bool instrumentWriteJson(const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+
+    MergedStats merged;
+    instrumentMerge(&merged);
+
+    fprintf(file, "{\n  \"threads\": %d,\n  \"phases\": {\n", merged.threads);
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        fprintf(file, "    \"%s\": {\"calls\": %ld, \"totalNs\": %lld, \"maxNs\": %lld, "
+                      "\"p50Ns\": %lld, \"p99Ns\": %lld, \"histogramLog2Ns\": [",
+                phaseNames[p], merged.calls[p], merged.totalNs[p], merged.maxNs[p],
+                mergedPercentileNs(&merged, p, 0.50), mergedPercentileNs(&merged, p, 0.99));
+        for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+            fprintf(file, "%s%ld", b > 0 ? ", " : "", merged.buckets[p][b]);
+        }
+        fprintf(file, "]}%s\n", p + 1 < PHASE_COUNT ? "," : "");
+    }
+    fprintf(file, "  },\n  \"counters\": {");
+    for (int c = 0; c < COUNTER_COUNT; c++) {
+        fprintf(file, "%s\"%s\": %ld", c > 0 ? ", " : "", counterNames[c], merged.counters[c]);
+    }
+    fprintf(file, "}\n}\n");
+    fclose(file);
+    return true;
+}
+
+#else
+
+#define INSTRUMENT_SCOPE(phase) ((void)0)
+#define INSTRUMENT_COUNT(counter) ((void)0)
+
+static inline void instrumentedLock(pthread_mutex_t *lock) { pthread_mutex_lock(lock); }
+static inline void instrumentedUnlock(pthread_mutex_t *lock) { pthread_mutex_unlock(lock); }
+static inline void instrumentedWait(pthread_cond_t *condition, pthread_mutex_t *lock) {
+    pthread_cond_wait(condition, lock);
+}
+
+inline void instrumentPrintReport() {}
+
+inline bool instrumentWriteJson(const char *path) {
+    fprintf(stderr, "%s not written: build with -DLUDO_INSTRUMENT\n", path);
+    return false;
+}
+
+#endif
+
+#endif
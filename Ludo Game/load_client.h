@@ -0,0 +1,309 @@
+#ifndef LOAD_CLIENT_H
+#define LOAD_CLIENT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include "game_server.h"
+
+/*
+ * Load generator for the game server.
+ * Opens a number of connections, keeps a number of games running on each
+ * and plays the client seats with random choices. Every game is mirrored
+ * from the TURN deltas alone; each CHOOSE is checked against the moves the
+ * mirror generates and each GAME_OVER against the mirror's ranks, so any
+ * lost or wrong delta shows up as a desync. Move latency is the time from
+ * sending a MOVE to receiving the TURN it produced.
+ */
+
+#define LOAD_INPUT_SIZE 65536
+#define MAX_LATENCY_SAMPLES (8 << 20)
+
+typedef struct {
+    uint32_t gameId;        // Server id of the game in this slot
+    bool active;            // Joined and not finished
+    PackedGameState state;  // Mirror built from TURN deltas
+    long long moveSentNs;   // Time the pending MOVE was sent (0 = none)
+} LoadGame;
+
+typedef struct {
+    int fd;
+    LoadGame *games;        // One slot per concurrent game; the slot is the JOIN tag
+    int gameSlots;
+    uint32_t *tableIds;     // Open addressing map from game id to slot + 1
+    int *tableSlots;
+    int tableMask;
+    uint8_t input[LOAD_INPUT_SIZE];
+    int inputLength;
+    WireMessage *output;    // Messages to send at the end of the pass
+    int outputCount;
+    int joinsLeft;          // Games this connection still has to start
+    int gamesRunning;
+} LoadConnection;
+
+typedef struct {
+    long gamesFinished;
+    long moves;
+    long turns;
+    long desyncs;
+    long messagesIn;
+    long long *latencies;
+    long latencyCount;
+} LoadStats;
+
+static inline uint32_t loadTableHash(uint32_t id, int mask) {
+    return (id * 0x9E3779B1u) & (uint32_t)mask;
+}
+
+static void loadTableInsert(LoadConnection *connection, uint32_t id, int slot) {
+    uint32_t i = loadTableHash(id, connection->tableMask);
+    while (connection->tableSlots[i] != 0) i = (i + 1) & connection->tableMask;
+    connection->tableIds[i] = id;
+    connection->tableSlots[i] = slot + 1;
+}
+
+static int loadTableFind(const LoadConnection *connection, uint32_t id) {
+    uint32_t i = loadTableHash(id, connection->tableMask);
+    while (connection->tableSlots[i] != 0) {
+        if (connection->tableIds[i] == id) return (int)i;
+        i = (i + 1) & connection->tableMask;
+    }
+    return -1;
+}
+
+// Function to delete a map entry, shifting later entries of the probe run back
+static void loadTableRemove(LoadConnection *connection, int position) {
+    uint32_t i = (uint32_t)position;
+    connection->tableSlots[i] = 0;
+    uint32_t j = i;
+    while (true) {
+        j = (j + 1) & connection->tableMask;
+        if (connection->tableSlots[j] == 0) return;
+
+        uint32_t home = loadTableHash(connection->tableIds[j], connection->tableMask);
+        bool movable = (j > i) ? (home <= i || home > j) : (home <= i && home > j);
+        if (movable) {
+            connection->tableIds[i] = connection->tableIds[j];
+            connection->tableSlots[i] = connection->tableSlots[j];
+            connection->tableSlots[j] = 0;
+            i = j;
+        }
+    }
+}
+
+static void loadQueue(LoadConnection *connection, uint8_t type, uint8_t seat, uint8_t arg, uint8_t flags,
+                      uint32_t gameId, uint32_t payload) {
+    WireMessage message = { type, seat, arg, flags, gameId, payload };
+    connection->output[connection->outputCount++] = message;
+}
+
+// Function to send everything queued on a connection, waiting while the socket is full
+static bool loadFlush(LoadConnection *connection) {
+    const uint8_t *data = (const uint8_t *)connection->output;
+    size_t length = connection->outputCount * sizeof(WireMessage);
+    size_t sent = 0;
+    while (sent < length) {
+        ssize_t written = send(connection->fd, data + sent, length - sent, MSG_NOSIGNAL);
+        if (written > 0) {
+            sent += written;
+        } else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            struct pollfd writable = { connection->fd, POLLOUT, 0 };
+            poll(&writable, 1, 100);
+        } else {
+            return false;
+        }
+    }
+    connection->outputCount = 0;
+    return true;
+}
+
+// Function to handle one server message on a load connection
+static void loadHandleMessage(LoadConnection *connection, const WireMessage *message, int seatsPerGame,
+                              DiceRng *rng, LoadStats *stats) {
+    if (message->type == MSG_JOINED) {
+        int slot = (int)message->payload;
+        LoadGame *game = &connection->games[slot];
+        game->gameId = message->gameId;
+        game->active = true;
+        game->moveSentNs = 0;
+        packedResetState(&game->state);
+        loadTableInsert(connection, message->gameId, slot);
+        connection->gamesRunning++;
+        return;
+    }
+
+    int position = loadTableFind(connection, message->gameId);
+    if (position < 0) {
+        stats->desyncs++;
+        return;
+    }
+    int slot = connection->tableSlots[position] - 1;
+    LoadGame *game = &connection->games[slot];
+
+    if (message->type == MSG_TURN) {
+        if (game->moveSentNs != 0) {
+            if (stats->latencyCount < MAX_LATENCY_SAMPLES) {
+                stats->latencies[stats->latencyCount++] = serverClockNs() - game->moveSentNs;
+            }
+            game->moveSentNs = 0;
+        }
+        eventLogApply(&game->state, (LogEvent)message->payload);
+        stats->turns++;
+    } else if (message->type == MSG_CHOOSE) {
+        // The mirror must offer exactly the moves the server offers
+        OccupancyIndex occupancy;
+        PackedMove moves[TOKENS_PER_PLAYER];
+        occupancyBuild(&occupancy, &game->state);
+        int count = generateMoves(&game->state, &occupancy, message->arg, moves);
+        bool matches = game->state.currentTurn == message->seat && count == message->flags;
+        for (int i = 0; matches && i < count; i++) {
+            matches = moves[i].token == ((message->payload >> (8 * i)) & 0xFF);
+        }
+        if (!matches) stats->desyncs++;
+
+        int choice = (int)diceRngBelow(rng, message->flags);
+        loadQueue(connection, MSG_MOVE, message->seat, (uint8_t)choice, 0, message->gameId, 0);
+        game->moveSentNs = serverClockNs();
+        stats->moves++;
+    } else if (message->type == MSG_GAME_OVER) {
+        if (message->payload != game->state.ranks) stats->desyncs++;
+        loadTableRemove(connection, position);
+        game->active = false;
+        connection->gamesRunning--;
+        stats->gamesFinished++;
+
+        if (connection->joinsLeft > 0) {
+            connection->joinsLeft--;
+            loadQueue(connection, MSG_JOIN, 0, (uint8_t)seatsPerGame,
+                      seatsPerGame < MAX_PLAYERS ? JOIN_FILL_BOTS : 0, 0, (uint32_t)slot);
+        }
+    }
+}
+
+// Function to play games against a server and report throughput and move
+// latency; returns false if it cannot connect
+bool runLoadClient(const char *address, int gameCount, int connectionCount, int concurrentGames,
+                   int seatsPerGame, uint64_t seed) {
+    if (connectionCount < 1) connectionCount = 1;
+    if (concurrentGames < 1) concurrentGames = 1;
+    if (seatsPerGame < 1 || seatsPerGame > MAX_PLAYERS) seatsPerGame = MAX_PLAYERS;
+
+    LoadConnection *connections = (LoadConnection *)calloc(connectionCount, sizeof(LoadConnection));
+    LoadStats stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.latencies = (long long *)malloc(MAX_LATENCY_SAMPLES * sizeof(long long));
+    DiceRng rng;
+    diceRngSeed(&rng, seed);
+
+    int epollFd = epoll_create1(0);
+    int tableSize = 4;
+    while (tableSize < concurrentGames * 2) tableSize *= 2;
+
+    long long startNs = serverClockNs();
+    for (int c = 0; c < connectionCount; c++) {
+        LoadConnection *connection = &connections[c];
+        connection->fd = serverConnect(address);
+        if (connection->fd < 0) {
+            for (int k = 0; k < c; k++) close(connections[k].fd);
+            free(connections);
+            free(stats.latencies);
+            close(epollFd);
+            return false;
+        }
+        setNonBlocking(connection->fd);
+        connection->gameSlots = concurrentGames;
+        connection->games = (LoadGame *)calloc(concurrentGames, sizeof(LoadGame));
+        connection->tableMask = tableSize - 1;
+        connection->tableIds = (uint32_t *)calloc(tableSize, sizeof(uint32_t));
+        connection->tableSlots = (int *)calloc(tableSize, sizeof(int));
+        // One reply at most per message in a full input buffer, or the first JOINs
+        connection->output = (WireMessage *)malloc((LOAD_INPUT_SIZE / sizeof(WireMessage) + concurrentGames) *
+                                                   sizeof(WireMessage));
+        connection->joinsLeft = gameCount / connectionCount + (c < gameCount % connectionCount ? 1 : 0);
+
+        for (int slot = 0; slot < concurrentGames && connection->joinsLeft > 0; slot++) {
+            connection->joinsLeft--;
+            loadQueue(connection, MSG_JOIN, 0, (uint8_t)seatsPerGame,
+                      seatsPerGame < MAX_PLAYERS ? JOIN_FILL_BOTS : 0, 0, (uint32_t)slot);
+        }
+        loadFlush(connection);
+
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = connection;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, connection->fd, &event);
+    }
+
+    // Messages are answered in bulk: every MOVE produced while reading goes out in one send per connection
+    bool failed = false;
+    struct epoll_event events[64];
+    while (!failed && stats.gamesFinished < gameCount) {
+        int ready = epoll_wait(epollFd, events, 64, 5000);
+        if (ready == 0) {
+            printf("Load test stalled: no message for 5 s\n");
+            failed = true;
+        }
+        for (int i = 0; i < ready; i++) {
+            LoadConnection *connection = (LoadConnection *)events[i].data.ptr;
+            ssize_t received = read(connection->fd, connection->input + connection->inputLength,
+                                    LOAD_INPUT_SIZE - connection->inputLength);
+            if (received <= 0) {
+                if (received < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+                printf("Server closed the connection\n");
+                failed = true;
+                break;
+            }
+            connection->inputLength += (int)received;
+
+            int offset = 0;
+            while (connection->inputLength - offset >= (int)sizeof(WireMessage)) {
+                WireMessage message;
+                memcpy(&message, connection->input + offset, sizeof(message));
+                offset += sizeof(message);
+                stats.messagesIn++;
+                loadHandleMessage(connection, &message, seatsPerGame, &rng, &stats);
+            }
+            memmove(connection->input, connection->input + offset, connection->inputLength - offset);
+            connection->inputLength -= offset;
+            if (connection->outputCount > 0 && !loadFlush(connection)) failed = true;
+        }
+    }
+    double elapsed = (serverClockNs() - startNs) / 1e9;
+
+    qsort(stats.latencies, stats.latencyCount, sizeof(long long), [](const void *a, const void *b) {
+        long long x = *(const long long *)a, y = *(const long long *)b;
+        return (x > y) - (x < y);
+    });
+    double p50 = stats.latencyCount > 0 ? stats.latencies[stats.latencyCount / 2] / 1000.0 : 0.0;
+    double p99 = stats.latencyCount > 0 ? stats.latencies[stats.latencyCount * 99 / 100] / 1000.0 : 0.0;
+    double worst = stats.latencyCount > 0 ? stats.latencies[stats.latencyCount - 1] / 1000.0 : 0.0;
+
+    printf("=== LOAD TEST (%d connections, %d concurrent games each, %d client seats per game) ===\n",
+           connectionCount, concurrentGames, seatsPerGame);
+    printf("Games finished: %ld in %.3f s (%.0f games/sec)\n", stats.gamesFinished, elapsed,
+           elapsed > 0 ? stats.gamesFinished / elapsed : 0.0);
+    printf("Client moves: %ld (%.0f moves/sec), turns streamed: %ld (%.0f turns/sec)\n", stats.moves,
+           elapsed > 0 ? stats.moves / elapsed : 0.0, stats.turns, elapsed > 0 ? stats.turns / elapsed : 0.0);
+    printf("Move latency: p50 %.1f us, p99 %.1f us, max %.1f us\n", p50, p99, worst);
+    printf("Messages received: %ld, mirrored state desyncs: %ld\n", stats.messagesIn, stats.desyncs);
+
+    for (int c = 0; c < connectionCount; c++) {
+        close(connections[c].fd);
+        free(connections[c].games);
+        free(connections[c].tableIds);
+        free(connections[c].tableSlots);
+        free(connections[c].output);
+    }
+    free(connections);
+    free(stats.latencies);
+    close(epollFd);
+    return !failed;
+}
+
+#endif
@@ -0,0 +1,413 @@
+#ifndef LOCKSTEP_BATCH_H
+#define LOCKSTEP_BATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "packed_state.h"
+#include "dice_rng.h"
+
+/*
+ * Lockstep batch simulation of standard games.
+ * LANE_COUNT games are played side by side, one per lane, with the state
+ * kept struct-of-arrays: byte k of tokens[t] is the progress of token t in
+ * the game on lane k. Every step plays one turn in every lane with vector
+ * code: picking the mover's tokens, listing legal moves, route lookup,
+ * capture detection against all opponents' tokens, finishing and ranking.
+ * Only the dice and the random token pick stay scalar, since each lane's
+ * generator is drawn a different number of times. A lane whose game ends
+ * is handed the next game at once, so the lanes stay busy.
+ *
+ * The rules and the order of random draws are those of packedPlayTurn, so
+ * game g ends in the same PackedGameState as playPackedGame seeded with
+ * baseSeed + g.
+ *
+ * Lane vectors are AVX2 (32 lanes) or SSE2 (16 lanes) registers; with
+ * neither, or with LUDO_NO_SIMD defined, plain byte loops are used.
+ * Progress values are below 128, so signed byte compares are safe.
+ */
+
+#if defined(__AVX2__) && !defined(LUDO_NO_SIMD)
+#include <immintrin.h>
+#define LANE_COUNT 32
+#define LANE_ISA "AVX2"
+typedef __m256i LaneVector;
+
+static inline LaneVector laneLoad(const uint8_t *bytes) { return _mm256_loadu_si256((const __m256i *)bytes); }
+static inline void laneStore(uint8_t *bytes, LaneVector v) { _mm256_storeu_si256((__m256i *)bytes, v); }
+static inline LaneVector laneSplat(int value) { return _mm256_set1_epi8((char)value); }
+static inline LaneVector laneAdd(LaneVector a, LaneVector b) { return _mm256_add_epi8(a, b); }
+static inline LaneVector laneAddSaturate(LaneVector a, LaneVector b) { return _mm256_adds_epu8(a, b); }
+static inline LaneVector laneSub(LaneVector a, LaneVector b) { return _mm256_sub_epi8(a, b); }
+static inline LaneVector laneAnd(LaneVector a, LaneVector b) { return _mm256_and_si256(a, b); }
+static inline LaneVector laneOr(LaneVector a, LaneVector b) { return _mm256_or_si256(a, b); }
+static inline LaneVector laneAndNot(LaneVector a, LaneVector b) { return _mm256_andnot_si256(b, a); } // a & ~b
+static inline LaneVector laneEq(LaneVector a, LaneVector b) { return _mm256_cmpeq_epi8(a, b); }
+static inline LaneVector laneGt(LaneVector a, LaneVector b) { return _mm256_cmpgt_epi8(a, b); }
+static inline LaneVector laneSelect(LaneVector mask, LaneVector a, LaneVector b) { return _mm256_blendv_epi8(b, a, mask); }
+static inline uint32_t laneBits(LaneVector mask) { return (uint32_t)_mm256_movemask_epi8(mask); }
+
+#elif defined(__SSE2__) && !defined(LUDO_NO_SIMD)
+#include <emmintrin.h>
+#define LANE_COUNT 16
+#define LANE_ISA "SSE2"
+typedef __m128i LaneVector;
+
+static inline LaneVector laneLoad(const uint8_t *bytes) { return _mm_loadu_si128((const __m128i *)bytes); }
+static inline void laneStore(uint8_t *bytes, LaneVector v) { _mm_storeu_si128((__m128i *)bytes, v); }
+static inline LaneVector laneSplat(int value) { return _mm_set1_epi8((char)value); }
+static inline LaneVector laneAdd(LaneVector a, LaneVector b) { return _mm_add_epi8(a, b); }
+static inline LaneVector laneAddSaturate(LaneVector a, LaneVector b) { return _mm_adds_epu8(a, b); }
+static inline LaneVector laneSub(LaneVector a, LaneVector b) { return _mm_sub_epi8(a, b); }
+static inline LaneVector laneAnd(LaneVector a, LaneVector b) { return _mm_and_si128(a, b); }
+static inline LaneVector laneOr(LaneVector a, LaneVector b) { return _mm_or_si128(a, b); }
+static inline LaneVector laneAndNot(LaneVector a, LaneVector b) { return _mm_andnot_si128(b, a); } // a & ~b
+static inline LaneVector laneEq(LaneVector a, LaneVector b) { return _mm_cmpeq_epi8(a, b); }
+static inline LaneVector laneGt(LaneVector a, LaneVector b) { return _mm_cmpgt_epi8(a, b); }
+static inline LaneVector laneSelect(LaneVector mask, LaneVector a, LaneVector b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+static inline uint32_t laneBits(LaneVector mask) { return (uint32_t)_mm_movemask_epi8(mask); }
+
+#else
+#define LANE_COUNT 16
+#define LANE_ISA "scalar"
+typedef struct { uint8_t lane[LANE_COUNT]; } LaneVector;
+
+#define LANE_MAP(expression)                                        \
+    LaneVector r;                                                   \
+    for (int k = 0; k < LANE_COUNT; k++) r.lane[k] = (uint8_t)(expression); \
+    return r
+
+static inline LaneVector laneLoad(const uint8_t *bytes) { LaneVector r; memcpy(r.lane, bytes, LANE_COUNT); return r; }
+static inline void laneStore(uint8_t *bytes, LaneVector v) { memcpy(bytes, v.lane, LANE_COUNT); }
+static inline LaneVector laneSplat(int value) { LANE_MAP(value); }
+static inline LaneVector laneAdd(LaneVector a, LaneVector b) { LANE_MAP(a.lane[k] + b.lane[k]); }
+static inline LaneVector laneAddSaturate(LaneVector a, LaneVector b) { LANE_MAP(a.lane[k] + b.lane[k] > 255 ? 255 : a.lane[k] + b.lane[k]); }
+static inline LaneVector laneSub(LaneVector a, LaneVector b) { LANE_MAP(a.lane[k] - b.lane[k]); }
+static inline LaneVector laneAnd(LaneVector a, LaneVector b) { LANE_MAP(a.lane[k] & b.lane[k]); }
+static inline LaneVector laneOr(LaneVector a, LaneVector b) { LANE_MAP(a.lane[k] | b.lane[k]); }
+static inline LaneVector laneAndNot(LaneVector a, LaneVector b) { LANE_MAP(a.lane[k] & ~b.lane[k]); }
+static inline LaneVector laneEq(LaneVector a, LaneVector b) { LANE_MAP(a.lane[k] == b.lane[k] ? 0xFF : 0); }
+static inline LaneVector laneGt(LaneVector a, LaneVector b) { LANE_MAP((int8_t)a.lane[k] > (int8_t)b.lane[k] ? 0xFF : 0); }
+static inline LaneVector laneSelect(LaneVector mask, LaneVector a, LaneVector b) { LANE_MAP((mask.lane[k] & a.lane[k]) | (~mask.lane[k] & b.lane[k])); }
+static inline uint32_t laneBits(LaneVector mask) {
+    uint32_t bits = 0;
+    for (int k = 0; k < LANE_COUNT; k++) bits |= (uint32_t)(mask.lane[k] >> 7) << k;
+    return bits;
+}
+#undef LANE_MAP
+#endif
+
+#define LANE_NO_PICK 0xFF
+#define LANE_ENTRY_CELLS 2 // Track progress values from which a seat enters its home path
+
+// The board's routes in the form the lanes use: start cells, home entries and safe cells
+typedef struct {
+    uint8_t start[MAX_PLAYERS];                     // Track index of each seat's start cell
+    uint8_t entry[MAX_PLAYERS][LANE_ENTRY_CELLS];   // Progress values that enter the home path
+    uint8_t safe[SAFE_SPOT_COUNT];                  // Track indexes of the safe cells
+} LaneRoutes;
+
+constexpr LaneRoutes buildLaneRoutes() {
+    LaneRoutes routes = {};
+    int safeCount = 0;
+    for (int i = 0; i < TRACK_LENGTH; i++) {
+        if (routeTables.safeTrack[i] && safeCount < SAFE_SPOT_COUNT) routes.safe[safeCount++] = (uint8_t)i;
+    }
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        routes.start[p] = routeTables.trackIndex[p][PROGRESS_TRACK];
+        int entries = 0;
+        for (int progress = PROGRESS_TRACK; progress < PROGRESS_HOME; progress++) {
+            if (routeTables.canEnterHome[p][progress] && entries < LANE_ENTRY_CELLS) {
+                routes.entry[p][entries++] = (uint8_t)progress;
+            }
+        }
+        while (entries < LANE_ENTRY_CELLS) routes.entry[p][entries++] = routes.entry[p][0];
+    }
+    return routes;
+}
+
+// Function to check the lane routes describe the board's route tables exactly
+constexpr bool laneRoutesMatchBoard() {
+    LaneRoutes routes = buildLaneRoutes();
+    int safeCount = 0;
+    for (int i = 0; i < TRACK_LENGTH; i++) {
+        if (routeTables.safeTrack[i]) safeCount++;
+    }
+    if (safeCount != SAFE_SPOT_COUNT) return false;
+
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        for (int progress = PROGRESS_TRACK; progress < PROGRESS_HOME; progress++) {
+            bool entry = false;
+            for (int e = 0; e < LANE_ENTRY_CELLS; e++) entry = entry || routes.entry[p][e] == progress;
+            if (entry != routeTables.canEnterHome[p][progress]) return false;
+        }
+    }
+    return true;
+}
+
+constexpr LaneRoutes laneRoutes = buildLaneRoutes();
+static_assert(laneRoutesMatchBoard(), "Lane routes differ from the board's route tables");
+
+// LANE_COUNT games, struct-of-arrays
+typedef struct {
+    alignas(32) uint8_t tokens[TOTAL_TOKENS][LANE_COUNT];    // Progress of every token
+    alignas(32) uint8_t currentTurn[LANE_COUNT];             // Player to move (0-based)
+    alignas(32) uint8_t sixCounts[MAX_PLAYERS][LANE_COUNT];  // Consecutive sixes
+    alignas(32) uint8_t ranks[MAX_PLAYERS][LANE_COUNT];      // Finishing rank (0 = unranked)
+    alignas(32) uint8_t killCounts[MAX_PLAYERS][LANE_COUNT]; // Tokens eliminated (saturates at 255)
+    alignas(32) uint8_t rolls[LANE_COUNT];                   // Dice value of the current step
+    alignas(32) uint8_t trackMasks[LANE_COUNT];              // Mover's tokens on the track, one bit each
+    alignas(32) uint8_t picks[LANE_COUNT];                   // Randomly picked token, or LANE_NO_PICK
+    uint32_t turns[LANE_COUNT];                              // Turns played in each lane's game
+    long games[LANE_COUNT];                                  // Game on each lane (-1 = idle)
+    DiceRng rng[LANE_COUNT];                                 // Each game's own generator
+} LaneBatch;
+
+// Function to start game g on a lane
+static void laneStartGame(LaneBatch *batch, int lane, long game, uint64_t baseSeed) {
+    for (int t = 0; t < TOTAL_TOKENS; t++) batch->tokens[t][lane] = PROGRESS_YARD;
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        batch->sixCounts[p][lane] = 0;
+        batch->ranks[p][lane] = 0;
+        batch->killCounts[p][lane] = 0;
+    }
+    batch->currentTurn[lane] = 0;
+    batch->turns[lane] = 0;
+    batch->games[lane] = game;
+    diceRngSeed(&batch->rng[lane], baseSeed + game);
+}
+
+// Function to copy a lane's game out as a packed state
+static void laneExport(const LaneBatch *batch, int lane, PackedGameState *state) {
+    packedResetState(state);
+    for (int t = 0; t < TOTAL_TOKENS; t++) state->tokens[t] = batch->tokens[t][lane];
+    state->currentTurn = batch->currentTurn[lane];
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        packedSetSixCount(state, p, batch->sixCounts[p][lane]);
+        packedSetRank(state, p, batch->ranks[p][lane]);
+        state->killCounts[p] = batch->killCounts[p][lane];
+    }
+}
+
+// Function to draw every lane's dice and make the random token picks, as
+// chooseRandomMove does: up to four tries at a token that can move
+static void laneDrawDice(LaneBatch *batch) {
+    for (int k = 0; k < LANE_COUNT; k++) batch->rolls[k] = (uint8_t)diceRngRoll(&batch->rng[k]);
+}
+
+static void lanePickTokens(LaneBatch *batch, uint32_t pickLanes) {
+    while (pickLanes) {
+        int k = __builtin_ctz(pickLanes);
+        pickLanes &= pickLanes - 1;
+
+        uint8_t pick = LANE_NO_PICK;
+        for (int attempts = 0; attempts < TOKENS_PER_PLAYER; attempts++) {
+            int token = (int)diceRngBelow(&batch->rng[k], TOKENS_PER_PLAYER);
+            if (batch->trackMasks[k] & (1u << token)) {
+                pick = (uint8_t)token;
+                break;
+            }
+        }
+        batch->picks[k] = pick;
+    }
+}
+
+// Function to play one turn in every lane; returns the lanes whose game just ended
+static uint32_t laneStep(LaneBatch *batch) {
+    const LaneVector zero = laneSplat(0);
+    const LaneVector one = laneSplat(1);
+    const LaneVector six = laneSplat(6);
+    const LaneVector trackEnd = laneSplat(PROGRESS_HOME);          // First progress past the track
+    const LaneVector trackLength = laneSplat(TRACK_LENGTH);
+    const LaneVector beforeFinish = laneSplat(PROGRESS_FINISHED + 1);
+    const LaneVector finished = laneSplat(PROGRESS_FINISHED);
+
+    laneDrawDice(batch);
+    LaneVector roll = laneLoad(batch->rolls);
+    LaneVector turn = laneLoad(batch->currentTurn);
+    LaneVector isSix = laneEq(roll, six);
+
+    // The mover's seat, start cell, home entries, sixes and tokens, picked per lane
+    LaneVector isMover[MAX_PLAYERS];
+    LaneVector start = zero, entryA = zero, entryB = zero, sixes = zero, rank = zero;
+    LaneVector mover[TOKENS_PER_PLAYER] = {};
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        isMover[p] = laneEq(turn, laneSplat(p));
+        start = laneOr(start, laneAnd(isMover[p], laneSplat(laneRoutes.start[p])));
+        entryA = laneOr(entryA, laneAnd(isMover[p], laneSplat(laneRoutes.entry[p][0])));
+        entryB = laneOr(entryB, laneAnd(isMover[p], laneSplat(laneRoutes.entry[p][1])));
+        sixes = laneOr(sixes, laneAnd(isMover[p], laneLoad(batch->sixCounts[p])));
+        rank = laneOr(rank, laneAnd(isMover[p], laneLoad(batch->ranks[p])));
+        for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
+            mover[j] = laneOr(mover[j], laneAnd(isMover[p], laneLoad(batch->tokens[p * TOKENS_PER_PLAYER + j])));
+        }
+    }
+
+    // Legal moves: a six releases the first yard token; other rolls must
+    // advance the first home path token that can move, else any track token
+    LaneVector release[TOKENS_PER_PLAYER], homeMove[TOKENS_PER_PLAYER], onTrack[TOKENS_PER_PLAYER];
+    LaneVector anyYard = zero, anyHome = zero, trackMask = zero;
+    for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
+        LaneVector inYard = laneEq(mover[j], zero);
+        release[j] = laneAndNot(inYard, anyYard);
+        anyYard = laneOr(anyYard, inYard);
+
+        LaneVector homeCanMove = laneAnd(laneGt(mover[j], laneSub(trackEnd, one)),
+                                         laneGt(beforeFinish, laneAdd(mover[j], roll)));
+        homeMove[j] = laneAndNot(homeCanMove, anyHome);
+        anyHome = laneOr(anyHome, homeCanMove);
+
+        onTrack[j] = laneAnd(laneGt(mover[j], zero), laneGt(trackEnd, mover[j]));
+        trackMask = laneOr(trackMask, laneAnd(onTrack[j], laneSplat(1 << j)));
+    }
+    LaneVector trackTurn = laneAndNot(laneAndNot(laneGt(trackMask, zero), isSix), anyHome);
+    laneStore(batch->trackMasks, trackMask);
+    laneStore(batch->picks, laneSplat(LANE_NO_PICK));
+    lanePickTokens(batch, laneBits(trackTurn));
+    LaneVector pick = laneLoad(batch->picks);
+
+    // The chosen move and where it lands
+    LaneVector moved = zero, landing = zero;
+    LaneVector chosen[TOKENS_PER_PLAYER];
+    LaneVector captureCandidate = zero;
+    for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
+        LaneVector picked = laneAnd(trackTurn, laneEq(pick, laneSplat(j)));
+        chosen[j] = laneOr(laneAnd(isSix, release[j]),
+                           laneOr(laneAndNot(homeMove[j], isSix), picked));
+
+        LaneVector advanced = laneAdd(mover[j], roll);
+        LaneVector wrapped = laneSelect(laneGt(advanced, trackLength), laneSub(advanced, trackLength), advanced);
+        LaneVector entersHome = laneOr(laneEq(mover[j], entryA), laneEq(mover[j], entryB));
+        LaneVector trackTarget = laneSelect(entersHome, trackEnd, wrapped);
+        LaneVector target = laneSelect(isSix, one, laneSelect(onTrack[j], trackTarget, advanced));
+
+        landing = laneSelect(chosen[j], target, landing);
+        moved = laneOr(moved, chosen[j]);
+        captureCandidate = laneOr(captureCandidate, laneAndNot(picked, entersHome));
+    }
+
+    // Captures: on an unsafe landing cell, the first opponent with a single token there loses it
+    if (laneBits(captureCandidate)) {
+        LaneVector cell = laneAdd(landing, laneSub(start, one));
+        cell = laneSelect(laneGt(cell, laneSub(trackLength, one)), laneSub(cell, trackLength), cell);
+        LaneVector safe = zero;
+        for (int s = 0; s < SAFE_SPOT_COUNT; s++) safe = laneOr(safe, laneEq(cell, laneSplat(laneRoutes.safe[s])));
+        captureCandidate = laneAndNot(captureCandidate, safe);
+
+        LaneVector matches[TOTAL_TOKENS];
+        LaneVector capture = zero;
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            LaneVector offset = laneSplat(laneRoutes.start[p] - 1);
+            LaneVector count = zero;
+            for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
+                int t = p * TOKENS_PER_PLAYER + j;
+                LaneVector progress = laneLoad(batch->tokens[t]);
+                LaneVector tokenCell = laneAdd(progress, offset);
+                tokenCell = laneSelect(laneGt(tokenCell, laneSub(trackLength, one)), laneSub(tokenCell, trackLength), tokenCell);
+                LaneVector tokenOnTrack = laneAnd(laneGt(progress, zero), laneGt(trackEnd, progress));
+                matches[t] = laneAndNot(laneAnd(tokenOnTrack, laneEq(tokenCell, cell)), isMover[p]);
+                count = laneSub(count, matches[t]);
+            }
+
+            // A lone token of this player is the victim unless an earlier player's was
+            LaneVector victims = laneAndNot(laneAnd(captureCandidate, laneEq(count, one)), capture);
+            for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
+                int t = p * TOKENS_PER_PLAYER + j;
+                matches[t] = laneAnd(matches[t], victims);
+            }
+            capture = laneOr(capture, victims);
+        }
+        if (laneBits(capture)) {
+            for (int t = 0; t < TOTAL_TOKENS; t++) {
+                laneStore(batch->tokens[t], laneAndNot(laneLoad(batch->tokens[t]), matches[t]));
+            }
+            for (int p = 0; p < MAX_PLAYERS; p++) {
+                LaneVector kills = laneLoad(batch->killCounts[p]);
+                laneStore(batch->killCounts[p], laneAddSaturate(kills, laneAnd(laneAnd(capture, isMover[p]), one)));
+            }
+        }
+    }
+
+    // Six counter: reset by any other roll, counted by a six that moves nothing, forfeited at three
+    LaneVector counted = laneAdd(sixes, one);
+    counted = laneAndNot(counted, laneEq(counted, laneSplat(3)));
+    LaneVector newSixes = laneSelect(isSix, laneSelect(moved, sixes, counted), zero);
+
+    // Write the move back, then rank the mover if all its tokens are finished
+    LaneVector allFinished = laneSplat(0xFF);
+    for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
+        mover[j] = laneSelect(chosen[j], landing, mover[j]);
+        allFinished = laneAnd(allFinished, laneEq(mover[j], finished));
+    }
+    LaneVector rankedCount = zero;
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        rankedCount = laneSub(rankedCount, laneGt(laneLoad(batch->ranks[p]), zero));
+    }
+    LaneVector newRank = laneAnd(laneAnd(allFinished, laneEq(rank, zero)), laneAdd(rankedCount, one));
+    rankedCount = laneSub(rankedCount, laneGt(newRank, zero));
+
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        for (int j = 0; j < TOKENS_PER_PLAYER; j++) {
+            uint8_t *tokens = batch->tokens[p * TOKENS_PER_PLAYER + j];
+            laneStore(tokens, laneSelect(isMover[p], mover[j], laneLoad(tokens)));
+        }
+        laneStore(batch->sixCounts[p], laneSelect(isMover[p], newSixes, laneLoad(batch->sixCounts[p])));
+        laneStore(batch->ranks[p], laneOr(laneLoad(batch->ranks[p]), laneAnd(isMover[p], newRank)));
+    }
+    laneStore(batch->currentTurn, laneAnd(laneAdd(turn, one), laneSplat(MAX_PLAYERS - 1)));
+    for (int k = 0; k < LANE_COUNT; k++) batch->turns[k]++;
+
+    return laneBits(laneGt(rankedCount, laneSplat(MAX_PLAYERS - 2)));
+}
+
+static_assert((MAX_PLAYERS & (MAX_PLAYERS - 1)) == 0, "The turn wraps with a mask");
+
+// Function to play games firstGame .. firstGame + gameCount - 1 (seeded
+// baseSeed + game) in lockstep. Final states and turn counts are stored in
+// game order; returns the turns played.
+long lanePlayGames(long firstGame, long gameCount, uint64_t baseSeed,
+                   PackedGameState *finalStates, uint32_t *turns) {
+    LaneBatch *batch = (LaneBatch *)aligned_alloc(32, (sizeof(LaneBatch) + 31) & ~(size_t)31);
+    long nextGame = firstGame;
+    long endGame = firstGame + gameCount;
+    long totalTurns = 0;
+    int activeLanes = 0;
+
+    for (int k = 0; k < LANE_COUNT; k++) {
+        if (nextGame < endGame) {
+            laneStartGame(batch, k, nextGame++, baseSeed);
+            activeLanes++;
+        } else {
+            laneStartGame(batch, k, -1, baseSeed); // Idle lanes play along and are ignored
+        }
+    }
+
+    while (activeLanes > 0) {
+        uint32_t ended = laneStep(batch);
+        while (ended) {
+            int k = __builtin_ctz(ended);
+            ended &= ended - 1;
+
+            long game = batch->games[k];
+            if (game >= 0) {
+                if (finalStates) laneExport(batch, k, &finalStates[game - firstGame]);
+                if (turns) turns[game - firstGame] = batch->turns[k];
+                totalTurns += batch->turns[k];
+                activeLanes--;
+            }
+            if (nextGame < endGame) {
+                laneStartGame(batch, k, nextGame++, baseSeed);
+                activeLanes++;
+            } else {
+                laneStartGame(batch, k, -1, baseSeed);
+            }
+        }
+    }
+
+    free(batch);
+    return totalTurns;
+}
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef OCCUPANCY_INDEX_H
+#define OCCUPANCY_INDEX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "game_rules.h"
+
+/*
+ * Per-cell occupancy of the board, kept next to a game's tokens and updated
+ * on every move. Each track cell holds a mask with bit
+ * player * tokensPerPlayer + token set for every token on it, so a
+ * player's count on a cell is the popcount of its bits, and a capture
+ * victim is found without scanning the tokens. Tokens in the yard, on the
+ * home path or finished cannot be captured and are not indexed. The index
+ * is templated on the rules variant; OccupancyIndex is the standard game's.
+ *
+ * Capture rules answered here:
+ *   - tokens on a safe spot ('S') cannot be captured
+ *   - two or more tokens of one player on a cell form a blockade and cannot
+ *     be captured
+ *   - otherwise the first opponent with a single token on the cell, in
+ *     player order, loses that token
+ */
+
+template <typename Rules>
+struct Occupancy {
+    typename Rules::TokenMask track[Rules::trackLength]; // Token mask of each track cell
+};
+
+typedef Occupancy<StandardRules> OccupancyIndex;
+
+template <typename Rules>
+inline typename Rules::TokenMask occupancyPlayerBits(int player) {
+    return (typename Rules::TokenMask)(((1u << Rules::tokensPerPlayer) - 1) << (player * Rules::tokensPerPlayer));
+}
+
+// Function to empty the index (every token in the yard)
+template <typename Rules>
+inline void occupancyClear(Occupancy<Rules> *index) {
+    memset(index, 0, sizeof(*index));
+}
+
+// Function to add a token at its route progress
+template <typename Rules>
+inline void occupancyAdd(Occupancy<Rules> *index, int player, int token, int progress) {
+    if (Rules::onTrack(progress)) {
+        index->track[ruleRoutes<Rules>.trackIndex[player][progress]] |=
+            (typename Rules::TokenMask)(1u << (player * Rules::tokensPerPlayer + token));
+    }
+}
+
+// Function to remove a token from its route progress
+template <typename Rules>
+inline void occupancyRemove(Occupancy<Rules> *index, int player, int token, int progress) {
+    if (Rules::onTrack(progress)) {
+        index->track[ruleRoutes<Rules>.trackIndex[player][progress]] &=
+            (typename Rules::TokenMask)~(1u << (player * Rules::tokensPerPlayer + token));
+    }
+}
+
+template <typename Rules>
+inline void occupancyMove(Occupancy<Rules> *index, int player, int token, int from, int to) {
+    occupancyRemove(index, player, token, from);
+    occupancyAdd(index, player, token, to);
+}
+
+// Function to get how many of a player's tokens are on a track cell
+template <typename Rules>
+inline int occupancyCount(const Occupancy<Rules> *index, int player, int trackIndex) {
+    return __builtin_popcount(index->track[trackIndex] & occupancyPlayerBits<Rules>(player));
+}
+
+// Function to find the opponent token a player captures by landing on a
+// track cell: player * tokensPerPlayer + token, or -1 if there is none
+template <typename Rules>
+inline int occupancyCaptureVictim(const Occupancy<Rules> *index, int player, int trackIndex) {
+    if (ruleRoutes<Rules>.safeTrack[trackIndex] || index->track[trackIndex] == 0) return -1;
+
+    for (int p = 0; p < Rules::players; p++) {
+        if (p == player || occupancyCount(index, p, trackIndex) != 1) continue; // Absent or a blockade
+        return __builtin_ctz(index->track[trackIndex] & occupancyPlayerBits<Rules>(p));
+    }
+    return -1;
+}
+
+// Function to build the index from token progress, tokensPerPlayer bytes per player
+template <typename Rules>
+inline void occupancyBuildFromProgress(Occupancy<Rules> *index, const uint8_t tokens[Rules::totalTokens]) {
+    occupancyClear(index);
+    for (int p = 0; p < Rules::players; p++) {
+        for (int j = 0; j < Rules::tokensPerPlayer; j++) {
+            occupancyAdd(index, p, j, tokens[p * Rules::tokensPerPlayer + j]);
+        }
+    }
+}
+
+template <typename Rules>
+inline bool occupancyEquals(const Occupancy<Rules> *a, const Occupancy<Rules> *b) {
+    return memcmp(a, b, sizeof(Occupancy<Rules>)) == 0;
+}
+
+#endif
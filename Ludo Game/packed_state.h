@@ -0,0 +1,298 @@
+#ifndef PACKED_STATE_H
+#define PACKED_STATE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "route_tables.h"
+#include "occupancy_index.h"
+#include "dice_rng.h"
+
+/*
+ * Packed game state.
+ * Each token is one byte of progress along its owner's route, and the whole
+ * standard position fits in 24 bytes, so it is cheap to copy, compare and
+ * hash. The rules below follow processDiceRoll/moveToken in final.cpp step
+ * for step, including the order of random draws, so both engines replay the
+ * same game from the same seed. Captures are looked up in an OccupancyIndex
+ * that travels with the state and is updated by applyMove; the state itself
+ * stays the only thing hashed, logged and compared.
+ *
+ * The engine is templated on a rules variant (game_rules.h).
+ * PackedGameState and OccupancyIndex are the standard 4-player game, the
+ * one the threaded game, event log, AI, search and server use.
+ */
+
+#define TOTAL_TOKENS (MAX_PLAYERS * TOKENS_PER_PLAYER)
+
+template <typename Rules>
+struct PackedState {
+    uint8_t tokens[Rules::totalTokens];      // Progress of token j of player p at [p * tokensPerPlayer + j]
+    uint8_t currentTurn;                     // Index of the player to move (0-based)
+    typename Rules::SixMask sixCounters;     // Consecutive sixes, 2 bits per player
+    typename Rules::RankMask ranks;          // Finishing rank, 4 bits per player (0 = unranked)
+    uint8_t killCounts[Rules::players];      // Tokens eliminated by each player (saturates at 255)
+};
+
+typedef PackedState<StandardRules> PackedGameState;
+
+static_assert(sizeof(PackedGameState) <= 32, "PackedGameState must fit in half a cache line");
+
+// Flags describing a move
+#define MOVE_RELEASE 0x01      // Token leaves the yard
+#define MOVE_HOME_ADVANCE 0x02 // Token moves along its home path
+#define MOVE_HOME_ENTRY 0x04   // Token enters its home path
+#define MOVE_FINISH 0x08       // Token reaches the end of its home path
+#define MOVE_CAPTURE 0x10      // An opponent's token is sent back to its yard
+
+typedef struct {
+    uint8_t token; // Token index within the player
+    uint8_t from;  // Progress before the move
+    uint8_t to;    // Progress after the move
+    uint8_t flags; // MOVE_* flags
+} PackedMove;
+
+template <typename Rules>
+inline int packedSixCount(const PackedState<Rules> *state, int player) {
+    return (state->sixCounters >> (2 * player)) & 3;
+}
+
+template <typename Rules>
+inline void packedSetSixCount(PackedState<Rules> *state, int player, int count) {
+    state->sixCounters = (typename Rules::SixMask)((state->sixCounters & ~(3u << (2 * player))) | (count << (2 * player)));
+}
+
+template <typename Rules>
+inline int packedRank(const PackedState<Rules> *state, int player) {
+    return (state->ranks >> (4 * player)) & 15;
+}
+
+template <typename Rules>
+inline void packedSetRank(PackedState<Rules> *state, int player, int rank) {
+    state->ranks = (typename Rules::RankMask)((state->ranks & ~(15u << (4 * player))) | (rank << (4 * player)));
+}
+
+// Function to count players that have finished
+template <typename Rules>
+inline int packedRankedCount(const PackedState<Rules> *state) {
+    int ranked = 0;
+    for (int p = 0; p < Rules::players; p++) {
+        if (packedRank(state, p) != 0) ranked++;
+    }
+    return ranked;
+}
+
+// Function to check whether only one player is left
+template <typename Rules>
+inline bool packedGameOver(const PackedState<Rules> *state) {
+    return packedRankedCount(state) >= Rules::players - 1;
+}
+
+// Function to put every token back in the yard for a new game
+template <typename Rules>
+inline void packedResetState(PackedState<Rules> *state) {
+    memset(state, 0, sizeof(*state));
+}
+
+template <typename Rules>
+inline bool packedStateEquals(const PackedState<Rules> *a, const PackedState<Rules> *b) {
+    return memcmp(a, b, sizeof(PackedState<Rules>)) == 0;
+}
+
+// Function to hash the whole state, a 64-bit word at a time (the last one zero-padded)
+template <typename Rules>
+inline uint64_t packedStateHash(const PackedState<Rules> *state) {
+    const int wordCount = (sizeof(PackedState<Rules>) + 7) / 8;
+    uint64_t words[wordCount] = {};
+    memcpy(words, state, sizeof(*state));
+
+    uint64_t hash = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < wordCount; i++) {
+        hash ^= words[i];
+        hash *= 0xBF58476D1CE4E5B9ULL;
+        hash ^= hash >> 31;
+    }
+    return hash;
+}
+
+static_assert(sizeof(PackedGameState) == 3 * sizeof(uint64_t), "The standard state hashes as three words");
+
+// Function to build the occupancy index of a state
+template <typename Rules>
+inline void occupancyBuild(Occupancy<Rules> *occupancy, const PackedState<Rules> *state) {
+    occupancyBuildFromProgress(occupancy, state->tokens);
+}
+
+// Function to list every legal move of the player to move for the roll, returns the move count.
+// A six only releases the first yard token; other rolls must advance a home path token if one can move.
+template <typename Rules>
+int generateMoves(const PackedState<Rules> *state, const Occupancy<Rules> *occupancy, int roll,
+                  PackedMove moves[Rules::tokensPerPlayer]) {
+    const RuleRoutes<Rules> &routes = ruleRoutes<Rules>;
+    int player = state->currentTurn;
+    const uint8_t *tokens = &state->tokens[player * Rules::tokensPerPlayer];
+    int count = 0;
+
+    if (roll == 6) {
+        for (int i = 0; i < Rules::tokensPerPlayer; i++) {
+            if (tokens[i] == PROGRESS_YARD) {
+                PackedMove release = { (uint8_t)i, PROGRESS_YARD, PROGRESS_TRACK, MOVE_RELEASE };
+                moves[0] = release;
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    // Home path tokens have priority
+    for (int i = 0; i < Rules::tokensPerPlayer; i++) {
+        uint8_t to = routes.target[player][tokens[i]][roll];
+        if (Rules::inHomePath(tokens[i]) && to != NO_MOVE) {
+            PackedMove move = { (uint8_t)i, tokens[i], to,
+                                (uint8_t)(MOVE_HOME_ADVANCE | (to == Rules::progressFinished ? MOVE_FINISH : 0)) };
+            moves[count++] = move;
+        }
+    }
+    if (count > 0) return count;
+
+    for (int i = 0; i < Rules::tokensPerPlayer; i++) {
+        if (!Rules::onTrack(tokens[i])) continue;
+
+        uint8_t to = routes.target[player][tokens[i]][roll];
+        uint8_t flags = 0;
+        if (to == Rules::progressHome) {
+            flags = MOVE_HOME_ENTRY;
+        } else if (occupancyCaptureVictim(occupancy, player, routes.trackIndex[player][to]) >= 0) {
+            flags = MOVE_CAPTURE;
+        }
+        PackedMove move = { (uint8_t)i, tokens[i], to, flags };
+        moves[count++] = move;
+    }
+    return count;
+}
+
+// Function to apply a move generated for the player to move, keeping its occupancy index current
+template <typename Rules>
+void applyMove(PackedState<Rules> *state, Occupancy<Rules> *occupancy, const PackedMove *move) {
+    int player = state->currentTurn;
+    if (move->flags & MOVE_CAPTURE) {
+        int victim = occupancyCaptureVictim(occupancy, player, ruleRoutes<Rules>.trackIndex[player][move->to]);
+        occupancyRemove(occupancy, victim / Rules::tokensPerPlayer, victim % Rules::tokensPerPlayer,
+                        state->tokens[victim]);
+        state->tokens[victim] = PROGRESS_YARD;
+        if (state->killCounts[player] < 255) state->killCounts[player]++;
+    }
+    occupancyMove(occupancy, player, move->token, move->from, move->to);
+    state->tokens[player * Rules::tokensPerPlayer + move->token] = move->to;
+}
+
+// Function to pick a move the way moveToken does: the first home path move,
+// otherwise up to four random token picks, which may all miss
+template <typename Rules = StandardRules>
+int chooseRandomMove(const PackedMove *moves, int count, DiceRng *rng) {
+    if (count == 0) return -1;
+    if (moves[0].flags & (MOVE_RELEASE | MOVE_HOME_ADVANCE)) return 0;
+
+    for (int attempts = 0; attempts < Rules::tokensPerPlayer; attempts++) {
+        int selectedToken = diceRngBelow(rng, Rules::tokensPerPlayer);
+        for (int i = 0; i < count; i++) {
+            if (moves[i].token == selectedToken) return i;
+        }
+    }
+    return -1;
+}
+
+// Seat policy: returns the index of the chosen move, or -1 to pass.
+// Seats without a chooser pick like moveToken does (chooseRandomMove).
+typedef int (*MoveChooser)(void *seatData, const PackedGameState *state, const OccupancyIndex *occupancy,
+                           const PackedMove *moves, int count, DiceRng *rng);
+
+typedef struct {
+    MoveChooser choose[MAX_PLAYERS]; // NULL = random seat
+    void *seatData[MAX_PLAYERS];     // Passed to the seat's chooser
+} SeatTable;
+
+// Function to check whether the roll leaves the mover a choice: a roll of
+// 1-5 with track moves only (releases and home path moves are forced)
+inline bool packedTurnHasChoice(int roll, const PackedMove *moves, int count) {
+    return roll != 6 && count > 0 && !(moves[0].flags & MOVE_HOME_ADVANCE);
+}
+
+// Function to pick the move for a roll: the seat's chooser when there is a
+// choice, otherwise as moveToken does. Returns the move index or -1 to pass.
+int packedSelectMove(const PackedGameState *state, const OccupancyIndex *occupancy, int roll,
+                     const PackedMove *moves, int count, DiceRng *rng, const SeatTable *seats) {
+    int player = state->currentTurn;
+    if (seats && seats->choose[player] && packedTurnHasChoice(roll, moves, count)) {
+        return seats->choose[player](seats->seatData[player], state, occupancy, moves, count, rng);
+    }
+    return chooseRandomMove(moves, count, rng);
+}
+
+// Function to rank the player to move if all its tokens are home
+template <typename Rules>
+void packedUpdateRankings(PackedState<Rules> *state, int player) {
+    if (packedRank(state, player) != 0) return;
+
+    for (int j = 0; j < Rules::tokensPerPlayer; j++) {
+        if (state->tokens[player * Rules::tokensPerPlayer + j] != Rules::progressFinished) return;
+    }
+    packedSetRank(state, player, packedRankedCount(state) + 1);
+}
+
+// Function to finish a turn after the roll: the move (NULL = none), the six
+// counter, ranking and passing the turn
+template <typename Rules>
+void packedFinishTurn(PackedState<Rules> *state, Occupancy<Rules> *occupancy, int roll, const PackedMove *move) {
+    int player = state->currentTurn;
+    if (roll != 6) {
+        packedSetSixCount(state, player, 0);
+    } else if (!move) {
+        // A six with no yard token to release
+        int sixes = packedSixCount(state, player) + 1;
+        packedSetSixCount(state, player, sixes >= 3 ? 0 : sixes);
+    }
+    if (move) applyMove(state, occupancy, move);
+    packedUpdateRankings(state, player);
+    state->currentTurn = (uint8_t)((player + 1) % Rules::players);
+}
+
+// Function to play one turn with the given seats (NULL = all random): roll,
+// move, rank and pass the turn; returns the roll
+int packedPlaySeatedTurn(PackedGameState *state, OccupancyIndex *occupancy, DiceRng *rng, const SeatTable *seats) {
+    int roll = diceRngRoll(rng);
+    PackedMove moves[TOKENS_PER_PLAYER];
+    int count = generateMoves(state, occupancy, roll, moves);
+    int choice = packedSelectMove(state, occupancy, roll, moves, count, rng, seats);
+    packedFinishTurn(state, occupancy, roll, choice >= 0 ? &moves[choice] : NULL);
+    return roll;
+}
+
+// Function to play one turn with random seats; returns the roll
+template <typename Rules>
+int packedPlayTurn(PackedState<Rules> *state, Occupancy<Rules> *occupancy, DiceRng *rng) {
+    int roll = diceRngRoll(rng);
+    PackedMove moves[Rules::tokensPerPlayer];
+    int count = generateMoves(state, occupancy, roll, moves);
+    int choice = chooseRandomMove<Rules>(moves, count, rng);
+    packedFinishTurn(state, occupancy, roll, choice >= 0 ? &moves[choice] : NULL);
+    return roll;
+}
+
+// Function to play a full game from the start, returns turns played
+template <typename Rules>
+long playPackedGame(PackedState<Rules> *state, DiceRng *rng) {
+    Occupancy<Rules> occupancy;
+    packedResetState(state);
+    occupancyClear(&occupancy);
+
+    long turns = 0;
+    while (!packedGameOver(state)) {
+        packedPlayTurn(state, &occupancy, rng);
+        turns++;
+    }
+    return turns;
+}
+
+#endif
@@ -0,0 +1,226 @@
+#ifndef ROLLOUT_AI_H
+#define ROLLOUT_AI_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+#include <atomic>
+#include "packed_state.h"
+
+/*
+ * Monte Carlo rollout AI.
+ * Each legal move is scored by playing random games to the end from the
+ * position it leads to and averaging the mover's finishing place. The
+ * playouts of one decision are shared out to a set of persistent worker
+ * threads and stop at the playout budget or the time budget, whichever
+ * comes first. rolloutChooseMove is a MoveChooser, so it can be put on any
+ * seat of a SeatTable next to random seats.
+ *
+ * Each playout is seeded from its decision and its number, not from the
+ * worker that happens to run it, so with a playout budget the same seed
+ * plays the same games on any number of workers.
+ */
+
+struct RolloutAI {
+    int workerCount;                     // Worker threads running playouts
+    long playoutBudget;                  // Playouts per decision (0 = time budget only)
+    long long timeBudgetNs;              // Time per decision (0 = playout budget only)
+    pthread_t *threads;                  // Worker threads
+    uint64_t seed;                       // Mixed into every decision's seed
+
+    pthread_mutex_t lock;                // Guards the decision hand-over below
+    pthread_cond_t workReady;            // Signals workers that a decision started
+    pthread_cond_t workDone;             // Signals the caller that the workers finished
+    long generation;                     // Number of the current decision
+    int busyWorkers;                     // Workers still running playouts
+    bool shutdown;                       // Set to stop the workers
+
+    PackedGameState roots[TOKENS_PER_PLAYER]; // Position after each candidate move
+    int rootCount;                       // Candidate moves
+    int player;                          // Player deciding
+    long long deadlineNs;                // Playouts stop at this time (0 = no deadline)
+    uint64_t decisionSeed;               // Playout n is seeded with decisionSeed + n
+    std::atomic<long> nextPlayout;       // Playouts handed out for this decision
+    long pointSums[TOKENS_PER_PLAYER];   // Sum of playout points per move
+    long playoutCounts[TOKENS_PER_PLAYER]; // Playouts per move
+
+    double lastScore;                    // Average playout score of the last move chosen
+    long decisions;                      // Decisions made
+    long totalPlayouts;                  // Playouts across all decisions
+    long long searchNs;                  // Time spent deciding
+};
+
+// Function to read the monotonic clock for the time budget
+static long long rolloutClockNs() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+// Function to play a random game to the end; returns the player's points
+// (MAX_PLAYERS - 1 for first place down to 0 for last). Points are whole
+// numbers so the sums do not depend on the order workers add them in.
+int rolloutPlayout(PackedGameState state, int player, DiceRng *rng) {
+    OccupancyIndex occupancy;
+    occupancyBuild(&occupancy, &state);
+    while (!packedGameOver(&state)) {
+        packedPlayTurn(&state, &occupancy, rng);
+    }
+    int rank = packedRank(&state, player);
+    return rank == 0 ? 0 : MAX_PLAYERS - rank;
+}
+
+// Thread function for a playout worker
+void *rolloutWorker(void *arg) {
+    RolloutAI *ai = (RolloutAI *)arg;
+    long seenGeneration = 0;
+
+    pthread_mutex_lock(&ai->lock);
+    while (1) {
+        while (!ai->shutdown && ai->generation == seenGeneration) {
+            pthread_cond_wait(&ai->workReady, &ai->lock);
+        }
+        if (ai->shutdown) break;
+        seenGeneration = ai->generation;
+        pthread_mutex_unlock(&ai->lock);
+
+        // Playouts are handed out round-robin over the moves so each gets an equal share
+        long points[TOKENS_PER_PLAYER] = {0};
+        long counts[TOKENS_PER_PLAYER] = {0};
+        while (1) {
+            long playout = ai->nextPlayout.fetch_add(1, std::memory_order_relaxed);
+            if (ai->playoutBudget > 0 && playout >= ai->playoutBudget) break;
+            if (ai->deadlineNs > 0 && rolloutClockNs() >= ai->deadlineNs) break;
+
+            int move = (int)(playout % ai->rootCount);
+            DiceRng rng;
+            diceRngSeed(&rng, ai->decisionSeed + (uint64_t)playout);
+            points[move] += rolloutPlayout(ai->roots[move], ai->player, &rng);
+            counts[move]++;
+        }
+
+        pthread_mutex_lock(&ai->lock);
+        for (int m = 0; m < ai->rootCount; m++) {
+            ai->pointSums[m] += points[m];
+            ai->playoutCounts[m] += counts[m];
+        }
+        if (--ai->busyWorkers == 0) pthread_cond_signal(&ai->workDone);
+    }
+    pthread_mutex_unlock(&ai->lock);
+
+    return NULL;
+}
+
+// Function to start a rollout AI; budgets of 0 are unlimited, but not both
+RolloutAI *rolloutCreate(int workerCount, long playoutBudget, long timeBudgetMicros, uint64_t seed) {
+    if (workerCount < 1) workerCount = 1;
+    if (playoutBudget <= 0 && timeBudgetMicros <= 0) playoutBudget = 256;
+
+    RolloutAI *ai = new RolloutAI();
+    ai->workerCount = workerCount;
+    ai->playoutBudget = playoutBudget;
+    ai->timeBudgetNs = timeBudgetMicros * 1000LL;
+    ai->threads = (pthread_t *)calloc(workerCount, sizeof(pthread_t));
+    ai->seed = seed;
+    pthread_mutex_init(&ai->lock, NULL);
+    pthread_cond_init(&ai->workReady, NULL);
+    pthread_cond_init(&ai->workDone, NULL);
+
+    for (int i = 0; i < workerCount; i++) {
+        pthread_create(&ai->threads[i], NULL, rolloutWorker, ai);
+    }
+    return ai;
+}
+
+// Function to stop the workers and free the AI
+void rolloutDestroy(RolloutAI *ai) {
+    if (!ai) return;
+
+    pthread_mutex_lock(&ai->lock);
+    ai->shutdown = true;
+    pthread_cond_broadcast(&ai->workReady);
+    pthread_mutex_unlock(&ai->lock);
+    for (int i = 0; i < ai->workerCount; i++) {
+        pthread_join(ai->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&ai->workDone);
+    pthread_cond_destroy(&ai->workReady);
+    pthread_mutex_destroy(&ai->lock);
+    free(ai->threads);
+    delete ai;
+}
+
+// MoveChooser that picks the move with the best average playout score
+int rolloutChooseMove(void *seatData, const PackedGameState *state, const OccupancyIndex *occupancy,
+                      const PackedMove *moves, int count, DiceRng *rng) {
+    RolloutAI *ai = (RolloutAI *)seatData;
+    if (count <= 1) return count - 1;
+
+    long long startNs = rolloutClockNs();
+    int player = state->currentTurn;
+
+    pthread_mutex_lock(&ai->lock);
+    for (int m = 0; m < count; m++) {
+        // The rest of the turn as packedPlaySeatedTurn plays it (choices only follow rolls of 1-5)
+        PackedGameState *root = &ai->roots[m];
+        OccupancyIndex rootOccupancy = *occupancy;
+        *root = *state;
+        packedFinishTurn(root, &rootOccupancy, 1, &moves[m]);
+
+        ai->pointSums[m] = 0;
+        ai->playoutCounts[m] = 0;
+    }
+    ai->rootCount = count;
+    ai->player = player;
+    ai->deadlineNs = ai->timeBudgetNs > 0 ? startNs + ai->timeBudgetNs : 0;
+    ai->decisionSeed = ai->seed ^ diceRngNext(rng);
+    ai->nextPlayout.store(0);
+    ai->busyWorkers = ai->workerCount;
+    ai->generation++;
+    pthread_cond_broadcast(&ai->workReady);
+
+    while (ai->busyWorkers > 0) {
+        pthread_cond_wait(&ai->workDone, &ai->lock);
+    }
+
+    int best = 0;
+    double bestScore = -1.0;
+    long playouts = 0;
+    for (int m = 0; m < count; m++) {
+        playouts += ai->playoutCounts[m];
+        double score = ai->playoutCounts[m] > 0
+                           ? (double)ai->pointSums[m] / ai->playoutCounts[m] / (MAX_PLAYERS - 1) : 0.0;
+        if (score > bestScore) {
+            bestScore = score;
+            best = m;
+        }
+    }
+    pthread_mutex_unlock(&ai->lock);
+
+    ai->lastScore = bestScore;
+    ai->decisions++;
+    ai->totalPlayouts += playouts;
+    ai->searchNs += rolloutClockNs() - startNs;
+    return best;
+}
+
+// Function to get the average playout score of the last move chosen
+float rolloutLastScore(const void *seatData) {
+    return (float)((const RolloutAI *)seatData)->lastScore;
+}
+
+// Function to print decisions made and playout throughput
+void rolloutPrintStats(const RolloutAI *ai) {
+    double seconds = ai->searchNs / 1e9;
+    printf("Rollout AI: %ld decisions, %ld playouts on %d workers\n",
+           ai->decisions, ai->totalPlayouts, ai->workerCount);
+    printf("Playouts per decision: %.0f, time per decision: %.2f ms, playouts/sec: %.0f\n",
+           ai->decisions > 0 ? (double)ai->totalPlayouts / ai->decisions : 0.0,
+           ai->decisions > 0 ? ai->searchNs / 1e6 / ai->decisions : 0.0,
+           seconds > 0 ? ai->totalPlayouts / seconds : 0.0);
+}
+
+#endif
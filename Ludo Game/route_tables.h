@@ -0,0 +1,128 @@
+#ifndef ROUTE_TABLES_H
+#define ROUTE_TABLES_H
+
+#include <stdint.h>
+#include "board_layout.h"
+
+/*
+ * Per-player route tables, generated at compile time from the board layout.
+ * A token's route is: yard -> start cell -> 50 more track cells to the
+ * middle cell of its own arm (progress TRACK_LENGTH - 1), where it turns
+ * in -> home path -> finish. A token that overshoots that cell goes round
+ * the track again. Every rule question
+ * ("where does this token land with this roll", "which cell is this") is a
+ * single table lookup instead of a scan over boardPath or the home paths.
+ */
+
+// Token progress along its route
+#define PROGRESS_YARD 0                                          // Waiting in the yard
+#define PROGRESS_TRACK 1                                         // Start cell; the track spans 1..52
+#define PROGRESS_HOME (PROGRESS_TRACK + TRACK_LENGTH)            // First home path cell (53)
+#define PROGRESS_FINISHED (PROGRESS_HOME + HOME_PATH_LENGTH - 1) // Last home path cell (57)
+#define PROGRESS_COUNT (PROGRESS_FINISHED + 1)
+
+#define NO_MOVE 0xFF // routeTables.target entry for a roll the token cannot use
+
+typedef struct {
+    BoardPosition cell[MAX_PLAYERS][PROGRESS_COUNT];       // Board cell for each progress (yard: first yard spot)
+    uint8_t trackIndex[MAX_PLAYERS][PROGRESS_COUNT];       // boardPath index for track progress
+    bool canEnterHome[MAX_PLAYERS][PROGRESS_COUNT];        // Track progress from which the home path is entered
+    uint8_t target[MAX_PLAYERS][PROGRESS_COUNT][7];        // Progress after rolling 1..6, or NO_MOVE
+    int8_t trackIndexAt[BOARD_DIMENSION][BOARD_DIMENSION]; // boardPath index of a cell, -1 if off the track
+    int8_t progressAt[MAX_PLAYERS][BOARD_DIMENSION][BOARD_DIMENSION]; // Route progress of a cell, -1 if off the route
+    bool safeTrack[TRACK_LENGTH];                          // boardPath indexes of the safe spots
+} RouteTables;
+
+constexpr RouteTables buildRouteTables() {
+    RouteTables tables = {};
+
+    for (int x = 0; x < BOARD_DIMENSION; x++) {
+        for (int y = 0; y < BOARD_DIMENSION; y++) {
+            tables.trackIndexAt[x][y] = -1;
+            for (int p = 0; p < MAX_PLAYERS; p++) tables.progressAt[p][x][y] = -1;
+        }
+    }
+    for (int i = 0; i < TRACK_LENGTH; i++) {
+        tables.trackIndexAt[trackLayout[i].x][trackLayout[i].y] = (int8_t)i;
+    }
+    for (int i = 0; i < SAFE_SPOT_COUNT; i++) {
+        tables.safeTrack[tables.trackIndexAt[safeSpots[i].x][safeSpots[i].y]] = true;
+    }
+
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        int start = tables.trackIndexAt[initialPositions[p][0]][initialPositions[p][1]];
+        tables.cell[p][PROGRESS_YARD] = yardCorners[p];
+
+        for (int step = 0; step < TRACK_LENGTH; step++) {
+            int progress = PROGRESS_TRACK + step;
+            int index = (start + step) % TRACK_LENGTH;
+            BoardPosition cell = trackLayout[index];
+
+            tables.cell[p][progress] = cell;
+            tables.trackIndex[p][progress] = (uint8_t)index;
+            tables.progressAt[p][cell.x][cell.y] = (int8_t)progress;
+
+            // Only the last track cell of the route leads into the home path
+            tables.canEnterHome[p][progress] = progress == TRACK_LENGTH - 1;
+        }
+        for (int i = 0; i < HOME_PATH_LENGTH; i++) {
+            BoardPosition cell = homePathLayout[p][i];
+            tables.cell[p][PROGRESS_HOME + i] = cell;
+            tables.progressAt[p][cell.x][cell.y] = (int8_t)(PROGRESS_HOME + i);
+        }
+
+        // Landing progress for every roll: a six only releases, other rolls only move
+        for (int progress = 0; progress < PROGRESS_COUNT; progress++) {
+            for (int roll = 0; roll <= 6; roll++) {
+                int target = NO_MOVE;
+                if (progress == PROGRESS_YARD) {
+                    if (roll == 6) target = PROGRESS_TRACK;
+                } else if (roll >= 1 && roll <= 5) {
+                    if (progress >= PROGRESS_HOME) {
+                        if (progress + roll <= PROGRESS_FINISHED) target = progress + roll;
+                    } else if (tables.canEnterHome[p][progress]) {
+                        target = PROGRESS_HOME;
+                    } else {
+                        target = (progress - PROGRESS_TRACK + roll) % TRACK_LENGTH + PROGRESS_TRACK;
+                    }
+                }
+                tables.target[p][progress][roll] = (uint8_t)target;
+            }
+        }
+    }
+    return tables;
+}
+
+constexpr RouteTables routeTables = buildRouteTables();
+
+static_assert(routeTables.trackIndex[0][PROGRESS_TRACK] == 29, "Blue starts on boardPath[29]");
+static_assert(routeTables.target[1][PROGRESS_YARD][6] == PROGRESS_TRACK, "A six releases a yard token");
+static_assert(routeTables.target[2][PROGRESS_FINISHED][1] == NO_MOVE, "Finished tokens never move");
+static_assert(routeTables.safeTrack[routeTables.trackIndex[3][PROGRESS_TRACK]], "Start cells are safe");
+static_assert(routeTables.target[0][TRACK_LENGTH - 1][3] == PROGRESS_HOME, "The last track cell leads home");
+static_assert(routeTables.target[0][TRACK_LENGTH - 2][3] == PROGRESS_TRACK, "Overshooting goes round again");
+
+constexpr bool progressOnTrack(int progress) {
+    return progress >= PROGRESS_TRACK && progress < PROGRESS_HOME;
+}
+
+constexpr bool progressInHomePath(int progress) {
+    return progress >= PROGRESS_HOME;
+}
+
+// Function to get the boardPath index of a token on the track
+inline int progressTrackIndex(int player, int progress) {
+    return routeTables.trackIndex[player][progress];
+}
+
+// Function to get the board cell of a token
+inline BoardPosition progressToPosition(int player, int token, int progress) {
+    BoardPosition cell = routeTables.cell[player][progress];
+    if (progress == PROGRESS_YARD) {
+        cell.x += token / 2;
+        cell.y += token % 2;
+    }
+    return cell;
+}
+
+#endif
@@ -0,0 +1,206 @@
+#ifndef SPECTATOR_RING_H
+#define SPECTATOR_RING_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <atomic>
+#include "packed_state.h"
+#include "event_log.h"
+#include "game_stats.h"
+
+/*
+ * Spectator broadcast ring.
+ * The game publishes every turn as the 32-bit event-log delta into a ring
+ * that any number of spectators read without locks and without the game
+ * ever waiting for them. Each slot is one 64-bit word, (turn + 1) << 32 |
+ * delta, written with a single store, so a reader never sees half a slot
+ * and can tell from the turn in it whether the slot still holds the turn it
+ * wants. Only the low 32 bits of the turn fit, which is enough: a slot is
+ * overwritten every ring size turns, far fewer than 2^32. Each spectator keeps its own cursor.
+ *
+ * A spectator that falls more than a ring behind has lost turns. It
+ * resyncs from the snapshot, the full packed state after the latest turn,
+ * which the game rewrites under a sequence lock every turn, and carries on
+ * from there. Publishing is a fixed number of stores whatever the
+ * spectators do. The ring times every publish on the turn path, from the
+ * moment the caller starts packing the turn to the last store.
+ */
+
+#define SPECTATOR_RING_SLOTS 1024          // Default ring size (a power of two)
+#define SPECTATOR_NEW_GAME (1u << 31)      // Delta bit: the state went back to the start of a game
+#define SPECTATOR_STATE_WORDS ((sizeof(PackedGameState) + 7) / 8)
+
+typedef struct {
+    // Written by the game
+    alignas(64) std::atomic<uint64_t> published;      // Turns published so far
+    alignas(64) std::atomic<uint32_t> snapshotSequence; // Odd while the snapshot is being written
+    std::atomic<uint64_t> snapshotTurn;               // Turns the snapshot includes
+    std::atomic<uint64_t> snapshotWords[SPECTATOR_STATE_WORDS]; // Packed state after them
+
+    std::atomic<uint64_t> *slots; // Low 32 bits of turn + 1 << 32 | delta; 0 = never written
+    uint64_t mask;                // Slots - 1
+
+    // Game side only
+    alignas(64) PackedGameState state; // State after the published turns
+    Distribution publishNs;            // Time per publish, packing and encoding included
+} SpectatorRing;
+
+// A spectator's view of the game
+typedef struct {
+    SpectatorRing *ring;
+    uint64_t cursor;        // Next turn to read
+    PackedGameState state;  // State after cursor turns
+    long deltas;            // Deltas applied
+    long resyncs;           // Times the spectator fell behind and took the snapshot
+    long lostTurns;         // Turns skipped by resyncs
+    long snapshotRetries;   // Snapshot reads repeated because the game was writing it
+} SpectatorCursor;
+
+long long spectatorClockNs() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+static void spectatorWriteSnapshot(SpectatorRing *ring, uint64_t turn);
+
+// Function to create a ring of at least slotCount slots for a game starting
+// from start (NULL = the initial position)
+SpectatorRing *spectatorRingCreate(int slotCount, const PackedGameState *start) {
+    uint64_t size = 16;
+    while (size < (uint64_t)slotCount) size *= 2;
+
+    SpectatorRing *ring = new SpectatorRing();
+    ring->slots = new std::atomic<uint64_t>[size];
+    for (uint64_t i = 0; i < size; i++) ring->slots[i].store(0, std::memory_order_relaxed);
+    ring->mask = size - 1;
+    if (start) {
+        ring->state = *start;
+    } else {
+        packedResetState(&ring->state);
+    }
+    memset(&ring->publishNs, 0, sizeof(ring->publishNs));
+    spectatorWriteSnapshot(ring, 0);
+    return ring;
+}
+
+void spectatorRingDestroy(SpectatorRing *ring) {
+    if (!ring) return;
+    delete[] ring->slots;
+    delete ring;
+}
+
+// Function to rewrite the snapshot after turn (seqlock writer)
+static void spectatorWriteSnapshot(SpectatorRing *ring, uint64_t turn) {
+    uint64_t words[SPECTATOR_STATE_WORDS] = {};
+    memcpy(words, &ring->state, sizeof(ring->state));
+
+    uint32_t sequence = ring->snapshotSequence.load(std::memory_order_relaxed);
+    ring->snapshotSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    ring->snapshotTurn.store(turn, std::memory_order_relaxed);
+    for (size_t i = 0; i < SPECTATOR_STATE_WORDS; i++) ring->snapshotWords[i].store(words[i], std::memory_order_relaxed);
+    ring->snapshotSequence.store(sequence + 2, std::memory_order_release);
+}
+
+// Function to publish one delta: slot, snapshot, then the turn count readers
+// poll; the publish is timed from startNs
+static void spectatorPublishDelta(SpectatorRing *ring, LogEvent delta, long long startNs) {
+    uint64_t turn = ring->published.load(std::memory_order_relaxed);
+
+    if (delta & SPECTATOR_NEW_GAME) {
+        packedResetState(&ring->state);
+    } else {
+        eventLogApply(&ring->state, delta);
+    }
+    ring->slots[turn & ring->mask].store((turn + 1) << 32 | delta, std::memory_order_release);
+    spectatorWriteSnapshot(ring, turn + 1);
+    ring->published.store(turn + 1, std::memory_order_release);
+
+    distributionAdd(&ring->publishNs, spectatorClockNs() - startNs);
+}
+
+// Function to publish a turn given the roll and the state after it (single
+// producer). startNs is spectatorClockNs() read before the caller packed the
+// state, so the time to pack and encode the turn is part of its publish cost.
+void spectatorPublishTurn(SpectatorRing *ring, int roll, const PackedGameState *after, long long startNs) {
+    spectatorPublishDelta(ring, eventLogEncode(&ring->state, after, roll), startNs);
+}
+
+// Function to tell spectators that a new game starts from the initial position
+void spectatorPublishNewGame(SpectatorRing *ring) {
+    spectatorPublishDelta(ring, SPECTATOR_NEW_GAME, spectatorClockNs());
+}
+
+// Function to read a consistent snapshot (seqlock reader)
+static uint64_t spectatorReadSnapshot(SpectatorCursor *cursor, PackedGameState *state) {
+    SpectatorRing *ring = cursor->ring;
+    for (;;) {
+        uint32_t before = ring->snapshotSequence.load(std::memory_order_acquire);
+        uint64_t turn = ring->snapshotTurn.load(std::memory_order_relaxed);
+        uint64_t words[SPECTATOR_STATE_WORDS];
+        for (size_t i = 0; i < SPECTATOR_STATE_WORDS; i++) words[i] = ring->snapshotWords[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint32_t after = ring->snapshotSequence.load(std::memory_order_relaxed);
+
+        if (before == after && (before & 1) == 0) {
+            memcpy(state, words, sizeof(*state));
+            return turn;
+        }
+        cursor->snapshotRetries++;
+        sched_yield(); // The game may be stopped half way through the write; let it finish
+    }
+}
+
+// Function to jump to the snapshot, dropping the turns in between
+static void spectatorResync(SpectatorCursor *cursor) {
+    uint64_t turn = spectatorReadSnapshot(cursor, &cursor->state);
+    cursor->resyncs++;
+    cursor->lostTurns += (long)(turn - cursor->cursor);
+    cursor->cursor = turn;
+}
+
+// Function to start watching: the spectator begins at the latest snapshot
+void spectatorSubscribe(SpectatorCursor *cursor, SpectatorRing *ring) {
+    memset(cursor, 0, sizeof(*cursor));
+    cursor->ring = ring;
+    cursor->cursor = spectatorReadSnapshot(cursor, &cursor->state);
+}
+
+// Function to apply up to maxDeltas published deltas to the spectator's
+// state; returns how many were applied
+int spectatorPoll(SpectatorCursor *cursor, int maxDeltas) {
+    SpectatorRing *ring = cursor->ring;
+    int applied = 0;
+    while (applied < maxDeltas) {
+        uint64_t published = ring->published.load(std::memory_order_acquire);
+        if (cursor->cursor >= published) break;
+        if (published - cursor->cursor > ring->mask + 1) {
+            spectatorResync(cursor); // The turn wanted is already overwritten
+            continue;
+        }
+
+        uint64_t slot = ring->slots[cursor->cursor & ring->mask].load(std::memory_order_acquire);
+        if ((uint32_t)(slot >> 32) != (uint32_t)(cursor->cursor + 1)) {
+            spectatorResync(cursor); // Overwritten since published was read
+            continue;
+        }
+
+        LogEvent delta = (LogEvent)slot;
+        if (delta & SPECTATOR_NEW_GAME) {
+            packedResetState(&cursor->state);
+        } else {
+            eventLogApply(&cursor->state, delta);
+        }
+        cursor->cursor++;
+        cursor->deltas++;
+        applied++;
+    }
+    return applied;
+}
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef TERMINAL_INPUT_H
+#define TERMINAL_INPUT_H
+
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Keyboard input for human seats.
+ * The session puts the terminal in raw mode (no line buffering, no echo)
+ * once when it starts and restores it once when it ends, on exit, or on
+ * SIGINT/SIGTERM. Keys are read with poll() and a timeout, so a caller can
+ * give up waiting and play an automatic move instead. Input that is not a
+ * terminal (a pipe or file) is read the same way without raw mode.
+ */
+
+#define TERMINAL_INPUT_BUFFER 64
+
+typedef struct {
+    int fd;                                  // Input descriptor (normally stdin)
+    bool isTerminal;                         // Raw mode is only used on a terminal
+    bool rawMode;                            // Whether savedSettings must be restored
+    struct termios savedSettings;            // Terminal settings before the session
+    char buffer[TERMINAL_INPUT_BUFFER];      // Keys read but not returned yet
+    int length, position;                    // Bytes in buffer and next byte to return
+    bool keyPending;                         // A key was used and its frame is not shown yet
+    long long keyNs;                         // Time that key was read
+    long keysRead;                           // Keys returned to callers
+    long timeouts;                           // Waits that ended without a key
+    long keyFrames;                          // Frames drawn for a key
+    long long keyToFrameTotalNs;             // Sum of key-to-frame latencies
+    long long keyToFrameMaxNs;               // Worst key-to-frame latency
+} TerminalSession;
+
+static TerminalSession *activeTerminalSession = NULL;
+
+static long long terminalClockNs() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+// Function to put the terminal back the way the session found it
+void terminalSessionEnd(TerminalSession *session) {
+    if (session->rawMode) {
+        tcsetattr(session->fd, TCSANOW, &session->savedSettings);
+        session->rawMode = false;
+    }
+    if (activeTerminalSession == session) activeTerminalSession = NULL;
+}
+
+static void restoreTerminalAtExit() {
+    if (activeTerminalSession) terminalSessionEnd(activeTerminalSession);
+}
+
+// tcsetattr is async-signal-safe; restore, then die of the same signal
+static void restoreTerminalOnSignal(int signalNumber) {
+    TerminalSession *session = activeTerminalSession;
+    if (session && session->rawMode) tcsetattr(session->fd, TCSANOW, &session->savedSettings);
+    signal(signalNumber, SIG_DFL);
+    raise(signalNumber);
+}
+
+// Function to start reading keys from fd, entering raw mode if it is a terminal
+bool terminalSessionBegin(TerminalSession *session, int fd) {
+    memset(session, 0, sizeof(*session));
+    session->fd = fd;
+    session->isTerminal = isatty(fd);
+
+    if (session->isTerminal) {
+        if (tcgetattr(fd, &session->savedSettings) != 0) {
+            perror("tcgetattr");
+            return false;
+        }
+        struct termios raw = session->savedSettings;
+        raw.c_lflag &= ~(ICANON | ECHO); // Keep ISIG so Ctrl-C still stops the game
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        if (tcsetattr(fd, TCSANOW, &raw) != 0) {
+            perror("tcsetattr");
+            return false;
+        }
+        session->rawMode = true;
+
+        activeTerminalSession = session;
+        atexit(restoreTerminalAtExit);
+        signal(SIGINT, restoreTerminalOnSignal);
+        signal(SIGTERM, restoreTerminalOnSignal);
+    }
+    return true;
+}
+
+// Function to throw away keys typed before a prompt
+void terminalDiscardInput(TerminalSession *session) {
+    session->length = session->position = 0;
+    if (session->isTerminal) tcflush(session->fd, TCIFLUSH);
+}
+
+// Function to wait up to timeoutMs for a key (negative = forever).
+// Returns the key, or -1 on timeout or end of input.
+int terminalReadKey(TerminalSession *session, int timeoutMs) {
+    if (session->position < session->length) {
+        session->keysRead++;
+        return (unsigned char)session->buffer[session->position++];
+    }
+
+    long long deadlineNs = terminalClockNs() + (long long)timeoutMs * 1000000LL;
+    for (;;) {
+        int waitMs = timeoutMs;
+        if (timeoutMs >= 0) {
+            long long leftNs = deadlineNs - terminalClockNs();
+            if (leftNs <= 0) break;
+            waitMs = (int)((leftNs + 999999) / 1000000);
+        }
+
+        struct pollfd input = {session->fd, POLLIN, 0};
+        int ready = poll(&input, 1, waitMs);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            return -1;
+        }
+        if (ready == 0) break;
+
+        ssize_t count = read(session->fd, session->buffer, sizeof(session->buffer));
+        if (count < 0) {
+            if (errno == EINTR || errno == EAGAIN) continue;
+            perror("read");
+            return -1;
+        }
+        if (count == 0) return -1; // End of input: callers treat it like a timeout
+
+        session->length = (int)count;
+        session->position = 1;
+        session->keysRead++;
+        return (unsigned char)session->buffer[0];
+    }
+    session->timeouts++;
+    return -1;
+}
+
+// Function to mark that a key changed the game, so the next frame is drawn at once
+void terminalKeyUsed(TerminalSession *session) {
+    session->keyPending = true;
+    session->keyNs = terminalClockNs();
+}
+
+// Function to record that the frame for the last used key is on screen
+void terminalKeyShown(TerminalSession *session) {
+    if (!session->keyPending) return;
+    long long latency = terminalClockNs() - session->keyNs;
+    session->keyPending = false;
+    session->keyFrames++;
+    session->keyToFrameTotalNs += latency;
+    if (latency > session->keyToFrameMaxNs) session->keyToFrameMaxNs = latency;
+}
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <sched.h>    // For sched_yield
+#include <atomic>
+
+/*
+ * Work-stealing thread pool.
+ * Every worker owns a task queue. It takes work from the back of its own
+ * queue and, when that is empty, steals from the front of another worker's
+ * queue, so uneven tasks still keep all cores busy.
+ */
+
+typedef void (*PoolTaskFunction)(void *arg, int workerID);
+
+typedef struct {
+    PoolTaskFunction function; // Work to run
+    void *arg;                 // Argument passed to the function
+} PoolTask;
+
+typedef struct {
+    pthread_mutex_t lock; // Guards this queue only
+    PoolTask *tasks;      // Ring buffer of tasks
+    int capacity;         // Size of the ring buffer
+    int head;             // Index of the oldest task (steal end)
+    int count;            // Number of queued tasks
+    long executed;        // Tasks run by the owning worker
+    long stolen;          // Tasks this worker took from other queues
+} WorkQueue;
+
+struct WorkStealingPool;
+
+typedef struct {
+    struct WorkStealingPool *pool;
+    int workerID;
+} PoolWorkerArgs;
+
+typedef struct WorkStealingPool {
+    int workerCount;                // Number of worker threads
+    WorkQueue *queues;              // One queue per worker
+    pthread_t *threads;             // Worker threads
+    PoolWorkerArgs *workerArgs;     // Arguments for each worker thread
+    std::atomic<long> pendingTasks; // Tasks submitted but not yet finished
+    int nextQueue;                  // Round-robin target for poolSubmit
+} WorkStealingPool;
+
+// Function to create a pool with the given number of workers
+WorkStealingPool *poolCreate(int workerCount) {
+    if (workerCount < 1) workerCount = 1;
+
+    WorkStealingPool *pool = new WorkStealingPool();
+    pool->workerCount = workerCount;
+    pool->queues = (WorkQueue *)calloc(workerCount, sizeof(WorkQueue));
+    pool->threads = (pthread_t *)calloc(workerCount, sizeof(pthread_t));
+    pool->workerArgs = (PoolWorkerArgs *)calloc(workerCount, sizeof(PoolWorkerArgs));
+    pool->pendingTasks = 0;
+    pool->nextQueue = 0;
+
+    for (int i = 0; i < workerCount; i++) {
+        pthread_mutex_init(&pool->queues[i].lock, NULL);
+        pool->queues[i].capacity = 64;
+        pool->queues[i].tasks = (PoolTask *)malloc(64 * sizeof(PoolTask));
+    }
+    return pool;
+}
+
+// Function to append a task to the back of a queue
+void queuePushBack(WorkQueue *queue, PoolTask task) {
+    pthread_mutex_lock(&queue->lock);
+
+    // Grow the ring buffer when full
+    if (queue->count == queue->capacity) {
+        PoolTask *grown = (PoolTask *)malloc(2 * queue->capacity * sizeof(PoolTask));
+        for (int i = 0; i < queue->count; i++) {
+            grown[i] = queue->tasks[(queue->head + i) % queue->capacity];
+        }
+        free(queue->tasks);
+        queue->tasks = grown;
+        queue->head = 0;
+        queue->capacity *= 2;
+    }
+
+    queue->tasks[(queue->head + queue->count) % queue->capacity] = task;
+    queue->count++;
+
+    pthread_mutex_unlock(&queue->lock);
+}
+
+// Function for a worker to take the newest task from its own queue
+bool queuePopBack(WorkQueue *queue, PoolTask *task) {
+    pthread_mutex_lock(&queue->lock);
+    bool found = queue->count > 0;
+    if (found) {
+        queue->count--;
+        *task = queue->tasks[(queue->head + queue->count) % queue->capacity];
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return found;
+}
+
+// Function for a thief to take the oldest task from another queue
+bool queueStealFront(WorkQueue *queue, PoolTask *task) {
+    // Skip busy victims without blocking
+    if (pthread_mutex_trylock(&queue->lock) != 0) return false;
+
+    bool found = queue->count > 0;
+    if (found) {
+        *task = queue->tasks[queue->head];
+        queue->head = (queue->head + 1) % queue->capacity;
+        queue->count--;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return found;
+}
+
+// Function to queue a task, spreading tasks over the workers round-robin
+void poolSubmit(WorkStealingPool *pool, PoolTaskFunction function, void *arg) {
+    PoolTask task = { function, arg };
+    pool->pendingTasks++;
+    queuePushBack(&pool->queues[pool->nextQueue], task);
+    pool->nextQueue = (pool->nextQueue + 1) % pool->workerCount;
+}
+
+// Thread function for each pool worker
+void *poolWorker(void *arg) {
+    PoolWorkerArgs *args = (PoolWorkerArgs *)arg;
+    WorkStealingPool *pool = args->pool;
+    int id = args->workerID;
+    WorkQueue *ownQueue = &pool->queues[id];
+    unsigned int victimSeed = 2654435761u * (id + 1);
+
+    while (pool->pendingTasks.load(std::memory_order_acquire) > 0) {
+        PoolTask task;
+        bool found = queuePopBack(ownQueue, &task);
+
+        // Own queue is empty: try every other worker, starting at a random one
+        if (!found) {
+            victimSeed = victimSeed * 1103515245u + 12345u;
+            int start = (victimSeed >> 16) % pool->workerCount;
+            for (int i = 0; i < pool->workerCount && !found; i++) {
+                int victim = (start + i) % pool->workerCount;
+                if (victim != id && queueStealFront(&pool->queues[victim], &task)) {
+                    found = true;
+                    ownQueue->stolen++;
+                }
+            }
+        }
+
+        if (found) {
+            task.function(task.arg, id);
+            ownQueue->executed++;
+            pool->pendingTasks.fetch_sub(1, std::memory_order_release);
+        } else {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+// Function to run every submitted task to completion on the workers
+void poolRun(WorkStealingPool *pool) {
+    for (int i = 0; i < pool->workerCount; i++) {
+        pool->workerArgs[i].pool = pool;
+        pool->workerArgs[i].workerID = i;
+        pthread_create(&pool->threads[i], NULL, poolWorker, &pool->workerArgs[i]);
+    }
+    for (int i = 0; i < pool->workerCount; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+}
+
+// Function to release the pool
+void poolDestroy(WorkStealingPool *pool) {
+    for (int i = 0; i < pool->workerCount; i++) {
+        pthread_mutex_destroy(&pool->queues[i].lock);
+        free(pool->queues[i].tasks);
+    }
+    free(pool->queues);
+    free(pool->threads);
+    free(pool->workerArgs);
+    delete pool;
+}
+
+#endif